@@ -45,6 +45,8 @@ template<typename T> inline T crossPhase(T phase0, T phase1, T ratio)
 
 void DSPCore::setup(double sampleRate)
 {
+  SmootherCommon<double>::Scope smootherScope(smootherState);
+
   this->sampleRate = double(sampleRate);
 
   reset();
@@ -114,6 +116,8 @@ void DSPCore::updateUpRate()
 
 void DSPCore::reset()
 {
+  SmootherCommon<double>::Scope smootherScope(smootherState);
+
   oversampling = param.value[ParameterID::ID::oversampling]->getInt();
   updateUpRate();
 
@@ -139,6 +143,8 @@ void DSPCore::startup() {}
 
 void DSPCore::setParameters()
 {
+  SmootherCommon<double>::Scope smootherScope(smootherState);
+
   size_t newOversampling = param.value[ParameterID::ID::oversampling]->getInt();
   if (oversampling != newOversampling) {
     oversampling = newOversampling;
@@ -245,15 +251,17 @@ std::array<double, 2> DSPCore::processFrame(const std::array<double, 4> &frame)
   };
 }
 
+template<typename Sample>
 void DSPCore::process(
   const size_t length,
-  const float *in0,
-  const float *in1,
-  const float *in2,
-  const float *in3,
-  float *out0,
-  float *out1)
+  const Sample *in0,
+  const Sample *in1,
+  const Sample *in2,
+  const Sample *in3,
+  Sample *out0,
+  Sample *out1)
 {
+  SmootherCommon<double>::Scope smootherScope(smootherState);
   ScopedNoDenormals scopedDenormals;
 
   using ID = ParameterID::ID;
@@ -312,3 +320,20 @@ void DSPCore::process(
     }
   }
 }
+
+template void DSPCore::process<float>(
+  const size_t length,
+  const float *in0,
+  const float *in1,
+  const float *in2,
+  const float *in3,
+  float *out0,
+  float *out1);
+template void DSPCore::process<double>(
+  const size_t length,
+  const double *in0,
+  const double *in1,
+  const double *in2,
+  const double *in3,
+  double *out0,
+  double *out1);
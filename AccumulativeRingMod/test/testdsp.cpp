@@ -7,6 +7,13 @@
 #include "../../test/fxtester.hpp"
 #include "../source/dsp/dspcore.hpp"
 
+#ifdef BENCH_DSP
+  #include "../../test/fxbench.hpp"
+using Tester = FxBench<DSPCore>;
+#else
+using Tester = FxTester<DSPCore>;
+#endif
+
 // CMake provides this macro, but just in case.
 #ifndef UHHYOU_PLUGIN_NAME
   #define UHHYOU_PLUGIN_NAME "AccumulativeRingMod"
@@ -16,6 +23,6 @@
 
 int main()
 {
-  FxTester<DSPCore> tester(UHHYOU_PLUGIN_NAME, OUT_DIR_PATH);
+  Tester tester(UHHYOU_PLUGIN_NAME, OUT_DIR_PATH);
   return tester.isFinished ? EXIT_SUCCESS : EXIT_FAILURE;
 }
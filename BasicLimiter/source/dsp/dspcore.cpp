@@ -8,15 +8,17 @@
 #include <algorithm>
 #include <numeric>
 
-inline float maxAbs(const size_t length, const float *buffer)
+template<typename Sample> inline Sample maxAbs(const size_t length, const Sample *buffer)
 {
-  float max = 0.0f;
+  Sample max = 0;
   for (size_t i = 0; i < length; ++i) max = std::max(max, std::fabs(buffer[i]));
   return max;
 }
 
 void DSPCore::setup(double sampleRate)
 {
+  SmootherCommon<float>::Scope smootherScope(smootherState);
+
   this->sampleRate = float(sampleRate);
 
   SmootherCommon<float>::setSampleRate(this->sampleRate);
@@ -25,6 +27,8 @@ void DSPCore::setup(double sampleRate)
   for (auto &lm : limiter)
     lm.resize(size_t(UpSamplerFir::upfold * maxAttackSeconds * this->sampleRate) + 1);
 
+  telemetry.setup(sampleRate);
+
   reset();
   startup();
 }
@@ -48,6 +52,8 @@ size_t DSPCore::getLatency()
 
 void DSPCore::reset()
 {
+  SmootherCommon<float>::Scope smootherScope(smootherState);
+
   ASSIGN_PARAMETER(reset);
 
   pv[ID::overshoot]->setFromFloat(1.0);
@@ -56,6 +62,7 @@ void DSPCore::reset()
   for (auto &he : highEliminator) he.reset();
   for (auto &us : upSampler) us.reset();
   for (auto &ds : downSampler) ds.reset();
+  telemetry.reset();
   startup();
 }
 
@@ -63,6 +70,8 @@ void DSPCore::startup() {}
 
 void DSPCore::setParameters()
 {
+  SmootherCommon<float>::Scope smootherScope(smootherState);
+
   ASSIGN_PARAMETER(push);
 
   auto &&rate = param.value[ParameterID::truePeak]->getInt()
@@ -87,9 +96,11 @@ std::array<float, 2> DSPCore::processStereoLink(float in0, float in1)
   return {lerp(abs0, absMax, stereoLink), lerp(abs1, absMax, stereoLink)};
 }
 
+template<typename Sample>
 void DSPCore::process(
-  const size_t length, const float *in0, const float *in1, float *out0, float *out1)
+  const size_t length, const Sample *in0, const Sample *in1, Sample *out0, Sample *out1)
 {
+  SmootherCommon<float>::Scope smootherScope(smootherState);
   ScopedNoDenormals scopedDenormals;
 
   SmootherCommon<float>::setBufferSize(float(length));
@@ -116,12 +127,14 @@ void DSPCore::process(
 
       out0[i] = downSampler[0].process(expanded[0]);
       out1[i] = downSampler[1].process(expanded[1]);
+      telemetry.process(out0[i], out1[i], std::min(limiter[0].gain, limiter[1].gain));
     }
   } else {
     for (size_t i = 0; i < length; ++i) {
       auto &&inAbs = processStereoLink(in0[i], in1[i]);
       out0[i] = limiter[0].process(in0[i], inAbs[0]);
       out1[i] = limiter[1].process(in1[i], inAbs[1]);
+      telemetry.process(out0[i], out1[i], std::min(limiter[0].gain, limiter[1].gain));
     }
   }
 
@@ -130,3 +143,8 @@ void DSPCore::process(
   auto &&previousPeak = paramClippingPeak->getFloat();
   if (maxOut > previousPeak) paramClippingPeak->setFromFloat(maxOut);
 }
+
+template void DSPCore::process<float>(
+  const size_t length, const float *in0, const float *in1, float *out0, float *out1);
+template void DSPCore::process<double>(
+  const size_t length, const double *in0, const double *in1, double *out0, double *out1);
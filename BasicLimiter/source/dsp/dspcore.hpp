@@ -9,6 +9,7 @@
 
 #include "../../../common/dsp/constants.hpp"
 #include "../../../common/dsp/smoother.hpp"
+#include "../../../common/dsp/telemetry.hpp"
 #include "../parameter.hpp"
 #include "limiter.hpp"
 #include "polyphase.hpp"
@@ -24,14 +25,21 @@ using DownSamplerFir = DownSamplerFir8Fold<float>;
 class DSPCore {
 public:
   GlobalParameter param;
+  SmootherState<float> smootherState;
+  TelemetryMeter telemetry;
 
   void setup(double sampleRate);
   void reset();
   void startup();
   size_t getLatency();
   void setParameters();
+  template<typename Sample>
   void process(
-    const size_t length, const float *in0, const float *in1, float *out0, float *out1);
+    const size_t length,
+    const Sample *in0,
+    const Sample *in1,
+    Sample *out0,
+    Sample *out1);
 
 private:
   std::array<float, 2> processStereoLink(float in0, float in1);
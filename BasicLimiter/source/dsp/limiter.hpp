@@ -266,6 +266,8 @@ private:
   IntDelay<Sample> lookaheadDelay;
 
 public:
+  Sample gain = Sample(1); // Gain applied to the last output. Used for metering.
+
   size_t latency(size_t upfold) { return attackFrames / upfold; }
 
   void resize(size_t size)
@@ -286,6 +288,7 @@ public:
     smoother.reset();
     releaseFilter.reset(Sample(thresholdAmplitude));
     lookaheadDelay.reset();
+    gain = Sample(1);
   }
 
   void prepare(
@@ -336,6 +339,7 @@ public:
     auto targetAmp = peakAmp < gateAmp ? 0 : gainAmp;
     auto smoothed = smoother.process(targetAmp);
     auto delayed = lookaheadDelay.process(input);
+    gain = Sample(smoothed);
     return smoothed * delayed;
   }
 };
@@ -22,7 +22,7 @@ constexpr float limiterLabelWidth = 100.0f;
 constexpr float checkboxWidth = 2.0f * limiterLabelWidth;
 
 constexpr uint32_t defaultWidth = uint32_t(2 * uiMargin + 2 * limiterLabelWidth);
-constexpr uint32_t defaultHeight = uint32_t(2 * uiMargin + 8 * labelY + splashHeight);
+constexpr uint32_t defaultHeight = uint32_t(2 * uiMargin + 9 * labelY + splashHeight);
 
 namespace Steinberg {
 namespace Vst {
@@ -40,6 +40,7 @@ Editor::Editor(void *controller) : PlugEditor(controller)
 Editor::~Editor()
 {
   if (infoTextView) infoTextView->forget();
+  if (meterTextView) meterTextView->forget();
 }
 
 ParamValue Editor::getPlainValue(ParamID id)
@@ -91,6 +92,20 @@ void Editor::updateUI(ParamID id, ParamValue normalized)
   infoTextView->setDirty();
 }
 
+void Editor::onTelemetry(const SomeDSP::TelemetryFrame &telemetryFrame)
+{
+  if (meterTextView == nullptr) return;
+
+  auto &&rdlm = TextTableView::rowDelimiter;
+  auto &&cdlm = TextTableView::colDelimiter;
+  auto reduction = ampToDecibel(std::max(telemetryFrame.gainReduction, 1e-5f));
+  std::ostringstream os;
+  os.precision(5);
+  os << std::fixed << "Reduction [dB]" << cdlm << reduction << rdlm;
+  meterTextView->setText(os.str());
+  meterTextView->setDirty();
+}
+
 bool Editor::prepareUI()
 {
   using ID = Synth::ParameterID::ID;
@@ -111,6 +126,7 @@ bool Editor::prepareUI()
   const auto topLimiter6 = top0 + 5 * labelY;
   const auto topLimiter7 = top0 + 6 * labelY;
   const auto topLimiter8 = top0 + 7 * labelY;
+  const auto topLimiter9 = top0 + 8 * labelY;
 
   addLabel(
     leftLimiter0, topLimiter1, limiterLabelWidth, labelHeight, uiTextSize,
@@ -168,6 +184,12 @@ bool Editor::prepareUI()
     "Overshoot [dB]", limiterLabelWidth);
   infoTextView->remember();
 
+  if (meterTextView) meterTextView->forget();
+  meterTextView = addTextTableView(
+    leftLimiter0, topLimiter9, 2 * limiterLabelWidth, labelHeight, uiTextSize,
+    "Reduction [dB]", limiterLabelWidth);
+  meterTextView->remember();
+
   // Plugin name.
   const auto splashMargin = margin;
   const auto splashTop = defaultHeight - splashHeight - uiMargin + margin;
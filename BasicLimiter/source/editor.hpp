@@ -18,11 +18,13 @@ public:
 
   virtual void valueChanged(CControl *pControl) override;
   void updateUI(Vst::ParamID id, ParamValue normalized) override;
+  void onTelemetry(const SomeDSP::TelemetryFrame &telemetryFrame) override;
 
   DELEGATE_REFCOUNT(VSTGUIEditor);
 
 protected:
   TextTableView *infoTextView = nullptr;
+  TextTableView *meterTextView = nullptr;
   ParamValue getPlainValue(ParamID id);
   bool prepareUI() override;
 };
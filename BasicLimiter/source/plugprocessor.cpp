@@ -50,9 +50,15 @@ uint32 PLUGIN_API PlugProcessor::getProcessContextRequirements()
   return Rq::kNeedTransportState;
 }
 
+tresult PLUGIN_API PlugProcessor::canProcessSampleSize(int32 symbolicSampleSize)
+{
+  return canProcess32Or64(symbolicSampleSize);
+}
+
 tresult PLUGIN_API PlugProcessor::setupProcessing(Vst::ProcessSetup &setup)
 {
   dsp.setup(processSetup.sampleRate);
+  automation.setup(setup.maxSamplesPerBlock, dsp.param.value.size());
   return AudioEffect::setupProcessing(setup);
 }
 
@@ -60,7 +66,10 @@ tresult PLUGIN_API PlugProcessor::setActive(TBool state)
 {
   if (state) {
     dsp.setup(processSetup.sampleRate);
+    telemetryLink.open(this, dsp.telemetry.queue);
+    silence.setup(processSetup.sampleRate);
   } else {
+    telemetryLink.close(this);
     dsp.reset();
     lastState = 0;
   }
@@ -73,20 +82,8 @@ tresult PLUGIN_API PlugProcessor::process(Vst::ProcessData &data)
 {
   using ID = ParameterID::ID;
 
-  // Read inputs parameter changes.
-  if (data.inputParameterChanges) {
-    int32 parameterCount = data.inputParameterChanges->getParameterCount();
-    for (int32 index = 0; index < parameterCount; index++) {
-      auto queue = data.inputParameterChanges->getParameterData(index);
-      if (!queue) continue;
-      Vst::ParamValue value;
-      int32 sampleOffset;
-      if (queue->getPoint(queue->getPointCount() - 1, sampleOffset, value) != kResultTrue)
-        continue;
-      size_t id = queue->getParameterId();
-      if (id < dsp.param.value.size()) dsp.param.value[id]->setFromNormalized(value);
-    }
-  }
+  // Read inputs parameter changes and events.
+  automation.receive(data, dsp.param);
 
   if (data.processContext != nullptr) {
     uint64_t state = data.processContext->state;
@@ -99,27 +96,19 @@ tresult PLUGIN_API PlugProcessor::process(Vst::ProcessData &data)
     lastState = state;
   }
 
-  dsp.setParameters();
-
-  if (data.numInputs == 0) return kResultOk;
-  if (data.numOutputs == 0) return kResultOk;
-  if (data.numSamples <= 0) return kResultOk;
-  if (data.inputs[0].numChannels < 2) return kResultOk;
-  if (data.outputs[0].numChannels < 2) return kResultOk;
-  if (data.symbolicSampleSize == Vst::kSample64) return kResultOk;
+  if (
+    data.numInputs == 0 || data.numOutputs == 0 || data.numSamples <= 0
+    || data.inputs[0].numChannels < 2 || data.outputs[0].numChannels < 2)
+  {
+    automation.flush(dsp.param);
+    return kResultOk;
+  }
 
-  auto isBypassing = dsp.param.value[ParameterID::bypass]->getInt();
-  if (isBypassing) {
-    if (!wasBypassing) dsp.reset();
-    processBypass(data);
+  if (data.symbolicSampleSize == Vst::kSample64) {
+    processAudio<Vst::Sample64>(data);
   } else {
-    float *in0 = data.inputs[0].channelBuffers32[0];
-    float *in1 = data.inputs[0].channelBuffers32[1];
-    float *out0 = data.outputs[0].channelBuffers32[0];
-    float *out1 = data.outputs[0].channelBuffers32[1];
-    dsp.process((size_t)data.numSamples, in0, in1, out0, out1);
+    processAudio<Vst::Sample32>(data);
   }
-  wasBypassing = isBypassing;
 
   // Send parameter changes for GUI.
   if (!data.outputParameterChanges) return kResultOk;
@@ -133,12 +122,37 @@ tresult PLUGIN_API PlugProcessor::process(Vst::ProcessData &data)
   return kResultOk;
 }
 
-void PlugProcessor::processBypass(Vst::ProcessData &data)
+template<typename Sample> void PlugProcessor::processAudio(Vst::ProcessData &data)
+{
+  Sample *in0 = channelBuffers<Sample>(data.inputs[0])[0];
+  Sample *in1 = channelBuffers<Sample>(data.inputs[0])[1];
+  Sample *out0 = channelBuffers<Sample>(data.outputs[0])[0];
+  Sample *out1 = channelBuffers<Sample>(data.outputs[0])[1];
+  if (silence.skip<Sample>(data, automation.isIdle())) return;
+  automation.dispatch(data.numSamples, dsp.param, [&](int32 offset, int32 length) {
+    dsp.setParameters();
+
+    auto isBypassing = dsp.param.value[ParameterID::bypass]->getInt();
+    if (isBypassing) {
+      if (!wasBypassing) dsp.reset();
+      processBypass<Sample>(data, offset, length);
+    } else {
+      dsp.process(
+        size_t(length), in0 + offset, in1 + offset, out0 + offset, out1 + offset);
+    }
+    wasBypassing = isBypassing;
+  });
+  silence.update<Sample>(data);
+}
+
+template<typename Sample>
+void PlugProcessor::processBypass(Vst::ProcessData &data, int32 offset, int32 length)
 {
-  float **in = data.inputs[0].channelBuffers32;
-  float **out = data.outputs[0].channelBuffers32;
+  Sample **in = channelBuffers<Sample>(data.inputs[0]);
+  Sample **out = channelBuffers<Sample>(data.outputs[0]);
   for (int32_t ch = 0; ch < data.inputs[0].numChannels; ch++) {
-    if (in[ch] != out[ch]) memcpy(out[ch], in[ch], data.numSamples * sizeof(float));
+    if (in[ch] != out[ch])
+      memcpy(out[ch] + offset, in[ch] + offset, length * sizeof(Sample));
   }
 }
 
@@ -8,15 +8,17 @@
 #include <algorithm>
 #include <numeric>
 
-inline float maxAbs(const size_t length, const float *buffer)
+template<typename Sample> inline Sample maxAbs(const size_t length, const Sample *buffer)
 {
-  float max = 0.0f;
+  Sample max = 0;
   for (size_t i = 0; i < length; ++i) max = std::max(max, std::fabs(buffer[i]));
   return max;
 }
 
 void DSPCore::setup(double sampleRate)
 {
+  SmootherCommon<float>::Scope smootherScope(smootherState);
+
   this->sampleRate = float(sampleRate);
 
   SmootherCommon<float>::setSampleRate(this->sampleRate);
@@ -53,6 +55,8 @@ size_t DSPCore::getLatency()
 
 void DSPCore::reset()
 {
+  SmootherCommon<float>::Scope smootherScope(smootherState);
+
   ASSIGN_PARAMETER(reset);
 
   pv[ID::overshoot]->setFromFloat(1.0);
@@ -75,6 +79,8 @@ void DSPCore::startup() {}
 
 void DSPCore::setParameters()
 {
+  SmootherCommon<float>::Scope smootherScope(smootherState);
+
   ASSIGN_PARAMETER(push);
 
   auto upfold = param.value[ParameterID::truePeak]->getInt() ? UpSamplerFir::upfold : 1;
@@ -118,15 +124,17 @@ inline void convertToLeftRight(float &mid, float &side)
   side = right;
 }
 
+template<typename Sample>
 void DSPCore::process(
   const size_t length,
-  const float *in0,
-  const float *in1,
-  const float *in2,
-  const float *in3,
-  float *out0,
-  float *out1)
+  const Sample *in0,
+  const Sample *in1,
+  const Sample *in2,
+  const Sample *in3,
+  Sample *out0,
+  Sample *out1)
 {
+  SmootherCommon<float>::Scope smootherScope(smootherState);
   ScopedNoDenormals scopedDenormals;
 
   using ID = ParameterID::ID;
@@ -135,8 +143,8 @@ void DSPCore::process(
   SmootherCommon<float>::setBufferSize(float(length));
 
   bool &&enableSidechain = pv[ID::sidechain]->getInt();
-  const float *sidechain0 = enableSidechain ? in2 : in0;
-  const float *sidechain1 = enableSidechain ? in3 : in1;
+  const Sample *sidechain0 = enableSidechain ? in2 : in0;
+  const Sample *sidechain1 = enableSidechain ? in3 : in1;
 
   bool &&enableMidSide = pv[ID::channelType]->getInt();
 
@@ -146,8 +154,8 @@ void DSPCore::process(
   if (pv[ID::truePeak]->getInt()) {
     constexpr size_t upfold = UpSamplerFir::upfold;
     for (size_t i = 0; i < length; ++i) {
-      auto sig0 = in0[i];
-      auto sig1 = in1[i];
+      float sig0 = in0[i];
+      float sig1 = in1[i];
       if (enableMidSide) convertToMidSide(sig0, sig1);
 
       sig0 = highEliminatorMain[0].process(sig0);
@@ -187,12 +195,12 @@ void DSPCore::process(
     }
   } else {
     for (size_t i = 0; i < length; ++i) {
-      auto sig0 = in0[i];
-      auto sig1 = in1[i];
+      float sig0 = in0[i];
+      float sig1 = in1[i];
       if (enableMidSide) convertToMidSide(sig0, sig1);
 
-      auto side0 = sidechain0[i];
-      auto side1 = sidechain1[i];
+      float side0 = sidechain0[i];
+      float side1 = sidechain1[i];
       if (enableMidSide) convertToMidSide(side0, side1);
 
       auto threshold = interpThreshold.process();
@@ -212,3 +220,20 @@ void DSPCore::process(
   auto previousPeak = pv[ID::overshoot]->getFloat();
   if (maxOut > previousPeak) pv[ID::overshoot]->setFromFloat(maxOut);
 }
+
+template void DSPCore::process<float>(
+  const size_t length,
+  const float *in0,
+  const float *in1,
+  const float *in2,
+  const float *in3,
+  float *out0,
+  float *out1);
+template void DSPCore::process<double>(
+  const size_t length,
+  const double *in0,
+  const double *in1,
+  const double *in2,
+  const double *in3,
+  double *out0,
+  double *out1);
@@ -24,19 +24,21 @@ using DownSamplerFir = DownSamplerFir8Fold<float>;
 class DSPCore {
 public:
   GlobalParameter param;
+  SmootherState<float> smootherState;
   void setup(double sampleRate);
   void reset();
   void startup();
   size_t getLatency();
   void setParameters();
+  template<typename Sample>
   void process(
     const size_t length,
-    const float *in0,
-    const float *in1,
-    const float *in2,
-    const float *in3,
-    float *out0,
-    float *out1);
+    const Sample *in0,
+    const Sample *in1,
+    const Sample *in2,
+    const Sample *in3,
+    Sample *out0,
+    Sample *out1);
 
 private:
   std::array<float, 2> processStereoLink(float in0, float in1);
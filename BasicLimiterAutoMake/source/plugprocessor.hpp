@@ -10,6 +10,9 @@
 
 #include "public.sdk/source/vst/vstaudioeffect.h"
 
+#include "../../common/automationdispatcher.hpp"
+#include "../../common/channelbuffers.hpp"
+#include "../../common/silencedetector.hpp"
 #include "dsp/dspcore.hpp"
 
 namespace Steinberg {
@@ -26,6 +29,8 @@ public:
     Vst::SpeakerArrangement *outputs,
     int32 numOuts) SMTG_OVERRIDE;
   uint32 PLUGIN_API getProcessContextRequirements() SMTG_OVERRIDE;
+  tresult PLUGIN_API canProcessSampleSize(int32 symbolicSampleSize) SMTG_OVERRIDE;
+  uint32 PLUGIN_API getTailSamples() SMTG_OVERRIDE { return silence.getTailSamples(); }
 
   tresult PLUGIN_API setupProcessing(Vst::ProcessSetup &setup) SMTG_OVERRIDE;
   tresult PLUGIN_API setActive(TBool state) SMTG_OVERRIDE;
@@ -41,7 +46,9 @@ public:
     return (Vst::IAudioProcessor *)new PlugProcessor();
   }
 
-  void processBypass(Vst::ProcessData &data);
+  template<typename Sample> void processAudio(Vst::ProcessData &data);
+  template<typename Sample>
+  void processBypass(Vst::ProcessData &data, int32 offset, int32 length);
 
 protected:
   inline int32 toDiscrete(Vst::ParamValue normalized, int32 stepCount)
@@ -51,6 +58,8 @@ protected:
 
   uint64_t lastState = 0;
   uint32_t wasBypassing = 0;
+  AutomationDispatcher automation;
+  SilenceDetector silence;
   DSPCore dsp;
 };
 
@@ -55,6 +55,8 @@ void Note::setup(float sampleRate)
 
 void DSPCore::setup(double sampleRate)
 {
+  SmootherCommon<float>::Scope smootherScope(smootherState);
+
   noteStack.reserve(1024);
   noteStack.resize(0);
 
@@ -213,6 +215,8 @@ void Note::reset(float sampleRate, GlobalParameter &param)
 
 void DSPCore::reset()
 {
+  SmootherCommon<float>::Scope smootherScope(smootherState);
+
   using ID = ParameterID::ID;
   auto &pv = param.value;
 
@@ -275,6 +279,8 @@ void Note::setParameters(float sampleRate, GlobalParameter &param)
 
 void DSPCore::setParameters()
 {
+  SmootherCommon<float>::Scope smootherScope(smootherState);
+
   using ID = ParameterID::ID;
   auto &pv = param.value;
 
@@ -384,12 +390,13 @@ float Note::process(float sampleRate)
 
 void DSPCore::process(const size_t length, float *out0, float *out1)
 {
+  SmootherCommon<float>::Scope smootherScope(smootherState);
   ScopedNoDenormals scopedDenormals;
 
   using ID = ParameterID::ID;
   const auto &pv = param.value;
 
-  SmootherCommon<double>::setSampleRate(upRate);
+  SmootherCommon<float>::setSampleRate(upRate);
   SmootherCommon<float>::setTime(pv[ID::commonSmoothingTimeSecond]->getFloat());
   SmootherCommon<float>::setBufferSize(float(length));
 
@@ -560,6 +567,8 @@ void Note::release(float sampleRate, GlobalParameter &param)
 void DSPCore::noteOn(
   int_fast32_t noteId, int_fast16_t pitch, float tuning, float velocity)
 {
+  SmootherCommon<float>::Scope smootherScope(smootherState);
+
   using ID = ParameterID::ID;
   auto &pv = param.value;
 
@@ -577,6 +586,8 @@ void DSPCore::noteOn(
 
 void DSPCore::noteOff(int_fast32_t noteId)
 {
+  SmootherCommon<float>::Scope smootherScope(smootherState);
+
   auto it = std::find_if(noteStack.begin(), noteStack.end(), [&](const NoteInfo &info) {
     return info.id == noteId;
   });
@@ -4,6 +4,7 @@
 #pragma once
 
 #include "../../../common/dsp/constants.hpp"
+#include "../../../common/dsp/paralleldelaybank.hpp"
 #include "../../../common/dsp/smoother.hpp"
 #include "../../../lib/pcg-cpp/pcg_random.hpp"
 #include "svf.hpp"
@@ -55,8 +56,7 @@ template<typename Sample, size_t length> class ParallelDelay {
 public:
   std::array<Sample, length> targetTime{};
   std::array<Sample, length> time{};
-  std::array<size_t, length> wptr{};
-  std::array<std::vector<Sample>, length> buffer;
+  ParallelDelayBank<Sample, length> bank;
 
   Sample rate = Sample(0.25);
   Sample kp = Sample(1);
@@ -64,7 +64,7 @@ public:
   void setup(Sample sampleRate, Sample maxTime)
   {
     auto size = size_t(sampleRate * maxTime) + 2;
-    for (auto &bf : buffer) bf.resize(size < 4 ? 4 : size);
+    bank.setup(Sample(std::max(size, size_t(4)) - 1));
 
     reset();
   }
@@ -73,7 +73,7 @@ public:
   {
     targetTime.fill(timeInSample);
     time.fill(timeInSample);
-    for (auto &bf : buffer) std::fill(bf.begin(), bf.end(), Sample(0));
+    bank.reset();
   }
 
   void setDelayTimeAt(size_t index, Sample sampleRate, Sample overtone, Sample noteFreq)
@@ -82,7 +82,7 @@ public:
     overtone = std::max(eps, overtone);
     noteFreq = std::max(eps, noteFreq);
     targetTime[index] = std::clamp(
-      sampleRate / overtone / noteFreq, Sample(0), Sample(buffer[index].size() - 1));
+      sampleRate / overtone / noteFreq, Sample(0), bank.getMaxTime());
   }
 
   void resetDelayTimeAt(size_t index, Sample sampleRate, Sample overtone, Sample noteFreq)
@@ -103,25 +103,9 @@ public:
       } else if (diff < -rate) {
         time[idx] = prevTime - rate;
       }
-
-      // Set delay time.
-      size_t timeInt = size_t(time[idx]);
-      Sample rFraction = time[idx] - Sample(timeInt);
-
-      auto &buf = buffer[idx];
-
-      size_t rptr0 = wptr[idx] - timeInt;
-      size_t rptr1 = rptr0 - 1;
-      if (rptr0 >= buf.size()) rptr0 += buf.size(); // Unsigned negative overflow case.
-      if (rptr1 >= buf.size()) rptr1 += buf.size(); // Unsigned negative overflow case.
-
-      // Write to buffer.
-      buf[wptr[idx]] = input[idx];
-      if (++wptr[idx] >= buf.size()) wptr[idx] -= buf.size();
-
-      // Read from buffer.
-      input[idx] = buf[rptr0] + rFraction * (buf[rptr1] - buf[rptr0]);
     }
+
+    bank.process(input, time);
   }
 };
 
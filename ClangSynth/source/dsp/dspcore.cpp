@@ -40,6 +40,8 @@ void Note::setup(float sampleRate) { fdn.setup(sampleRate, maxDelayTime); }
 
 void DSPCore::setup(double sampleRate)
 {
+  SmootherCommon<float>::Scope smootherScope(smootherState);
+
   this->sampleRate = float(sampleRate);
   upRate = upFold * this->sampleRate;
 
@@ -47,6 +49,7 @@ void DSPCore::setup(double sampleRate)
 
   info.synchronizer.reset(upRate, defaultTempo, float(1));
   info.smootherKp = float(EMAFilter<double>::cutoffToP(sampleRate, 100));
+  info.wavetableFadeStep = float(1) / (float(0.01) * upRate);
 
   // 10 msec + 1 sample transition time.
   transitionBuffer.resize(1 + size_t(upRate * double(0.005)), {float(0), float(0)});
@@ -60,22 +63,22 @@ void DSPCore::setup(double sampleRate)
   /* To prevent blow up, upper limit of cutoff is set to slightly below Nyquist          \
    * frequency. */                                                                       \
   auto nyquist = float(0.49998) * sampleRate;                                            \
-  auto lowpassCutoffHz = pv[ID::lowpassKeyFollow]->getInt()                              \
+  auto lowpassCutoffHz = pv.getInt(ID::lowpassKeyFollow)                                 \
     ? semitoneToHz(                                                                      \
-        pv[ID::lowpassCutoffSemi]->getFloat() + float(69), float(12), fdnFreq)           \
-    : semitoneToHz(pv[ID::lowpassCutoffSemi]->getFloat());                               \
+        pv.getFloat(ID::lowpassCutoffSemi) + float(69), float(12), fdnFreq)              \
+    : semitoneToHz(pv.getFloat(ID::lowpassCutoffSemi));                                  \
   fdnLowpassCutoff.METHOD(std::clamp(lowpassCutoffHz, float(1), nyquist) / sampleRate);  \
                                                                                          \
-  auto highpassCutoffHz = pv[ID::highpassKeyFollow]->getInt()                            \
+  auto highpassCutoffHz = pv.getInt(ID::highpassKeyFollow)                               \
     ? semitoneToHz(                                                                      \
-        pv[ID::highpassCutoffSemi]->getFloat() + float(69), float(12), fdnFreq)          \
-    : semitoneToHz(pv[ID::highpassCutoffSemi]->getFloat());                              \
+        pv.getFloat(ID::highpassCutoffSemi) + float(69), float(12), fdnFreq)             \
+    : semitoneToHz(pv.getFloat(ID::highpassCutoffSemi));                                 \
   fdnHighpassCutoff.METHOD(std::clamp(highpassCutoffHz, float(1), nyquist) / sampleRate);
 
 void Note::reset(float sampleRate, NoteProcessInfo &info, GlobalParameter &param)
 {
   using ID = ParameterID::ID;
-  auto &pv = param.value;
+  auto &pv = param.store;
 
   state = NoteState::rest;
   id = -1;
@@ -93,7 +96,7 @@ void Note::reset(float sampleRate, NoteProcessInfo &info, GlobalParameter &param
   auto fdnFreq = info.fdnFreqOffset.getValue() * fdnPitch;
   SET_NOTE_FILTER_CUTOFF(reset);
 
-  auto gateAttackSecond = pv[ID::gateAttackSecond]->getFloat();
+  auto gateAttackSecond = pv.getFloat(ID::gateAttackSecond);
   gateSmoother.setCutoff(
     sampleRate,
     gateAttackSecond < std::numeric_limits<float>::epsilon()
@@ -103,18 +106,24 @@ void Note::reset(float sampleRate, NoteProcessInfo &info, GlobalParameter &param
 }
 
 #define ASSIGN_PARAMETER(METHOD)                                                         \
-  nVoice = pv[ID::nVoice]->getInt() + 1;                                                 \
+  nVoice = pv.getInt(ID::nVoice) + 1;                                                    \
   if (nVoice > notes.size()) nVoice = notes.size();                                      \
                                                                                          \
-  interpMasterGain.METHOD(pv[ID::gain]->getFloat());
+  if (pv.isDirty(ID::gain)) interpMasterGain.METHOD(pv.getFloat(ID::gain));
 
 void DSPCore::reset()
 {
+  SmootherCommon<float>::Scope smootherScope(smootherState);
+
   using ID = ParameterID::ID;
-  auto &pv = param.value;
+  auto &pv = param.store;
+
+  param.store.markAllDirty();
 
   info.reset(param);
   info.synchronizer.reset(upRate, tempo, getTempoSyncInterval());
+  info.wavetable.reset(getWavetableParameter());
+  info.wavetableFade = float(1);
 
   ASSIGN_PARAMETER(reset);
 
@@ -131,51 +140,69 @@ void DSPCore::reset()
 float DSPCore::getTempoSyncInterval()
 {
   using ID = ParameterID::ID;
-  const auto &pv = param.value;
+  const auto &pv = param.store;
 
-  auto lfoRate = pv[ID::lfoRate]->getFloat();
+  auto lfoRate = pv.getFloat(ID::lfoRate);
   if (lfoRate > Scales::lfoRate.getMax()) return 0;
 
   // Multiplying with 4 because 1 beat is 1/4 bar.
-  auto &&upper = pv[ID::lfoTempoUpper]->getFloat() + float(1);
-  auto &&lower = pv[ID::lfoTempoLower]->getFloat() + float(1);
+  auto &&upper = pv.getFloat(ID::lfoTempoUpper) + float(1);
+  auto &&lower = pv.getFloat(ID::lfoTempoLower) + float(1);
   return float(4) * upper / lower / lfoRate;
 }
 
+WavetableParameter<float, oscOvertoneSize> DSPCore::getWavetableParameter()
+{
+  using ID = ParameterID::ID;
+  const auto &pv = param.store;
+
+  WavetableParameter<float, oscOvertoneSize> wp;
+  wp.upRate = upRate;
+  wp.denominatorSlope = pv.getFloat(ID::oscSpectrumDenominatorSlope);
+  wp.rotationSlope = pv.getFloat(ID::oscSpectrumRotationSlope);
+  wp.rotationOffset = pv.getFloat(ID::oscSpectrumRotationOffset);
+  wp.interval = 1 + pv.getInt(ID::oscSpectrumInterval);
+  wp.highpassIndex = pv.getInt(ID::oscSpectrumHighpass);
+  wp.blur = pv.getFloat(ID::oscSpectrumBlur);
+  for (size_t idx = 0; idx < oscOvertoneSize; ++idx) {
+    wp.overtoneAmp[idx] = std::polar(
+      pv.getFloat(ID::oscOvertone0 + idx),
+      float(pi) * pv.getFloat(ID::oscRotation0 + idx));
+  }
+  return wp;
+}
+
 void DSPCore::startup()
 {
+  SmootherCommon<float>::Scope smootherScope(smootherState);
+
   info.synchronizer.reset(upRate, tempo, getTempoSyncInterval());
 }
 
 void Note::setParameters(float sampleRate, NoteProcessInfo &info, GlobalParameter &param)
 {
   using ID = ParameterID::ID;
-  auto &pv = param.value;
+  auto &pv = param.store;
 
-  gate.prepare(sampleRate, pv[ID::gateReleaseSecond]->getFloat());
+  gate.setKp(info.gateReleaseKp);
+  gateSmoother.kp = info.gateAttackKp;
 
-  auto gateAttackSecond = pv[ID::gateAttackSecond]->getFloat();
-  gateSmoother.setCutoff(
-    sampleRate,
-    gateAttackSecond < std::numeric_limits<float>::epsilon()
-      ? sampleRate
-      : float(1) / gateAttackSecond);
-
-  fdn.delay.rate = pv[ID::fdnInterpRate]->getFloat();
-  auto fdnInterpLowpassSecond = pv[ID::fdnInterpLowpassSecond]->getFloat();
-  fdn.delay.kp = fdnInterpLowpassSecond == 0
-    ? float(1)
-    : float(EMAFilter<double>::cutoffToP(sampleRate, double(1) / fdnInterpLowpassSecond));
+  fdn.delay.rate = pv.getFloat(ID::fdnInterpRate);
+  fdn.delay.kp = info.fdnInterpKp;
   auto fdnFreq = info.fdnFreqOffset.getValue() * fdnPitch;
   SET_NOTE_FILTER_CUTOFF(push);
 }
 
 void DSPCore::setParameters()
 {
+  SmootherCommon<float>::Scope smootherScope(smootherState);
+
   using ID = ParameterID::ID;
-  auto &pv = param.value;
+  auto &pv = param.store;
 
-  info.setParameters(param);
+  pv.fetchDirty();
+
+  info.setParameters(upRate, param);
 
   ASSIGN_PARAMETER(push);
 
@@ -184,23 +211,11 @@ void DSPCore::setParameters()
     note.setParameters(upRate, info, param);
   }
 
-  if (prepareRefresh || (!isWavetableRefeshed && pv[ID::refreshWavetable]->getInt())) {
-    info.wavetable.param.denominatorSlope
-      = pv[ID::oscSpectrumDenominatorSlope]->getFloat();
-    info.wavetable.param.rotationSlope = pv[ID::oscSpectrumRotationSlope]->getFloat();
-    info.wavetable.param.rotationOffset = pv[ID::oscSpectrumRotationOffset]->getFloat();
-    info.wavetable.param.interval = 1 + pv[ID::oscSpectrumInterval]->getInt();
-    info.wavetable.param.highpassIndex = pv[ID::oscSpectrumHighpass]->getInt();
-    info.wavetable.param.blur = pv[ID::oscSpectrumBlur]->getFloat();
-    for (size_t idx = 0; idx < oscOvertoneSize; ++idx) {
-      info.wavetable.param.overtoneAmp[idx] = std::polar(
-        pv[ID::oscOvertone0 + idx]->getFloat(),
-        float(pi) * pv[ID::oscRotation0 + idx]->getFloat());
-    }
-    info.wavetable.fillTable(upRate);
+  // Table is built on worker thread, and swapped in at the start of a later `process`.
+  if (!isWavetableRefeshed && pv.getInt(ID::refreshWavetable)) {
+    info.wavetable.request(getWavetableParameter());
   }
-  isWavetableRefeshed = pv[ID::refreshWavetable]->getInt();
-  prepareRefresh = false;
+  isWavetableRefeshed = pv.getInt(ID::refreshWavetable);
 }
 
 inline float alignModValue(float amount, float alignment, float value)
@@ -239,7 +254,10 @@ std::array<float, 2> Note::process(float sampleRate, NoteProcessInfo &info)
   auto oscGain = envelope.process() * velocity;
   if (oscGain >= eps) {
     auto nt = oscPitchMod + oscNote + info.oscNoteOffset.getValue();
-    sig += oscGain * osc.process(sampleRate, nt, info.wavetable);
+    sig += oscGain
+      * osc.process(
+        sampleRate, nt, info.wavetable.get(), info.wavetable.getPrevious(),
+        info.wavetableFade);
   }
 
   if (info.fdnEnable) {
@@ -290,16 +308,19 @@ std::array<float, 2> Note::process(float sampleRate, NoteProcessInfo &info)
 
 void DSPCore::process(const size_t length, float *out0, float *out1)
 {
+  SmootherCommon<float>::Scope smootherScope(smootherState);
   ScopedNoDenormals scopedDenormals;
 
   using ID = ParameterID::ID;
-  const auto &pv = param.value;
+  const auto &pv = param.store;
 
-  SmootherCommon<float>::setTime(pv[ID::smoothingTimeSecond]->getFloat());
+  SmootherCommon<float>::setTime(pv.getFloat(ID::smoothingTimeSecond));
   SmootherCommon<float>::setBufferSize(float(length));
 
+  if (info.wavetable.acquire()) info.wavetableFade = float(0);
+
   // When tempo-sync is off, use defaultTempo BPM.
-  bool isTempoSyncing = pv[ID::lfoTempoSync]->getInt();
+  bool isTempoSyncing = pv.getInt(ID::lfoTempoSync);
   info.synchronizer.prepare(
     upRate, isTempoSyncing ? tempo : defaultTempo, getTempoSyncInterval(), beatsElapsed,
     !isTempoSyncing || !isPlaying);
@@ -347,7 +368,7 @@ void Note::noteOn(
   GlobalParameter &param)
 {
   using ID = ParameterID::ID;
-  auto &pv = param.value;
+  auto &pv = param.store;
 
   id = noteId;
 
@@ -357,10 +378,10 @@ void Note::noteOn(
 
   gate.reset();
 
-  modEnvelopePhase.noteOn(sampleRate, pv[ID::modEnvelopeTime]->getFloat());
+  modEnvelopePhase.noteOn(sampleRate, pv.getFloat(ID::modEnvelopeTime));
 
   // Pitch.
-  const auto eqTemp = pv[ID::equalTemperament]->getFloat() + 1;
+  const auto eqTemp = pv.getFloat(ID::equalTemperament) + 1;
 
   fdnPitch = calcNotePitch(notePitch, eqTemp);
   auto fdnFreq = info.fdnFreqOffset.getValue() * fdnPitch;
@@ -368,22 +389,22 @@ void Note::noteOn(
   oscNote = float(12) / eqTemp * (notePitch - 69) + 69;
 
   // Oscillator.
-  impulse = pv[ID::impulseGain]->getFloat();
+  impulse = pv.getFloat(ID::impulseGain);
   envelope.noteOn(
-    pv[ID::oscGain]->getFloat(), sampleRate * pv[ID::oscAttack]->getFloat(),
-    sampleRate * pv[ID::oscDecay]->getFloat());
+    pv.getFloat(ID::oscGain), sampleRate * pv.getFloat(ID::oscAttack),
+    sampleRate * pv.getFloat(ID::oscDecay));
 
   // FDN matrix.
   std::uniform_int_distribution<unsigned> seedDist{
     0, std::numeric_limits<unsigned>::max()};
 
   fdn.randomOrthogonal(
-    seedDist(info.fdnRng), pv[ID::fdnMatrixIdentityAmount]->getFloat(),
-    pv[ID::fdnRandomizeRatio]->getFloat(), info.fdnMatrixRandomBase);
+    seedDist(info.fdnRng), pv.getFloat(ID::fdnMatrixIdentityAmount),
+    pv.getFloat(ID::fdnRandomizeRatio), info.fdnMatrixRandomBase);
 
   // FDN delay.
-  fdn.delay.rate = pv[ID::fdnInterpRate]->getFloat();
-  auto fdnInterpLowpassSecond = pv[ID::fdnInterpLowpassSecond]->getFloat();
+  fdn.delay.rate = pv.getFloat(ID::fdnInterpRate);
+  auto fdnInterpLowpassSecond = pv.getFloat(ID::fdnInterpLowpassSecond);
   fdn.delay.kp = fdnInterpLowpassSecond == 0
     ? float(1)
     : float(EMAFilter<double>::cutoffToP(sampleRate, 1.0 / fdnInterpLowpassSecond));
@@ -391,18 +412,18 @@ void Note::noteOn(
   std::uniform_real_distribution<float> overtoneDist(-1.0, 1.0);
   for (size_t idx = 0; idx < fdnMatrixSize; ++idx) {
     overtoneRandomness[idx]
-      = overtoneDist(info.fdnRng) * pv[ID::fdnOvertoneRandomness]->getFloat();
+      = overtoneDist(info.fdnRng) * pv.getFloat(ID::fdnOvertoneRandomness);
   }
 
   // Resetting.
-  bool resetAtNoteOn = pv[ID::resetAtNoteOn]->getInt();
+  bool resetAtNoteOn = pv.getInt(ID::resetAtNoteOn);
 
   if (resetAtNoteOn || state == NoteState::rest) {
     this->pan.reset(pan);
     gateSmoother.reset();
 
     osc.reset();
-    lfoPhase.offset = pv[ID::lfoRetrigger]->getInt() ? -info.synchronizer.getPhase() : 0;
+    lfoPhase.offset = pv.getInt(ID::lfoRetrigger) ? -info.synchronizer.getPhase() : 0;
 
     fdn.reset();
 
@@ -452,10 +473,12 @@ float Note::getGain() { return gain; }
 void DSPCore::noteOn(
   int_fast32_t noteId, int_fast16_t pitch, float tuning, float velocity)
 {
+  SmootherCommon<float>::Scope smootherScope(smootherState);
+
   using ID = ParameterID::ID;
-  auto &pv = param.value;
+  auto &pv = param.store;
 
-  const size_t nUnison = 1 + pv[ID::nUnison]->getInt();
+  const size_t nUnison = 1 + pv.getInt(ID::nUnison);
 
   noteIndices.resize(0);
 
@@ -474,7 +497,7 @@ void DSPCore::noteOn(
     });
 
     for (auto &index : voiceIndices) {
-      if (pv[ID::resetAtNoteOn]->getInt()) fillTransitionBuffer(index);
+      if (pv.getInt(ID::resetAtNoteOn)) fillTransitionBuffer(index);
       noteIndices.push_back(index);
       if (noteIndices.size() >= nUnison) break;
     }
@@ -490,7 +513,7 @@ void DSPCore::noteOn(
   }
 
   unisonPan.resize(nUnison);
-  const auto unisonPanRange = param.value[ID::unisonPan]->getFloat();
+  const auto unisonPanRange = param.store.getFloat(ID::unisonPan);
   const float panRange = unisonPanRange / float(nUnison - 1);
   const float panOffset = float(0.5) - float(0.5) * unisonPanRange;
   if (++panCounter > unisonPan.size()) panCounter = 0;
@@ -500,14 +523,14 @@ void DSPCore::noteOn(
   }
 
   std::array<float, 4> intervals{
-    pv[ID::unisonIntervalSemitone0 + 0]->getFloat(),
-    pv[ID::unisonIntervalSemitone0 + 1]->getFloat(),
-    pv[ID::unisonIntervalSemitone0 + 2]->getFloat(),
-    pv[ID::unisonIntervalSemitone0 + 3]->getFloat(),
+    pv.getFloat(ID::unisonIntervalSemitone0 + 0),
+    pv.getFloat(ID::unisonIntervalSemitone0 + 1),
+    pv.getFloat(ID::unisonIntervalSemitone0 + 2),
+    pv.getFloat(ID::unisonIntervalSemitone0 + 3),
   };
-  const size_t cycleAt = pv[ID::unisonIntervalCycleAt]->getInt() + 1;
-  const auto eqTemp = pv[ID::unisonEqualTemperament]->getFloat() + float(1);
-  const auto pitchMul = param.value[ID::unisonPitchMul]->getFloat();
+  const size_t cycleAt = pv.getInt(ID::unisonIntervalCycleAt) + 1;
+  const auto eqTemp = pv.getFloat(ID::unisonEqualTemperament) + float(1);
+  const auto pitchMul = param.store.getFloat(ID::unisonPitchMul);
   float sumInterval = 0;
   for (size_t unison = 0; unison < nUnison; ++unison) {
     if (noteIndices.size() <= unison) break;
@@ -522,6 +545,8 @@ void DSPCore::noteOn(
 
 void DSPCore::noteOff(int_fast32_t noteId)
 {
+  SmootherCommon<float>::Scope smootherScope(smootherState);
+
   for (auto &note : notes)
     if (note.id == noteId) note.release(upRate);
 }
@@ -3,8 +3,10 @@
 
 #pragma once
 
+#include "../../../common/dsp/backgroundbuilder.hpp"
 #include "../../../common/dsp/constants.hpp"
 #include "../../../common/dsp/multirate.hpp"
+#include "../../../common/dsp/notequeue.hpp"
 #include "../../../common/dsp/smoother.hpp"
 #include "../../../lib/pcg-cpp/pcg_random.hpp"
 #include "../parameter.hpp"
@@ -35,64 +37,85 @@ inline float noteToPitch(float note, float equalTemperament = 12.0f)
 enum class NoteState { active, release, rest };
 
 #define NOTE_PROCESS_INFO_SMOOTHER(METHOD)                                                          \
-  lfo.interpType = pv[ID::lfoInterpolation]->getInt();                                              \
-  for (size_t idx = 0; idx < nLfoWavetable; ++idx) {                                                \
-    lfo.source[idx + 1] = pv[ID::lfoWavetable0 + idx]->getFloat();                                  \
+  lfo.interpType = pv.getInt(ID::lfoInterpolation);                                                 \
+  if (pv.isDirty(ID::lfoWavetable0, ID::lfoInterpolation)) {                                        \
+    for (size_t idx = 0; idx < nLfoWavetable; ++idx) {                                              \
+      lfo.source[idx + 1] = pv.getFloat(ID::lfoWavetable0 + idx);                                   \
+    }                                                                                               \
   }                                                                                                 \
                                                                                                     \
-  envelope.interpType = pv[ID::modEnvelopeInterpolation]->getInt();                                 \
-  for (size_t idx = 0; idx < nModEnvelopeWavetable; ++idx) {                                        \
-    envelope.source[idx + 1] = pv[ID::modEnvelopeWavetable0 + idx]->getFloat();                     \
+  envelope.interpType = pv.getInt(ID::modEnvelopeInterpolation);                                    \
+  if (pv.isDirty(ID::modEnvelopeWavetable0, ID::modEnvelopeInterpolation)) {                        \
+    for (size_t idx = 0; idx < nModEnvelopeWavetable; ++idx) {                                      \
+      envelope.source[idx + 1] = pv.getFloat(ID::modEnvelopeWavetable0 + idx);                      \
+    }                                                                                               \
   }                                                                                                 \
   envelope.source[nModEnvelopeWavetable] = 0;                                                       \
                                                                                                     \
-  fdnEnable = pv[ID::fdnEnable]->getInt();                                                          \
+  fdnEnable = pv.getInt(ID::fdnEnable);                                                             \
                                                                                                     \
-  oscNoteOffsetRate = SmootherCommon<float>::timeInSamples >= 1                                     \
-    ? minOscNoteOffsetRate / SmootherCommon<float>::timeInSamples                                   \
+  oscNoteOffsetRate = SmootherCommon<float>::state().timeInSamples >= 1                             \
+    ? minOscNoteOffsetRate / SmootherCommon<float>::state().timeInSamples                           \
     : minOscNoteOffsetRate;                                                                         \
                                                                                                     \
-  eqTemp = pv[ID::equalTemperament]->getFloat() + float(1);                                         \
-  auto semitone = int_fast32_t(pv[ID::semitone]->getInt()) - 120;                                   \
-  auto octave = int_fast32_t(pv[ID::octave]->getInt()) - 12;                                        \
-  auto milli = float(0.001) * (int_fast32_t(pv[ID::milli]->getInt()) - 1000);                       \
-  auto a4Hz = pv[ID::pitchA4Hz]->getFloat() + float(100);                                           \
-  auto pitchBend = pv[ID::pitchBendRange]->getFloat() * pv[ID::pitchBend]->getFloat();              \
-  auto oscOctave = int_fast32_t(pv[ID::oscOctave]->getInt()) - 12;                                  \
-  auto oscFinePitch = pv[ID::oscFinePitch]->getFloat();                                             \
-  auto centerPitch = std::log2(a4Hz / float(440));                                                  \
-  oscNoteOffset.METHOD(                                                                             \
-    float(12)                                                                                       \
-    * (centerPitch + oscOctave + octave + (oscFinePitch + semitone + milli + pitchBend) / eqTemp)); \
-  fdnFreqOffset.METHOD(a4Hz *calcNotePitch(                                                         \
-    eqTemp *octave + semitone + milli + pitchBend + float(69), eqTemp));                            \
+  eqTemp = pv.getFloat(ID::equalTemperament) + float(1);                                            \
+  const bool isPitchDirty = pv.isDirty(ID::octave, ID::pitchBendRange + 1)                          \
+    || pv.isDirty(ID::oscOctave, ID::oscFinePitch + 1);                                             \
+  if (isPitchDirty) {                                                                               \
+    auto semitone = int_fast32_t(pv.getInt(ID::semitone)) - 120;                                    \
+    auto octave = int_fast32_t(pv.getInt(ID::octave)) - 12;                                         \
+    auto milli = float(0.001) * (int_fast32_t(pv.getInt(ID::milli)) - 1000);                        \
+    auto a4Hz = pv.getFloat(ID::pitchA4Hz) + float(100);                                            \
+    auto pitchBend = pv.getFloat(ID::pitchBendRange) * pv.getFloat(ID::pitchBend);                  \
+    auto oscOctave = int_fast32_t(pv.getInt(ID::oscOctave)) - 12;                                   \
+    auto oscFinePitch = pv.getFloat(ID::oscFinePitch);                                              \
+    auto centerPitch = std::log2(a4Hz / float(440));                                                \
+    oscNoteOffset.METHOD(                                                                           \
+      float(12)                                                                                     \
+      * (centerPitch + oscOctave + octave                                                           \
+         + (oscFinePitch + semitone + milli + pitchBend) / eqTemp));                                \
+    fdnFreqOffset.METHOD(a4Hz *calcNotePitch(                                                       \
+      eqTemp *octave + semitone + milli + pitchBend + float(69), eqTemp));                          \
+  }                                                                                                 \
                                                                                                     \
-  fdnOvertoneOffset.METHOD(pv[ID::fdnOvertoneOffset]->getFloat());                                  \
-  fdnOvertoneMul.METHOD(pv[ID::fdnOvertoneMul]->getFloat());                                        \
-  fdnOvertoneAdd.METHOD(pv[ID::fdnOvertoneAdd]->getFloat());                                        \
-  fdnOvertoneModulo.METHOD(pv[ID::fdnOvertoneModulo]->getFloat());                                  \
-  fdnLowpassQ.METHOD(pv[ID::lowpassQ]->getFloat());                                                 \
-  fdnHighpassQ.METHOD(pv[ID::highpassQ]->getFloat());                                               \
-  fdnFeedback.METHOD(pv[ID::fdnFeedback]->getFloat());                                              \
+  if (pv.isDirty(ID::fdnOvertoneOffset))                                                            \
+    fdnOvertoneOffset.METHOD(pv.getFloat(ID::fdnOvertoneOffset));                                   \
+  if (pv.isDirty(ID::fdnOvertoneMul)) fdnOvertoneMul.METHOD(pv.getFloat(ID::fdnOvertoneMul));       \
+  if (pv.isDirty(ID::fdnOvertoneAdd)) fdnOvertoneAdd.METHOD(pv.getFloat(ID::fdnOvertoneAdd));       \
+  if (pv.isDirty(ID::fdnOvertoneModulo))                                                            \
+    fdnOvertoneModulo.METHOD(pv.getFloat(ID::fdnOvertoneModulo));                                   \
+  if (pv.isDirty(ID::lowpassQ)) fdnLowpassQ.METHOD(pv.getFloat(ID::lowpassQ));                      \
+  if (pv.isDirty(ID::highpassQ)) fdnHighpassQ.METHOD(pv.getFloat(ID::highpassQ));                   \
+  if (pv.isDirty(ID::fdnFeedback)) fdnFeedback.METHOD(pv.getFloat(ID::fdnFeedback));                \
                                                                                                     \
-  lfoToOscPitchAmount.METHOD(pv[ID::lfoToOscPitchAmount]->getFloat());                              \
-  lfoToFdnPitchAmount.METHOD(pv[ID::lfoToFdnPitchAmount]->getFloat());                              \
-  lfoToOscPitchAlignment = pv[ID::lfoToOscPitchAlignment]->getFloat();                              \
-  lfoToFdnPitchAlignment = pv[ID::lfoToFdnPitchAlignment]->getFloat();                              \
+  if (pv.isDirty(ID::lfoToOscPitchAmount))                                                          \
+    lfoToOscPitchAmount.METHOD(pv.getFloat(ID::lfoToOscPitchAmount));                               \
+  if (pv.isDirty(ID::lfoToFdnPitchAmount))                                                          \
+    lfoToFdnPitchAmount.METHOD(pv.getFloat(ID::lfoToFdnPitchAmount));                               \
+  lfoToOscPitchAlignment = pv.getFloat(ID::lfoToOscPitchAlignment);                                 \
+  lfoToFdnPitchAlignment = pv.getFloat(ID::lfoToFdnPitchAlignment);                                 \
                                                                                                     \
-  modEnvelopeToFdnLowpassCutoff.METHOD(                                                             \
-    pv[ID::modEnvelopeToFdnLowpassCutoff]->getFloat());                                             \
-  modEnvelopeToFdnHighpassCutoff.METHOD(                                                            \
-    pv[ID::modEnvelopeToFdnHighpassCutoff]->getFloat());                                            \
-  modEnvelopeToOscPitch.METHOD(pv[ID::modEnvelopeToOscPitch]->getFloat());                          \
-  modEnvelopeToFdnPitch.METHOD(pv[ID::modEnvelopeToFdnPitch]->getFloat());                          \
-  modEnvelopeToFdnOvertoneAdd.METHOD(pv[ID::modEnvelopeToFdnOvertoneAdd]->getFloat());
+  if (pv.isDirty(ID::modEnvelopeToFdnLowpassCutoff))                                                \
+    modEnvelopeToFdnLowpassCutoff.METHOD(pv.getFloat(ID::modEnvelopeToFdnLowpassCutoff));           \
+  if (pv.isDirty(ID::modEnvelopeToFdnHighpassCutoff))                                               \
+    modEnvelopeToFdnHighpassCutoff.METHOD(pv.getFloat(ID::modEnvelopeToFdnHighpassCutoff));         \
+  if (pv.isDirty(ID::modEnvelopeToOscPitch))                                                        \
+    modEnvelopeToOscPitch.METHOD(pv.getFloat(ID::modEnvelopeToOscPitch));                           \
+  if (pv.isDirty(ID::modEnvelopeToFdnPitch))                                                        \
+    modEnvelopeToFdnPitch.METHOD(pv.getFloat(ID::modEnvelopeToFdnPitch));                           \
+  if (pv.isDirty(ID::modEnvelopeToFdnOvertoneAdd))                                                  \
+    modEnvelopeToFdnOvertoneAdd.METHOD(pv.getFloat(ID::modEnvelopeToFdnOvertoneAdd));
 
 struct NoteProcessInfo {
   pcg64 fdnRng;
   uint32_t previousSeed = 0;
   std::vector<std::vector<float>> fdnMatrixRandomBase;
-  Wavetable<float, oscOvertoneSize> wavetable;
+  // Refreshed on worker thread. `wavetableFade` goes from 0 to 1 after a swap.
+  BackgroundBuilder<
+    WavetableParameter<float, oscOvertoneSize>, Wavetable<float, oscOvertoneSize>>
+    wavetable;
+  float wavetableFade = float(1);
+  float wavetableFadeStep = float(1);
 
   TableLFO<float, nLfoWavetable, 1024, TableLFOType::lfo> lfo;
   TableLFO<float, nModEnvelopeWavetable + 1, 1024, TableLFOType::envelope> envelope;
@@ -106,6 +129,11 @@ struct NoteProcessInfo {
   float lfoToOscPitchAlignment = float(1);
   float lfoToFdnPitchAlignment = float(1);
 
+  // Shared by all notes. Only recomputed when the parameter is changed.
+  float gateReleaseKp = float(1);
+  float gateAttackKp = float(1);
+  float fdnInterpKp = float(1);
+
   RateLimiter<float> oscNoteOffset; // In 12ET semitones.
   ExpSmoother<float> fdnFreqOffset;
   ExpSmoother<float> fdnOvertoneOffset;
@@ -134,9 +162,9 @@ struct NoteProcessInfo {
   void reset(GlobalParameter &param)
   {
     using ID = ParameterID::ID;
-    auto &pv = param.value;
+    auto &pv = param.store;
 
-    previousSeed = pv[ID::fdnSeed]->getInt();
+    previousSeed = pv.getInt(ID::fdnSeed);
     fdnRng.seed(previousSeed);
 
     std::normal_distribution<float> dist{}; // mean 0, stddev 1.
@@ -151,12 +179,27 @@ struct NoteProcessInfo {
     NOTE_PROCESS_INFO_SMOOTHER(reset);
   }
 
-  void setParameters(GlobalParameter &param)
+  void setParameters(float sampleRate, GlobalParameter &param)
   {
     using ID = ParameterID::ID;
-    auto &pv = param.value;
+    auto &pv = param.store;
+
+    if (pv.isDirty(ID::gateReleaseSecond)) {
+      gateReleaseKp
+        = NoteGate<float>::secondToKp(sampleRate, pv.getFloat(ID::gateReleaseSecond));
+    }
+    if (pv.isDirty(ID::gateAttackSecond)) {
+      gateAttackKp
+        = NoteGate<float>::secondToKp(sampleRate, pv.getFloat(ID::gateAttackSecond));
+    }
+    if (pv.isDirty(ID::fdnInterpLowpassSecond)) {
+      auto seconds = pv.getFloat(ID::fdnInterpLowpassSecond);
+      fdnInterpKp = seconds == 0
+        ? float(1)
+        : float(EMAFilter<double>::cutoffToP(sampleRate, double(1) / seconds));
+    }
 
-    auto seed = pv[ID::fdnSeed]->getInt();
+    auto seed = pv.getInt(ID::fdnSeed);
     if (previousSeed != seed) {
       previousSeed = seed;
 
@@ -174,6 +217,14 @@ struct NoteProcessInfo {
     lfo.processRefresh();
     envelope.processRefresh();
 
+    if (wavetableFade < float(1)) {
+      wavetableFade += wavetableFadeStep;
+      if (wavetableFade >= float(1)) {
+        wavetableFade = float(1);
+        wavetable.releasePrevious();
+      }
+    }
+
     lfoPhase = synchronizer.process();
 
     oscNoteOffset.process(oscNoteOffsetRate);
@@ -251,12 +302,13 @@ public:
   };
 
   GlobalParameter param;
+  SmootherState<float> smootherState;
 
   bool isPlaying = false;
   float tempo = 120.0f;
   double beatsElapsed = 0.0f;
 
-  std::vector<MidiNote> midiNotes;
+  NoteQueue<MidiNote> midiNotes;
 
   DSPCore();
 
@@ -284,29 +336,24 @@ public:
     note.pitch = pitch;
     note.tuning = tuning;
     note.velocity = velocity;
-    midiNotes.push_back(note);
+    if (!midiNotes.push(note) && !note.isNoteOn) noteOff(note.id);
   }
 
   void processMidiNote(size_t frame)
   {
-    while (true) {
-      auto it = std::find_if(midiNotes.begin(), midiNotes.end(), [&](const MidiNote &nt) {
-        return nt.frame == frame;
-      });
-      if (it == std::end(midiNotes)) return;
-      if (it->isNoteOn)
-        noteOn(it->id, it->pitch, it->tuning, it->velocity);
+    midiNotes.pop(frame, [&](MidiNote &nt) {
+      if (nt.isNoteOn)
+        noteOn(nt.id, nt.pitch, nt.tuning, nt.velocity);
       else
-        noteOff(it->id);
-      midiNotes.erase(it);
-    }
+        noteOff(nt.id);
+    });
   }
 
 private:
   float getTempoSyncInterval();
+  WavetableParameter<float, oscOvertoneSize> getWavetableParameter();
 
   static constexpr size_t upFold = 2;
-  bool prepareRefresh = true;
   bool isWavetableRefeshed = false;
   float sampleRate = 44100.0f;
   float upRate = 88200.0f;
@@ -110,14 +110,23 @@ public:
     filter.reset(Sample(1));
   }
 
+  // Same as `DoubleEMAFilter::setCutoff(sampleRate, 1 / seconds)`.
+  static Sample secondToKp(Sample sampleRate, Sample seconds)
+  {
+    if (seconds < std::numeric_limits<Sample>::epsilon()) return Sample(1);
+    const auto cutoffHz = Sample(1) / seconds;
+    return cutoffHz >= sampleRate / Sample(2)
+      ? Sample(1)
+      : Sample(EMAFilter<double>::cutoffToP(sampleRate, cutoffHz));
+  }
+
   void prepare(Sample sampleRate, Sample seconds)
   {
-    if (seconds < std::numeric_limits<Sample>::epsilon())
-      filter.kp = Sample(1);
-    else
-      filter.setCutoff(sampleRate, Sample(1) / seconds);
+    filter.kp = secondToKp(sampleRate, seconds);
   }
 
+  void setKp(Sample kp) { filter.kp = kp; }
+
   void release() { signal = Sample(0); }
 
   Sample process() { return filter.process(signal); }
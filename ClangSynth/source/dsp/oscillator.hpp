@@ -3,72 +3,25 @@
 
 #pragma once
 
-#define POCKETFFT_NO_MULTITHREADING
-#include "../../../lib/pocketfft/pocketfft_hdronly.h"
-
 #include "../../../common/dsp/constants.hpp"
+#include "../../../common/dsp/fft.hpp"
 
 #include <algorithm>
+#include <array>
 #include <cmath>
 #include <complex>
+#include <functional>
+#include <limits>
+#include <numeric>
 #include <vector>
 
 namespace SomeDSP {
 
-template<typename T> class PocketFFT {
-public:
-  pocketfft::shape_t shape;
-  pocketfft::stride_t strideR;
-  pocketfft::stride_t strideC;
-  pocketfft::shape_t axes;
-  size_t ndata = 1;
-
-  void setShape(pocketfft::shape_t _shape)
-  {
-    shape = _shape;
-
-    strideR.resize(shape.size());
-    strideC.resize(shape.size());
-
-    size_t tmpR = sizeof(T);
-    size_t tmpC = sizeof(std::complex<T>);
-    for (int i = int(shape.size()) - 1; i >= 0; --i) {
-      strideR[i] = tmpR;
-      tmpR *= shape[i];
-      strideC[i] = tmpC;
-      tmpC *= shape[i];
-    }
-
-    ndata = 1;
-    for (const auto &shp : shape) ndata *= shp;
-
-    axes.resize(shape.size());
-    for (size_t i = 0; i < axes.size(); ++i) axes[i] = i;
-  }
-
-  void setShape1D(size_t size)
-  {
-    pocketfft::shape_t _shape{size};
-    setShape(_shape);
-  }
-
-  void r2c(const T *data_in, std::complex<T> *data_out, bool forward = true, T scale = 1)
-  {
-    pocketfft::r2c(shape, strideR, strideC, axes, forward, data_in, data_out, scale);
-  }
-
-  void c2r(const std::complex<T> *data_in, T *data_out, bool forward = false, T scale = 1)
-  {
-    pocketfft::c2r(
-      shape, strideC, strideR, axes, forward, data_in, data_out, scale / ndata);
-  }
-};
-
+// Copied from audio thread to the worker of `BackgroundBuilder`. Don't add heap memory.
 template<typename Sample, size_t nOvertone> struct WavetableParameter {
   std::array<std::complex<Sample>, nOvertone> overtoneAmp{};
-  std::vector<std::complex<Sample>> source;
-  std::vector<Sample> power;
 
+  Sample upRate = Sample(88200);
   Sample denominatorSlope = Sample(1);
   Sample rotationSlope = 0;
   Sample rotationOffset = 0;
@@ -76,11 +29,7 @@ template<typename Sample, size_t nOvertone> struct WavetableParameter {
   size_t interval = 1;
   size_t highpassIndex = 0;
 
-  WavetableParameter()
-  {
-    overtoneAmp[0].real(Sample(1));
-    source.reserve(65536);
-  }
+  WavetableParameter() { overtoneAmp[0].real(Sample(1)); }
 };
 
 template<typename Sample, size_t nOvertone> class Wavetable {
@@ -99,8 +48,10 @@ private:
     {Sample(0), Sample(0), Sample(0)},
   };
 
+  std::vector<std::complex<Sample>> source;
+  std::vector<Sample> power;
   std::vector<std::complex<Sample>> fullSpectrum;
-  PocketFFT<Sample> fft;
+  RealInverseFft ifft;
 
   void generateSpectrum(size_t spectrumSize)
   {
@@ -110,29 +61,29 @@ private:
     constexpr auto eps = std::numeric_limits<Sample>::epsilon();
 
     // Generate source spectrum amplitude.
-    param.power.resize(spectrumSize);
-    std::fill(param.power.begin(), param.power.end(), Sample(0));
-    for (size_t k = 1; k < param.power.size(); ++k) {
-      param.power[k] = Sample(1) / (Sample(1) + Sample(k - 1) * param.denominatorSlope);
+    power.resize(spectrumSize);
+    std::fill(power.begin(), power.end(), Sample(0));
+    for (size_t k = 1; k < power.size(); ++k) {
+      power[k] = Sample(1) / (Sample(1) + Sample(k - 1) * param.denominatorSlope);
     }
 
     // Blur with bidirectional filtering. `param.blur` is EMA filter coefficient.
-    if (param.blur < Sample(1) && param.power.size() >= 2) {
-      auto value = param.power[1];
-      for (size_t k = 1; k < param.power.size(); ++k) {
-        value += param.blur * (param.power[k] - value);
-        param.power[k] = value;
+    if (param.blur < Sample(1) && power.size() >= 2) {
+      auto value = power[1];
+      for (size_t k = 1; k < power.size(); ++k) {
+        value += param.blur * (power[k] - value);
+        power[k] = value;
       }
-      for (size_t k = param.power.size() - 1; k > 0; --k) {
-        value += param.blur * (param.power[k] - value);
-        param.power[k] = value;
+      for (size_t k = power.size() - 1; k > 0; --k) {
+        value += param.blur * (power[k] - value);
+        power[k] = value;
       }
     }
 
     // Highpass.
     for (size_t k = 1; k <= param.highpassIndex; ++k) {
-      if (k >= param.power.size()) break;
-      param.power[k] *= Sample(k) / Sample(param.highpassIndex);
+      if (k >= power.size()) break;
+      power[k] *= Sample(k) / Sample(param.highpassIndex);
     }
 
     // Normalize.
@@ -143,23 +94,23 @@ private:
     auto normalizeAmp = Sample(bufSize) / sumAmp;
 
     // Fill complex spectrum.
-    param.source.resize(param.power.size());
-    std::fill(param.source.begin(), param.source.end(), std::complex<Sample>(0, 0));
-    for (size_t k = 1; k < param.source.size(); k += param.interval) {
-      param.source[k] = std::polar(
-        param.power[k] * normalizeAmp,
+    source.resize(power.size());
+    std::fill(source.begin(), source.end(), std::complex<Sample>(0, 0));
+    for (size_t k = 1; k < source.size(); k += param.interval) {
+      source[k] = std::polar(
+        power[k] * normalizeAmp,
         Sample(twopi) * (param.rotationOffset + Sample(k - 1) * param.rotationSlope));
     }
 
     // Overtones.
-    fullSpectrum.resize(param.source.size());
+    fullSpectrum.resize(source.size());
     std::fill(fullSpectrum.begin(), fullSpectrum.end(), std::complex<Sample>(0, 0));
     for (size_t i = 0; i < nOvertone; ++i) {
-      for (size_t k = 1; k < param.source.size(); ++k) {
+      for (size_t k = 1; k < source.size(); ++k) {
         auto index = (i + 1) * k;
         if (index >= fullSpectrum.size()) break;
 
-        fullSpectrum[index] += param.overtoneAmp[i] * param.source[k];
+        fullSpectrum[index] += param.overtoneAmp[i] * source[k];
       }
     }
   }
@@ -167,6 +118,15 @@ private:
 public:
   WavetableParameter<Sample, nOvertone> param;
 
+  Wavetable() { source.reserve(65536); }
+
+  // Called by `BackgroundBuilder` on worker thread.
+  void build(const WavetableParameter<Sample, nOvertone> &parameter)
+  {
+    param = parameter;
+    fillTable(param.upRate);
+  }
+
   void fillTable(Sample upRate)
   {
     size_t exponent = std::clamp<size_t>(
@@ -176,8 +136,6 @@ public:
 
     generateSpectrum(nFreq + 1);
 
-    fft.setShape1D(bufSize);
-
     size_t nTable = size_t(std::log(Sample(nFreq)) / std::log(bendRange));
     maxIdx = Sample(nTable - 1);
 
@@ -186,13 +144,17 @@ public:
 
     table.resize(nTable + 1); // Last table is filled by 0.
     std::vector<std::complex<Sample>> destSpc(fullSpectrum.size());
+    const auto scale = Sample(1) / Sample(bufSize);
     for (size_t idx = table.size() - 2; idx < table.size(); --idx) {
       size_t cutoff = size_t(nFreq * std::pow(bendRange, -Sample(idx))) + 1;
       std::fill(destSpc.begin(), destSpc.end(), std::complex<Sample>(0, 0));
       std::copy(fullSpectrum.begin(), fullSpectrum.begin() + cutoff, destSpc.begin());
 
+      // Plan depends on alignment of `table[idx]`, which may change on `resize`.
       table[idx].resize(bufSize + 1);
-      fft.c2r(destSpc.data(), table[idx].data());
+      ifft.init(bufSize, destSpc.data(), table[idx].data());
+      ifft.execute(destSpc.data(), table[idx].data());
+      for (auto &value : table[idx]) value *= scale;
       table[idx].back() = table[idx][0];
     }
     table.back().resize(bufSize + 1);
@@ -232,6 +194,20 @@ template<typename Sample, size_t nOvertone> struct TableOsc {
     phase -= std::floor(phase);
     return wt.process(note, phase);
   }
+
+  // Crossfades from `previous` to `wt` after a table swap. `fade` is in [0, 1].
+  Sample process(
+    Sample upRate,
+    Sample note,
+    const Wavetable<Sample, nOvertone> &wt,
+    const Wavetable<Sample, nOvertone> *previous,
+    Sample fade)
+  {
+    auto sig = process(upRate, note, wt);
+    if (previous == nullptr) return sig;
+    auto prev = previous->process(note, phase);
+    return prev + fade * (sig - prev);
+  }
 };
 
 } // namespace SomeDSP
@@ -182,6 +182,7 @@ struct Scales {
 
 struct GlobalParameter : public ParameterInterface {
   std::vector<std::unique_ptr<ValueInterface>> value;
+  ParameterStore store;
 
   GlobalParameter()
   {
@@ -405,6 +406,7 @@ struct GlobalParameter : public ParameterInterface {
       0.0, Scales::fdnOvertoneAdd, "modEnvelopeToFdnOvertoneAdd", Info::kCanAutomate);
 
     for (size_t id = 0; id < value.size(); ++id) value[id]->setId(Vst::ParamID(id));
+    store.attach(value);
   }
 
 #ifdef TEST_DSP
@@ -10,6 +10,8 @@
 
 #include "public.sdk/source/vst/vstaudioeffect.h"
 
+#include "../../common/automationdispatcher.hpp"
+#include "../../common/silencedetector.hpp"
 #include "dsp/dspcore.hpp"
 
 namespace Steinberg {
@@ -39,9 +41,11 @@ public:
     return (Vst::IAudioProcessor *)new PlugProcessor();
   }
 
-  void handleEvent(Vst::ProcessData &data);
+  void handleEvent(const Vst::Event &event);
 
 protected:
+  AutomationDispatcher automation;
+  SilenceDetector silence;
   DSPCore dsp;
 };
 
@@ -167,6 +167,8 @@ std::array<float, 2> Note::process(float sampleRate, NoteProcessInfo &info)
 
 void DSPCore::setup(double sampleRate)
 {
+  SmootherCommon<float>::Scope smootherScope(smootherState);
+
   this->sampleRate = float(sampleRate);
 
   SmootherCommon<float>::setSampleRate(this->sampleRate);
@@ -189,6 +191,8 @@ DSPCore::DSPCore()
 
 void DSPCore::reset()
 {
+  SmootherCommon<float>::Scope smootherScope(smootherState);
+
   using ID = ParameterID::ID;
   auto &pv = param.value;
 
@@ -216,6 +220,8 @@ void DSPCore::startup() {}
 
 void DSPCore::setParameters(float /* tempo */)
 {
+  SmootherCommon<float>::Scope smootherScope(smootherState);
+
   using ID = ParameterID::ID;
   auto &pv = param.value;
 
@@ -235,6 +241,7 @@ void DSPCore::setParameters(float /* tempo */)
 
 void DSPCore::process(const size_t length, float *out0, float *out1)
 {
+  SmootherCommon<float>::Scope smootherScope(smootherState);
   ScopedNoDenormals scopedDenormals;
 
   SmootherCommon<float>::setBufferSize(float(length));
@@ -284,6 +291,8 @@ void DSPCore::setUnisonPan(size_t nUnison)
 
 void DSPCore::noteOn(int32_t noteId, int16_t pitch, float tuning, float velocity)
 {
+  SmootherCommon<float>::Scope smootherScope(smootherState);
+
   using ID = ParameterID::ID;
   auto &pv = param.value;
 
@@ -347,6 +356,8 @@ void DSPCore::noteOn(int32_t noteId, int16_t pitch, float tuning, float velocity
 
 void DSPCore::noteOff(int32_t noteId)
 {
+  SmootherCommon<float>::Scope smootherScope(smootherState);
+
   for (size_t i = 0; i < notes.size(); ++i)
     if (notes[i].id == noteId) notes[i].release(sampleRate);
 }
@@ -13,6 +13,8 @@ template<typename T> inline T lerp(T a, T b, T t) { return a + t * (b - a); }
 
 void DSPCore::setup(double sampleRate)
 {
+  SmootherCommon<double>::Scope smootherScope(smootherState);
+
   this->sampleRate = double(sampleRate);
 
   pitchSmoothingKp = EMAFilter<double>::secondToP(upRate, double(0.05));
@@ -65,6 +67,8 @@ void DSPCore::updateUpRate()
 
 void DSPCore::reset()
 {
+  SmootherCommon<double>::Scope smootherScope(smootherState);
+
   oversampling = param.value[ParameterID::ID::oversampling]->getInt();
   updateUpRate();
 
@@ -92,6 +96,8 @@ void DSPCore::startup() {}
 
 void DSPCore::setParameters()
 {
+  SmootherCommon<double>::Scope smootherScope(smootherState);
+
   size_t newOversampling = param.value[ParameterID::ID::oversampling]->getInt();
   if (oversampling != newOversampling) {
     oversampling = newOversampling;
@@ -151,9 +157,11 @@ std::array<double, 2> DSPCore::processFrame(const std::array<double, 2> &frame)
   };
 }
 
+template<typename Sample>
 void DSPCore::process(
-  const size_t length, const float *in0, const float *in1, float *out0, float *out1)
+  const size_t length, const Sample *in0, const Sample *in1, Sample *out0, Sample *out1)
 {
+  SmootherCommon<double>::Scope smootherScope(smootherState);
   ScopedNoDenormals scopedDenormals;
 
   using ID = ParameterID::ID;
@@ -197,8 +205,15 @@ void DSPCore::process(
   }
 }
 
+template void DSPCore::process<float>(
+  const size_t length, const float *in0, const float *in1, float *out0, float *out1);
+template void DSPCore::process<double>(
+  const size_t length, const double *in0, const double *in1, double *out0, double *out1);
+
 void DSPCore::noteOn(NoteInfo &info)
 {
+  SmootherCommon<double>::Scope smootherScope(smootherState);
+
   using ID = ParameterID::ID;
   auto &pv = param.value;
 
@@ -212,6 +227,8 @@ void DSPCore::noteOn(NoteInfo &info)
 
 void DSPCore::noteOff(int_fast32_t noteId)
 {
+  SmootherCommon<double>::Scope smootherScope(smootherState);
+
   using ID = ParameterID::ID;
   auto &pv = param.value;
 
@@ -6,6 +6,7 @@
 #include "../../../common/dsp/constants.hpp"
 #include "../../../common/dsp/lfo.hpp"
 #include "../../../common/dsp/multirate.hpp"
+#include "../../../common/dsp/notequeue.hpp"
 #include "../../../common/dsp/smoother.hpp"
 #include "../parameter.hpp"
 #include "filter.hpp"
@@ -30,6 +31,7 @@ public:
   }
 
   GlobalParameter param;
+  SmootherState<double> smootherState;
   bool isPlaying = false;
   float tempo = 120.0f;
   double beatsElapsed = 0.0f;
@@ -41,8 +43,13 @@ public:
   void startup();
   size_t getLatency();
   void setParameters();
+  template<typename Sample>
   void process(
-    const size_t length, const float *in0, const float *in1, float *out0, float *out1);
+    const size_t length,
+    const Sample *in0,
+    const Sample *in1,
+    Sample *out0,
+    Sample *out1);
   void noteOn(NoteInfo &info);
   void noteOff(int_fast32_t noteId);
 
@@ -60,22 +67,17 @@ public:
     note.id = noteId;
     note.pitch = pitch + tuning;
     note.velocity = velocity;
-    midiNotes.push_back(note);
+    if (!midiNotes.push(note) && !note.isNoteOn) noteOff(note.id);
   }
 
   void processMidiNote(size_t frame)
   {
-    while (true) {
-      auto it = std::find_if(midiNotes.begin(), midiNotes.end(), [&](const NoteInfo &nt) {
-        return nt.frame == frame;
-      });
-      if (it == std::end(midiNotes)) return;
-      if (it->isNoteOn)
-        noteOn(*it);
+    midiNotes.pop(frame, [&](NoteInfo &nt) {
+      if (nt.isNoteOn)
+        noteOn(nt);
       else
-        noteOff(it->id);
-      midiNotes.erase(it);
-    }
+        noteOff(nt.id);
+    });
   }
 
 private:
@@ -85,7 +87,7 @@ private:
 
   static constexpr size_t upFold = 16;
 
-  std::vector<NoteInfo> midiNotes;
+  NoteQueue<NoteInfo> midiNotes;
   std::vector<NoteInfo> noteStack;
 
   double sampleRate = 44100;
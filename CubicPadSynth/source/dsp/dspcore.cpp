@@ -14,9 +14,27 @@
 
 #include <iostream>
 
-#define PROCESSING_UNIT_NAME ProcessingUnit_FixedInstruction
-#define NOTE_NAME Note_FixedInstruction
-#define DSPCORE_NAME DSPCore_FixedInstruction
+#if defined(UHHYOU_INSTRSET_AVX512)
+  #define PROCESSING_UNIT_NAME ProcessingUnit_AVX512
+  #define NOTE_NAME Note_AVX512
+  #define DSPCORE_NAME DSPCore_AVX512
+  #define DSPCORE_FACTORY createDSPCore_AVX512
+#elif defined(UHHYOU_INSTRSET_AVX2)
+  #define PROCESSING_UNIT_NAME ProcessingUnit_AVX2
+  #define NOTE_NAME Note_AVX2
+  #define DSPCORE_NAME DSPCore_AVX2
+  #define DSPCORE_FACTORY createDSPCore_AVX2
+#elif defined(UHHYOU_INSTRSET_AVX)
+  #define PROCESSING_UNIT_NAME ProcessingUnit_AVX
+  #define NOTE_NAME Note_AVX
+  #define DSPCORE_NAME DSPCore_AVX
+  #define DSPCORE_FACTORY createDSPCore_AVX
+#else
+  #define PROCESSING_UNIT_NAME ProcessingUnit_FixedInstruction
+  #define NOTE_NAME Note_FixedInstruction
+  #define DSPCORE_NAME DSPCore_FixedInstruction
+  #define DSPCORE_FACTORY createDSPCore_FixedInstruction
+#endif
 
 inline float clamp(float value, float min, float max)
 {
@@ -130,9 +148,11 @@ DSPCORE_NAME::DSPCORE_NAME()
 
 void DSPCORE_NAME::setup(double sampleRate)
 {
+  SmootherCommon<float>::Scope smootherScope(smootherState);
+
   this->sampleRate = float(sampleRate);
 
-  midiNotes.resize(0);
+  midiNotes.clear();
 
   SmootherCommon<float>::setSampleRate(this->sampleRate);
   SmootherCommon<float>::setTime(0.04f);
@@ -149,6 +169,10 @@ void DSPCORE_NAME::setup(double sampleRate)
 
   startup();
   prepareRefresh = true;
+
+  isTableRefreshRequested.store(false, std::memory_order_release);
+  wavetable.setDiskCacheDirectory(getTableCacheDirectory("CubicPadSynth"));
+  wavetable.reset(getPadSynthParameter());
 }
 
 void PROCESSING_UNIT_NAME::reset(GlobalParameter &param)
@@ -176,6 +200,8 @@ void PROCESSING_UNIT_NAME::reset(GlobalParameter &param)
 
 void DSPCORE_NAME::reset()
 {
+  SmootherCommon<float>::Scope smootherScope(smootherState);
+
   for (auto &note : notes) note.rest();
   for (auto &unit : units) unit.reset(param);
   info.reset(param);
@@ -194,6 +220,8 @@ void DSPCORE_NAME::reset()
 
 void DSPCORE_NAME::startup()
 {
+  SmootherCommon<float>::Scope smootherScope(smootherState);
+
   info.rng.seed(0); // TODO: provide seed.
 
   for (auto &unit : units) {
@@ -226,6 +254,8 @@ void PROCESSING_UNIT_NAME::setParameters(
 
 void DSPCORE_NAME::setParameters(float tempo)
 {
+  SmootherCommon<float>::Scope smootherScope(smootherState);
+
   using ID = ParameterID::ID;
 
   SmootherCommon<float>::setTime(param.value[ID::smoothness]->getFloat());
@@ -264,12 +294,15 @@ void DSPCORE_NAME::setParameters(float tempo)
     refreshTable();
   isTableRefeshed = param.value[ID::refreshTable]->getInt();
 
+  if (isTableRefreshRequested.exchange(false, std::memory_order_acq_rel))
+    wavetable.request(getPadSynthParameter());
+
   prepareRefresh = false;
 }
 
 std::array<float, 2> PROCESSING_UNIT_NAME::process(
   float sampleRate,
-  WaveTable<tableSize, nOvertone> &wavetable,
+  const WaveTableView &wavetable,
   LfoWaveTable<lfoTableSize> &lfoWaveTable,
   NoteProcessInfo &info)
 {
@@ -307,19 +340,15 @@ std::array<float, 2> PROCESSING_UNIT_NAME::process(
 
 void DSPCORE_NAME::process(const size_t length, float *out0, float *out1)
 {
+  SmootherCommon<float>::Scope smootherScope(smootherState);
   ScopedNoDenormals scopedDenormals;
 
-  if (wavetable.isRefreshing) {
-    for (int i = 0; i < length; ++i) {
-      processMidiNote(i);
-      out0[i] = 0;
-      out1[i] = 0;
-    }
-    return;
-  }
-
   SmootherCommon<float>::setBufferSize(float(length));
 
+  wavetable.lock();
+  wavetableView.load(wavetable);
+  param.value[ParameterID::guiTableProgress]->setFromFloat(wavetable.getProgress());
+
   std::array<float, 2> frame{};
   for (uint32_t i = 0; i < length; ++i) {
     processMidiNote(i);
@@ -339,7 +368,7 @@ void DSPCORE_NAME::process(const size_t length, float *out0, float *out1)
 
     for (auto &unit : units) {
       if (!unit.isActive) continue;
-      auto sig = unit.process(sampleRate, wavetable, lfoWavetable, info);
+      auto sig = unit.process(sampleRate, wavetableView, lfoWavetable, info);
       frame[0] += sig[0];
       frame[1] += sig[1];
     }
@@ -356,6 +385,8 @@ void DSPCORE_NAME::process(const size_t length, float *out0, float *out1)
     out0[i] = masterGain * frame[0];
     out1[i] = masterGain * frame[1];
   }
+
+  wavetable.unlock();
 }
 
 enum UnisonPanType {
@@ -394,6 +425,8 @@ void DSPCORE_NAME::terminateNotes(size_t nNote)
 
 void DSPCORE_NAME::noteOn(int32_t identifier, int16_t pitch, float tuning, float velocity)
 {
+  SmootherCommon<float>::Scope smootherScope(smootherState);
+
   using ID = ParameterID::ID;
 
   const size_t nUnison = 1 + param.value[ID::nUnison]->getInt();
@@ -565,7 +598,7 @@ void DSPCORE_NAME::fillTransitionBuffer(size_t noteIndex)
       break;
     }
 
-    float oscOut = trOsc.process(pitch, wavetable.table);
+    float oscOut = trOsc.process(pitch, wavetableView.table);
     auto idx = (trIndex + bufIdx) % transitionBuffer.size();
     auto interp = 1.0f - float(bufIdx) / transitionBuffer.size();
 
@@ -576,41 +609,56 @@ void DSPCORE_NAME::fillTransitionBuffer(size_t noteIndex)
 
 void DSPCORE_NAME::noteOff(int32_t noteId)
 {
+  SmootherCommon<float>::Scope smootherScope(smootherState);
+
   for (size_t i = 0; i < notes.size(); ++i)
     if (notes[i].id == noteId) notes[i].release(units);
 }
 
 void DSPCORE_NAME::refreshTable()
+{
+  isTableRefreshRequested.store(true, std::memory_order_release);
+}
+
+bool DSPCORE_NAME::isRenderingTable() const
+{
+  return isTableRefreshRequested.load(std::memory_order_acquire)
+    || wavetable.isRendering();
+}
+
+PadSynthParameter<nOvertone> DSPCORE_NAME::getPadSynthParameter()
 {
   using ID = ParameterID::ID;
 
-  reset();
+  PadSynthParameter<nOvertone> rq;
+  rq.sampleRate = sampleRate;
+  rq.tableBaseFreq = param.value[ID::tableBaseFrequency]->getFloat();
 
-  const float tableBaseFreq = param.value[ID::tableBaseFrequency]->getFloat();
   const float pitchMultiplier = param.value[ID::overtonePitchMultiply]->getFloat();
   const float pitchModulo = param.value[ID::overtonePitchModulo]->getFloat();
   const float gainPow = param.value[ID::overtoneGainPower]->getFloat();
   const float widthMul = param.value[ID::overtoneWidthMultiply]->getFloat();
 
   for (size_t idx = 0; idx < nOvertone; ++idx) {
-    otFrequency[idx] = (pitchMultiplier * idx + 1.0f) * tableBaseFreq
+    rq.frequency[idx] = (pitchMultiplier * idx + 1.0f) * rq.tableBaseFreq
       * param.value[ID::overtonePitch0 + idx]->getFloat();
     if (pitchModulo != 0)
-      otFrequency[idx]
-        = fmodf(otFrequency[idx], notePitchToFrequency(pitchModulo, 12.0f, 440.0f));
-    otGain[idx] = powf(param.value[ID::overtoneGain0 + idx]->getFloat(), gainPow);
-    otBandWidth[idx] = widthMul * param.value[ID::overtoneWidth0 + idx]->getFloat();
-    otPhase[idx] = param.value[ID::overtonePhase0 + idx]->getFloat();
+      rq.frequency[idx]
+        = fmodf(rq.frequency[idx], notePitchToFrequency(pitchModulo, 12.0f, 440.0f));
+    rq.gain[idx] = powf(param.value[ID::overtoneGain0 + idx]->getFloat(), gainPow);
+    rq.bandWidth[idx] = widthMul * param.value[ID::overtoneWidth0 + idx]->getFloat();
+    rq.phase[idx] = param.value[ID::overtonePhase0 + idx]->getFloat();
   }
 
-  wavetable.padsynth(
-    sampleRate, tableBaseFreq, otFrequency, otGain, otPhase, otBandWidth,
-    param.value[ID::padSynthSeed]->getInt(), param.value[ID::spectrumExpand]->getFloat(),
-    int32_t(param.value[ID::spectrumShift]->getInt()) - spectrumSize,
-    param.value[ID::profileComb]->getInt() + 1, param.value[ID::profileShape]->getFloat(),
-    param.value[ID::overtonePitchRandom]->getInt(),
-    param.value[ID::spectrumInvert]->getInt(),
-    param.value[ID::uniformPhaseProfile]->getInt());
+  rq.seed = param.value[ID::padSynthSeed]->getInt();
+  rq.expand = param.value[ID::spectrumExpand]->getFloat();
+  rq.shift = int32_t(param.value[ID::spectrumShift]->getInt()) - spectrumSize;
+  rq.profileSkip = param.value[ID::profileComb]->getInt() + 1;
+  rq.profileShape = param.value[ID::profileShape]->getFloat();
+  rq.randomPitch = param.value[ID::overtonePitchRandom]->getInt();
+  rq.invertSpectrum = param.value[ID::spectrumInvert]->getInt();
+  rq.uniformPhaseProfile = param.value[ID::uniformPhaseProfile]->getInt();
+  return rq;
 }
 
 void DSPCORE_NAME::refreshLfo()
@@ -625,3 +673,8 @@ void DSPCORE_NAME::refreshLfo()
 
   lfoWavetable.refreshTable(table, param.value[ID::lfoWavetableType]->getInt());
 }
+
+std::unique_ptr<DSPInterface> DSPCORE_FACTORY()
+{
+  return std::make_unique<DSPCORE_NAME>();
+}
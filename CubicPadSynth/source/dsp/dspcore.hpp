@@ -4,7 +4,9 @@
 #pragma once
 
 #include "../../../common/dsp/constants.hpp"
+#include "../../../common/dsp/notequeue.hpp"
 #include "../../../common/dsp/smoother.hpp"
+#include "../../../common/dsp/tablerenderer.hpp"
 #include "../../../lib/vcl.hpp"
 #include "../../../lib/vcl/vectormath_exp.h"
 #include "../parameter.hpp"
@@ -13,7 +15,9 @@
 #include "oscillator.hpp"
 
 #include <array>
+#include <atomic>
 #include <cmath>
+#include <memory>
 #include <random>
 
 using namespace SomeDSP;
@@ -47,6 +51,12 @@ inline float getMasterPitch(GlobalParameter &param)
 
 constexpr size_t nUnit = 8;
 
+using WaveTable = TableRenderer<PadSynthRenderer<tableSize, nOvertone>, nTablePadded>;
+
+// Including the request thread. Helpers are taken from `WorkerPool`, and each of them
+// allocates about 3 MiB of FFT buffers only while rendering.
+constexpr size_t maxTableWorker = 32;
+
 enum class NoteState { active, release, rest };
 
 struct NoteProcessInfo {
@@ -109,7 +119,7 @@ struct NoteProcessInfo {
     void setParameters(float sampleRate, NoteProcessInfo &info, GlobalParameter &param); \
     std::array<float, 2> process(                                                        \
       float sampleRate,                                                                  \
-      WaveTable<tableSize, nOvertone> &wavetable,                                        \
+      const WaveTableView &wavetable,                                                    \
       LfoWaveTable<lfoTableSize> &lfoWaveTable,                                          \
       NoteProcessInfo &info);                                                            \
     void reset(GlobalParameter &param);                                                  \
@@ -149,6 +159,7 @@ public:
 
   static const size_t maxVoice = 128;
   GlobalParameter param;
+  SmootherState<float> smootherState;
 
   virtual void setup(double sampleRate) = 0;
   virtual void reset() = 0;   // Stop sounds.
@@ -157,8 +168,9 @@ public:
   virtual void process(const size_t length, float *out0, float *out1) = 0;
   virtual void noteOn(int32_t noteId, int16_t pitch, float tuning, float velocity) = 0;
   virtual void noteOff(int32_t noteId) = 0;
-  virtual void refreshTable() = 0;
+  virtual void refreshTable() = 0; // Can be called from any thread.
   virtual void refreshLfo() = 0;
+  virtual bool isRenderingTable() const = 0;
 
   struct MidiNote {
     bool isNoteOn;
@@ -169,7 +181,7 @@ public:
     float velocity;
   };
 
-  std::vector<MidiNote> midiNotes;
+  NoteQueue<MidiNote> midiNotes;
 
   virtual void pushMidiNote(
     bool isNoteOn,
@@ -197,6 +209,7 @@ public:
     void noteOff(int32_t noteId) override;                                               \
     void refreshTable() override;                                                        \
     void refreshLfo() override;                                                          \
+    bool isRenderingTable() const override;                                              \
                                                                                          \
     void pushMidiNote(                                                                   \
       bool isNoteOn,                                                                     \
@@ -213,40 +226,32 @@ public:
       note.pitch = pitch;                                                                \
       note.tuning = tuning;                                                              \
       note.velocity = velocity;                                                          \
-      midiNotes.push_back(note);                                                         \
+      if (!midiNotes.push(note) && !note.isNoteOn) noteOff(note.id);                     \
     }                                                                                    \
                                                                                          \
     void processMidiNote(uint32_t frame) override                                        \
     {                                                                                    \
-      while (true) {                                                                     \
-        auto it                                                                          \
-          = std::find_if(midiNotes.begin(), midiNotes.end(), [&](const MidiNote &nt) {   \
-              return nt.frame == frame;                                                  \
-            });                                                                          \
-        if (it == std::end(midiNotes)) return;                                           \
-        if (it->isNoteOn)                                                                \
-          noteOn(it->id, it->pitch, it->tuning, it->velocity);                           \
+      midiNotes.pop(frame, [&](MidiNote &nt) {                                           \
+        if (nt.isNoteOn)                                                                 \
+          noteOn(nt.id, nt.pitch, nt.tuning, nt.velocity);                               \
         else                                                                             \
-          noteOff(it->id);                                                               \
-        midiNotes.erase(it);                                                             \
-      }                                                                                  \
+          noteOff(nt.id);                                                                \
+      });                                                                                \
     }                                                                                    \
                                                                                          \
   private:                                                                               \
     void sortVoiceIndicesByGain();                                                       \
     void terminateNotes(size_t nNote);                                                   \
+    PadSynthParameter<nOvertone> getPadSynthParameter();                                 \
                                                                                          \
     float sampleRate = 44100.0f;                                                         \
                                                                                          \
-    std::array<float, nOvertone> otFrequency{};                                          \
-    std::array<float, nOvertone> otGain{};                                               \
-    std::array<float, nOvertone> otPhase{};                                              \
-    std::array<float, nOvertone> otBandWidth{};                                          \
-                                                                                         \
     bool prepareRefresh = true;                                                          \
     bool isTableRefeshed = false;                                                        \
     bool isLFORefreshed = false;                                                         \
-    WaveTable<tableSize, nOvertone> wavetable;                                           \
+    std::atomic<bool> isTableRefreshRequested{false};                                    \
+    WaveTable wavetable{maxTableWorker};                                                 \
+    WaveTableView wavetableView;                                                         \
     LfoWaveTable<lfoTableSize> lfoWavetable;                                             \
     std::array<ProcessingUnit_##INSTRSET, nUnit> units;                                  \
                                                                                          \
@@ -267,6 +272,27 @@ public:
     TableOsc<tableSize> trOsc;                                                           \
   };
 
+#if defined(UHHYOU_INSTRSET_AVX512)
+PROCESSING_UNIT_CLASS(AVX512)
+NOTE_CLASS(AVX512)
+DSPCORE_CLASS(AVX512)
+#elif defined(UHHYOU_INSTRSET_AVX2)
+PROCESSING_UNIT_CLASS(AVX2)
+NOTE_CLASS(AVX2)
+DSPCORE_CLASS(AVX2)
+#elif defined(UHHYOU_INSTRSET_AVX)
+PROCESSING_UNIT_CLASS(AVX)
+NOTE_CLASS(AVX)
+DSPCORE_CLASS(AVX)
+#else
 PROCESSING_UNIT_CLASS(FixedInstruction)
 NOTE_CLASS(FixedInstruction)
 DSPCORE_CLASS(FixedInstruction)
+#endif
+
+// Defined in `dspcore.cpp`. Only the instruction sets compiled into the binary are
+// linked.
+UHHYOU_DSPCORE_EXPORT std::unique_ptr<DSPInterface> createDSPCore_AVX512();
+UHHYOU_DSPCORE_EXPORT std::unique_ptr<DSPInterface> createDSPCore_AVX2();
+UHHYOU_DSPCORE_EXPORT std::unique_ptr<DSPInterface> createDSPCore_AVX();
+UHHYOU_DSPCORE_EXPORT std::unique_ptr<DSPInterface> createDSPCore_FixedInstruction();
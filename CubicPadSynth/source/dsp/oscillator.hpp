@@ -4,15 +4,17 @@
 #pragma once
 
 #include "../../../common/dsp/constants.hpp"
-#include "../../../lib/fftw3/fftw3.h"
+#include "../../../common/dsp/fft.hpp"
+#include "../../../common/dsp/tablediskcache.hpp"
 #include "../../../lib/vcl.hpp"
 
 #include <algorithm>
 #include <array>
+#include <complex>
 #include <cstring>
 #include <deque>
-#include <mutex>
 #include <random>
+#include <vector>
 
 namespace SomeDSP {
 
@@ -42,8 +44,37 @@ inline Vec16f cubicInterp(Vec16f y0, Vec16f y1, Vec16f y2, Vec16f y3, Vec16f t)
   return c3 * t * t2 - (c2 + c3) * t2 + c1 * t + y1;
 }
 
+template<size_t nPeak> struct PadSynthParameter {
+  float sampleRate = 44100.0f;
+  float tableBaseFreq = 20.0f;
+  std::array<float, nPeak> frequency{};
+  std::array<float, nPeak> gain{};
+  std::array<float, nPeak> phase{};
+  std::array<float, nPeak> bandWidth{};
+  uint32_t seed = 0;
+  float expand = 1.0f;
+  int32_t shift = 0;
+  uint32_t profileSkip = 1;
+  float profileShape = 1.0f;
+  bool randomPitch = false;
+  bool invertSpectrum = false;
+  bool uniformPhaseProfile = false;
+
+  bool operator==(const PadSynthParameter &) const = default;
+
+  TableKey key() const
+  {
+    TableKey key;
+    key.add(sampleRate).add(tableBaseFreq);
+    key.add(frequency).add(gain).add(phase).add(bandWidth);
+    key.add(seed).add(expand).add(shift).add(profileSkip).add(profileShape);
+    key.add(randomPitch).add(invertSpectrum).add(uniformPhaseProfile);
+    return key;
+  }
+};
+
 /*
-table is 2d array which has extra padding for interpolation.
+`table` has extra padding for interpolation. `WaveTableView::table` is 2d array of them.
 
     @              @  @
 @   3  0  1  2  3  0  1
@@ -61,57 +92,53 @@ table is 2d array which has extra padding for interpolation.
 - Padded first row is copy of first row of original table.
 - Padded last 3 row is silence.
 */
-template<size_t tableSize, size_t nPeak> struct WaveTable {
-  // `fftwMutex` is used to lock FFTW3 calls except `fftw*_execute`.
-  static std::mutex fftwMutex;
-
-  static constexpr size_t spectrumSize = tableSize / 2 + 1;
-  static constexpr size_t paddedSize = tableSize + 3;
-  fftwf_complex *spectrum;
-  fftwf_complex *bandLimited;
-  fftwf_complex *tmpSpec;
-  std::array<float *, nTablePadded> table;
-  std::array<fftwf_plan, nTablePadded> plan;
-  std::array<float, nTablePadded> frequency; // Must be sorted by ascending order.
-  bool isRefreshing = true;
+struct PadSynthTable {
+  TableBuffer table;
   float tableBaseFreq = 20.0f;
+};
 
-  WaveTable()
-  {
-    const std::lock_guard<std::mutex> fftwLock(fftwMutex);
-
-    spectrum = (fftwf_complex *)fftwf_malloc(sizeof(fftwf_complex) * spectrumSize);
-    bandLimited = (fftwf_complex *)fftwf_malloc(sizeof(fftwf_complex) * spectrumSize);
-    tmpSpec = (fftwf_complex *)fftwf_malloc(sizeof(fftwf_complex) * spectrumSize);
+/**
+Renders a `PadSynthTable` for each row of the figure above. Used as `Renderer` of
+`TableRenderer`.
 
-    for (size_t idx = 0; idx < nTablePadded; ++idx) {
-      table[idx] = (float *)fftwf_malloc(sizeof(float) * paddedSize);
-      table[idx][0] = 0;
-      table[idx][paddedSize - 1] = 0;
-
-      plan[idx]
-        = fftwf_plan_dft_c2r_1d(tableSize, bandLimited, table[idx] + 1, FFTW_ESTIMATE);
+`prepare` builds the spectrum and the full band table, which also gives the gain to
+normalize all tables. `render` band-limits the spectrum for each row.
+*/
+template<size_t tableSize, size_t nPeak> class PadSynthRenderer {
+public:
+  using Request = PadSynthParameter<nPeak>;
+  using Table = PadSynthTable;
 
-      // TODO: Experiment with different frequency.
-      frequency[idx] = 440.0f * powf(2.0f, (idx - 69.0f) / 12.0f);
-    }
+  static constexpr size_t spectrumSize = tableSize / 2 + 1;
+  static constexpr size_t paddedSize = tableSize + 3;
 
-    // Last 3 tables are slince.
-    for (size_t idx = nTablePadded - 3; idx < nTablePadded; ++idx) {
-      for (size_t i = 0; i < paddedSize; ++i) table[idx][i] = 0;
+  // Buffers for a worker. The plan is shared through `FftwPlanCache`.
+  struct Scratch {
+    FftwBuffer<std::complex<float>> bandLimited{spectrumSize};
+    FftwBuffer<float> buffer{paddedSize};
+    RealInverseFft ifft;
+
+    // Output is offset by 1 as same as padded tables.
+    Scratch() { ifft.init(tableSize, bandLimited.data(), buffer.data() + 1); }
+
+    // Writes inverse FFT of `bandLimited` into `dest`, and fills padded elements.
+    void synthesize(float *dest)
+    {
+      ifft.execute(bandLimited.data(), buffer.data() + 1);
+      std::memcpy(dest + 1, buffer.data() + 1, sizeof(float) * tableSize);
+      dest[0] = dest[tableSize];
+      dest[paddedSize - 2] = dest[1];
+      dest[paddedSize - 1] = dest[2];
     }
-  }
+  };
 
-  ~WaveTable()
-  {
-    const std::lock_guard<std::mutex> fftwLock(fftwMutex);
-
-    for (auto &pln : plan) fftwf_destroy_plan(pln);
-    for (auto &tbl : table) fftwf_free(tbl);
-    fftwf_free(tmpSpec);
-    fftwf_free(bandLimited);
-    fftwf_free(spectrum);
-  }
+private:
+  FftwBuffer<std::complex<float>> spectrum{spectrumSize};
+  FftwBuffer<std::complex<float>> tmpSpec{spectrumSize};
+  std::array<float, nTablePadded> frequency; // Must be sorted by ascending order.
+  std::vector<float> fullTable;
+  float tableBaseFreq = 20.0f;
+  float max = 0.0f;
 
   inline float profile(float fi, float bwi, float shape)
   {
@@ -120,137 +147,89 @@ template<size_t tableSize, size_t nPeak> struct WaveTable {
     return powf(expf(-x * x) / bwi, shape);
   }
 
-  void refreshTable()
-  {
-    isRefreshing = true;
-
-    // table[0] and table[1] has full spectrum.
-    bandLimited[0][0] = 0;
-    bandLimited[0][1] = 0;
-    std::memcpy(
-      bandLimited + 1, spectrum + 1, sizeof(fftwf_complex) * (spectrumSize - 1));
-    fftwf_execute(plan[0]);
-    std::memcpy(table[1], table[0], sizeof(float) * paddedSize);
-
-    for (size_t idx = 2; idx <= nTable; ++idx) {
-      size_t bandIdx = size_t(spectrumSize * tableBaseFreq / frequency[idx]);
-      bandIdx = std::clamp<size_t>(bandIdx, 1, spectrumSize);
-
-      bandLimited[0][0] = 0;
-      bandLimited[0][1] = 0;
-      std::memcpy(bandLimited + 1, spectrum + 1, sizeof(fftwf_complex) * (bandIdx - 1));
-      std::memset(
-        bandLimited + bandIdx, 0, sizeof(fftwf_complex) * (spectrumSize - bandIdx));
-
-      fftwf_execute(plan[idx]);
-    }
-
-    // Fill padded elements.
-    for (size_t idx = 0; idx < nTablePadded - 1; ++idx) {
-      table[idx][0] = table[idx][tableSize];
-      table[idx][paddedSize - 2] = table[idx][1];
-      table[idx][paddedSize - 1] = table[idx][2];
-    }
+  float sign(float x) { return float((0 < x) - (x < 0)); }
 
-    // Normalize.
-    float max = 0.0f;
-    for (size_t i = 0; i < tableSize; ++i) {
-      auto value = fabsf(table[0][i]);
-      if (max < value) max = value;
-    }
-    if (max != 0.0f) {
-      for (size_t idx = 0; idx < nTablePadded - 1; ++idx) {
-        for (size_t i = 0; i < paddedSize; ++i) table[idx][i] /= max;
-      }
+public:
+  PadSynthRenderer()
+  {
+    // TODO: Experiment with different frequency.
+    for (size_t idx = 0; idx < nTablePadded; ++idx) {
+      frequency[idx] = 440.0f * powf(2.0f, (idx - 69.0f) / 12.0f);
     }
 
-    isRefreshing = false;
+    fullTable.resize(paddedSize);
   }
 
-  float sign(float x) { return float((0 < x) - (x < 0)); }
+  PadSynthRenderer(const PadSynthRenderer &) = delete;
+  PadSynthRenderer &operator=(const PadSynthRenderer &) = delete;
 
-  void padsynth(
-    float sampleRate,
-    float tableBaseFreq,
-    std::array<float, nPeak> &frequency,
-    std::array<float, nPeak> &gain,
-    std::array<float, nPeak> &phase,
-    std::array<float, nPeak> &bandWidth,
-    uint32_t seed,
-    float expand,
-    int32_t shift,
-    uint32_t profileSkip,
-    float profileShape,
-    bool randomPitch,
-    bool invertSpectrum,
-    bool uniformPhaseProfile)
+  static size_t tableLength(const Request &, size_t) { return paddedSize; }
+
+  void prepare(const Request &rq, Scratch &scratch)
   {
-    this->tableBaseFreq = tableBaseFreq;
+    tableBaseFreq = rq.tableBaseFreq;
 
-    for (int32_t bin = 0; bin < spectrumSize; ++bin) {
-      spectrum[bin][0] = 0;
-      spectrum[bin][1] = 0;
-    }
+    std::fill(spectrum.begin(), spectrum.end(), std::complex<float>{});
 
-    std::mt19937 rng(seed);
+    std::mt19937 rng(rq.seed);
     std::uniform_real_distribution<float> distFreq(100.0f, 8000.0f);
     for (int32_t peak = 0; peak < nPeak; ++peak) {
-      float freq = randomPitch ? distFreq(rng) : frequency[peak];
-      float bandHz = (powf(2.0f, bandWidth[peak] / 1200.0f) - 1.0f) * freq;
-      float bandIdx = bandHz / (2.0f * sampleRate);
+      float freq = rq.randomPitch ? distFreq(rng) : rq.frequency[peak];
+      float bandHz = (powf(2.0f, rq.bandWidth[peak] / 1200.0f) - 1.0f) * freq;
+      float bandIdx = bandHz / (2.0f * rq.sampleRate);
 
       float sigma = sqrtf(bandIdx * bandIdx / float(twopi));
       int32_t profileHalf = std::max<int32_t>(1, int32_t(spectrumSize * 5.0f * sigma));
 
-      float freqIdx = freq * 2.0f / sampleRate;
+      float freqIdx = freq * 2.0f / rq.sampleRate;
 
       int32_t center = int32_t(freqIdx * spectrumSize);
       int32_t start = std::max<int32_t>(center - profileHalf, 0);
       int32_t end = std::min<int32_t>(center + profileHalf, spectrumSize);
 
-      std::uniform_real_distribution<float> distPhase(0.0f, phase[peak]);
+      std::uniform_real_distribution<float> distPhase(0.0f, rq.phase[peak]);
       float phi = distPhase(rng);
-      for (int32_t bin = start; bin < end; bin += profileSkip) {
-        float radius = gain[peak]
+      for (int32_t bin = start; bin < end; bin += rq.profileSkip) {
+        float radius = rq.gain[peak]
           * profile(bin / float(spectrumSize) - freqIdx, bandIdx,
-                    std::floor(profileShape));
-        if (!uniformPhaseProfile) phi = distPhase(rng);
-        spectrum[bin][0] += radius * cosf(phi);
-        spectrum[bin][1] += radius * sinf(phi);
+                    std::floor(rq.profileShape));
+        if (!rq.uniformPhaseProfile) phi = distPhase(rng);
+        spectrum[bin] += std::complex<float>(radius * cosf(phi), radius * sinf(phi));
       }
     }
 
-    if (invertSpectrum) {
+    if (rq.invertSpectrum) {
       float reMax = 0;
       float imMax = 0;
       for (int32_t bin = 1; bin < spectrumSize; ++bin) {
-        float re = fabsf(spectrum[bin][0]);
-        float im = fabsf(spectrum[bin][1]);
+        float re = fabsf(spectrum[bin].real());
+        float im = fabsf(spectrum[bin].imag());
         if (reMax < re) reMax = re;
         if (imMax < im) imMax = im;
       }
       for (int32_t bin = 1; bin < spectrumSize; ++bin) {
-        spectrum[bin][0] -= sign(spectrum[bin][0]) * reMax;
-        spectrum[bin][1] -= sign(spectrum[bin][1]) * imMax;
+        auto &value = spectrum[bin];
+        value.real(value.real() - sign(value.real()) * reMax);
+        value.imag(value.imag() - sign(value.imag()) * imMax);
 
         // TODO: test
-        // spectrum[bin][0] -= std::copysign(reMax, spectrum[bin][0]);
-        // spectrum[bin][1] -= std::copysign(imMax, spectrum[bin][1]);
+        // value.real(value.real() - std::copysign(reMax, value.real()));
+        // value.imag(value.imag() - std::copysign(imMax, value.imag()));
       }
     }
 
+    const float expand = rq.expand;
+    int32_t shift = rq.shift;
     if (expand != 1.0f || shift != 0) {
       if (abs(shift) >= spectrumSize) {
-        std::memcpy(tmpSpec, spectrum, sizeof(fftwf_complex) * spectrumSize);
+        std::copy_n(spectrum.data(), spectrumSize, tmpSpec.data());
       } else if (shift >= 0) {
-        std::memset(tmpSpec, 0, sizeof(fftwf_complex) * shift);
-        std::memcpy(
-          tmpSpec + shift, spectrum, sizeof(fftwf_complex) * (spectrumSize - shift));
+        std::fill_n(tmpSpec.data(), shift, std::complex<float>{});
+        std::copy_n(spectrum.data(), spectrumSize - shift, tmpSpec.data() + shift);
       } else { // shift < 0
         shift = abs(shift);
-        std::memcpy(
-          tmpSpec, spectrum + shift, sizeof(fftwf_complex) * (spectrumSize - shift));
-        std::memset(tmpSpec + shift, 0, sizeof(fftwf_complex) * shift);
+        std::copy_n(spectrum.data() + shift, spectrumSize - shift, tmpSpec.data());
+        std::fill_n(tmpSpec.data() + shift, shift, std::complex<float>{});
       }
 
       size_t bin = 1;
@@ -263,23 +242,77 @@ template<size_t tableSize, size_t nPeak> struct WaveTable {
         }
         size_t high = low + 1;
         float frac = tmpIdx - floorf(tmpIdx);
-        spectrum[bin][0] = tmpSpec[low][0] + frac * (tmpSpec[high][0] - tmpSpec[low][0]);
-        spectrum[bin][1] = tmpSpec[low][1] + frac * (tmpSpec[high][1] - tmpSpec[low][1]);
+        spectrum[bin] = tmpSpec[low] + frac * (tmpSpec[high] - tmpSpec[low]);
       }
 
-      std::memset(spectrum + bin, 0, sizeof(fftwf_complex) * (spectrumSize - bin));
+      std::fill(spectrum.begin() + bin, spectrum.end(), std::complex<float>{});
     }
 
     // Remove DC offset.
-    spectrum[0][0] = 0.0f;
-    spectrum[0][1] = 0.0f;
+    spectrum[0] = 0.0f;
+
+    // table[0] and table[1] has full spectrum.
+    auto &bandLimited = scratch.bandLimited;
+    bandLimited[0] = 0.0f;
+    std::copy(spectrum.begin() + 1, spectrum.end(), bandLimited.begin() + 1);
+    scratch.synthesize(fullTable.data());
+
+    // Normalize.
+    max = 0.0f;
+    for (size_t i = 0; i < tableSize; ++i) {
+      auto value = fabsf(fullTable[i]);
+      if (max < value) max = value;
+    }
+    if (max != 0.0f) {
+      for (size_t i = 0; i < paddedSize; ++i) fullTable[i] /= max;
+    }
+  }
+
+  void render(size_t index, Table &wavetable, Scratch &scratch) const
+  {
+    wavetable.table.resize(paddedSize);
+    wavetable.tableBaseFreq = tableBaseFreq;
+    auto &table = wavetable.table;
+
+    if (index <= 1) {
+      std::copy(fullTable.begin(), fullTable.end(), table.data());
+      return;
+    }
+
+    // Last 3 tables are silence.
+    if (index > nTable) {
+      std::fill_n(table.data(), table.size(), 0.0f);
+      return;
+    }
+
+    size_t bandIdx = size_t(spectrumSize * tableBaseFreq / frequency[index]);
+    bandIdx = std::clamp<size_t>(bandIdx, 1, spectrumSize);
+
+    auto &bandLimited = scratch.bandLimited;
+    bandLimited[0] = 0.0f;
+    std::copy_n(spectrum.begin() + 1, bandIdx - 1, bandLimited.begin() + 1);
+    std::fill(bandLimited.begin() + bandIdx, bandLimited.end(), std::complex<float>{});
+    scratch.synthesize(table.data());
 
-    refreshTable();
+    if (max != 0.0f) {
+      for (size_t i = 0; i < paddedSize; ++i) table[i] /= max;
+    }
   }
 };
 
-template<size_t tableSize, size_t nPeak>
-std::mutex WaveTable<tableSize, nPeak>::fftwMutex;
+// Pointers to the tables used in a block. Refreshed from `TableRenderer` by `load`.
+struct WaveTableView {
+  std::array<const float *, nTablePadded> table{};
+  float tableBaseFreq = 20.0f;
+
+  template<typename Renderer> void load(const Renderer &renderer)
+  {
+    for (size_t idx = 0; idx < nTablePadded; ++idx) {
+      table[idx] = renderer.get(idx).table.data();
+    }
+    tableBaseFreq = renderer.get(0).tableBaseFreq;
+  }
+};
 
 template<size_t tableSize> struct TableOsc {
   static constexpr size_t paddedLast = tableSize + 1;
@@ -300,7 +333,7 @@ template<size_t tableSize> struct TableOsc {
 
   // notePitch is fractional note number. For example, notePitch = 60.12 means 60
   // semitones and 12 cents higher from midi note number 0.
-  float process(float notePitch, std::array<float *, nTablePadded> &table)
+  float process(float notePitch, const std::array<const float *, nTablePadded> &table)
   {
     phase += tick;
     if (phase > paddedLast) phase -= tableSize;
@@ -384,7 +417,8 @@ template<size_t tableSize> struct alignas(64) TableOsc16 {
     tick = 0;
   }
 
-  inline Vec16f loadTable(Vec16i ix, Vec16i iy, std::array<float *, nTablePadded> &table)
+  inline Vec16f
+  loadTable(Vec16i ix, Vec16i iy, const std::array<const float *, nTablePadded> &table)
   {
     return Vec16f(
       table[iy.extract(0)][ix.extract(0)], table[iy.extract(1)][ix.extract(1)],
@@ -399,7 +433,7 @@ template<size_t tableSize> struct alignas(64) TableOsc16 {
 
   // notePitch is fractional note number. For example, notePitch = 60.12 means 60
   // semitones and 12 cents higher from midi note number 0.
-  Vec16f process(Vec16f notePitch, std::array<float *, nTablePadded> &table)
+  Vec16f process(Vec16f notePitch, const std::array<const float *, nTablePadded> &table)
   {
     phase += tick;
     phase = select(phase >= paddedLast, phase - tableSize, phase);
@@ -429,7 +463,8 @@ template<size_t tableSize> struct alignas(64) TableOsc16 {
   }
 
   // Too slow.
-  Vec16f processCubic(Vec16f notePitch, std::array<float *, nTablePadded> &table)
+  Vec16f
+  processCubic(Vec16f notePitch, const std::array<const float *, nTablePadded> &table)
   {
     phase += tick;
     phase = select(phase >= paddedLast, phase - tableSize, phase);
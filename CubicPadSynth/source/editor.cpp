@@ -43,6 +43,30 @@ Editor::Editor(void *controller) : PlugEditor(controller)
   setRect(viewRect);
 }
 
+Editor::~Editor()
+{
+  if (refreshButton) refreshButton->forget();
+}
+
+void Editor::updateUI(ParamID id, ParamValue normalized)
+{
+  PlugEditor::updateUI(id, normalized);
+
+  using ID = Synth::ParameterID::ID;
+
+  if (refreshButton == nullptr) return;
+  if (id != ID::guiTableProgress) return;
+
+  if (normalized >= 1.0) {
+    refreshButton->label = "Refresh Table";
+  } else {
+    std::ostringstream os;
+    os << "Rendering " << int(100.0 * normalized) << "%";
+    refreshButton->label = os.str();
+  }
+  refreshButton->invalid();
+}
+
 bool Editor::prepareUI()
 {
   using ID = Synth::ParameterID::ID;
@@ -609,11 +633,11 @@ bool Editor::prepareUI()
   // Refresh button.
   const auto refreshTop = tabTop0 + tabHeight - 2.0f * labelY;
   const auto refreshLeft = tabInsideLeft0;
-  tabview->addWidget(
-    tabPadSynth,
-    addKickButton<Style::warning>(
-      refreshLeft, refreshTop, 2.0f * knobX, 2.0f * labelHeight, midTextSize,
-      "Refresh Table", ID::refreshTable));
+  refreshButton = addKickButton<Style::warning>(
+    refreshLeft, refreshTop, 2.0f * knobX, 2.0f * labelHeight, midTextSize,
+    "Refresh Table", ID::refreshTable);
+  refreshButton->remember();
+  tabview->addWidget(tabPadSynth, refreshButton);
 
   // Overtone Gain.
   const auto otGainTop = tabInsideTop0;
@@ -14,9 +14,14 @@ using namespace VSTGUI;
 class Editor : public PlugEditor {
 public:
   Editor(void *controller);
+  ~Editor();
+
+  void updateUI(Vst::ParamID id, ParamValue normalized) override;
+
   DELEGATE_REFCOUNT(VSTGUIEditor);
 
 protected:
+  KickButton<Uhhyou::Style::warning> *refreshButton = nullptr;
   bool prepareUI() override;
 };
 
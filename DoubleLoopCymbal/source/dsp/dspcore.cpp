@@ -56,6 +56,8 @@ inline double pitchRatio(double pitch, double spread, double rndCent, Rng &rng)
 
 void DSPCore::setup(double sampleRate)
 {
+  SmootherCommon<double>::Scope smootherScope(smootherState);
+
   noteStack.reserve(1024);
   noteStack.resize(0);
 
@@ -172,7 +174,9 @@ void DSPCore::updateDelayTime()
 
 void DSPCore::reset()
 {
-  midiNotes.resize(0);
+  SmootherCommon<double>::Scope smootherScope(smootherState);
+
+  midiNotes.clear();
   noteStack.resize(0);
 
   overSampling = param.value[ParameterID::ID::overSampling]->getInt();
@@ -213,6 +217,8 @@ void DSPCore::reset()
 
 void DSPCore::startup()
 {
+  SmootherCommon<double>::Scope smootherScope(smootherState);
+
   using ID = ParameterID::ID;
   const auto &pv = param.value;
 
@@ -223,6 +229,8 @@ void DSPCore::startup()
 
 void DSPCore::setParameters()
 {
+  SmootherCommon<double>::Scope smootherScope(smootherState);
+
   size_t newOverSampling = param.value[ParameterID::ID::overSampling]->getInt();
   if (overSampling != newOverSampling) {
     overSampling = newOverSampling;
@@ -305,9 +313,11 @@ double DSPCore::processFrame(const std::array<double, 2> &externalInput)
   return outGain * ap2;
 }
 
+template<typename Sample>
 void DSPCore::process(
-  const size_t length, const float *in0, const float *in1, float *out0, float *out1)
+  const size_t length, const Sample *in0, const Sample *in1, Sample *out0, Sample *out1)
 {
+  SmootherCommon<double>::Scope smootherScope(smootherState);
   ScopedNoDenormals scopedDenormals;
 
   using ID = ParameterID::ID;
@@ -343,8 +353,15 @@ void DSPCore::process(
   }
 }
 
+template void DSPCore::process<float>(
+  const size_t length, const float *in0, const float *in1, float *out0, float *out1);
+template void DSPCore::process<double>(
+  const size_t length, const double *in0, const double *in1, double *out0, double *out1);
+
 void DSPCore::noteOn(NoteInfo &info)
 {
+  SmootherCommon<double>::Scope smootherScope(smootherState);
+
   using ID = ParameterID::ID;
   auto &pv = param.value;
 
@@ -393,6 +410,8 @@ void DSPCore::noteOn(NoteInfo &info)
 
 void DSPCore::noteOff(int_fast32_t noteId, double noteOffVelocity)
 {
+  SmootherCommon<double>::Scope smootherScope(smootherState);
+
   using ID = ParameterID::ID;
   auto &pv = param.value;
 
@@ -5,6 +5,7 @@
 
 #include "../../../common/dsp/constants.hpp"
 #include "../../../common/dsp/multirate.hpp"
+#include "../../../common/dsp/notequeue.hpp"
 #include "../../../common/dsp/smoother.hpp"
 #include "../../../lib/pcg-cpp/pcg_random.hpp"
 #include "../parameter.hpp"
@@ -32,6 +33,7 @@ public:
   }
 
   GlobalParameter param;
+  SmootherState<double> smootherState;
   bool isPlaying = false;
   double tempo = 120.0;
   double beatsElapsed = 0.0;
@@ -42,8 +44,13 @@ public:
   void reset();
   void startup();
   void setParameters();
+  template<typename Sample>
   void process(
-    const size_t length, const float *in0, const float *in1, float *out0, float *out1);
+    const size_t length,
+    const Sample *in0,
+    const Sample *in1,
+    Sample *out0,
+    Sample *out1);
   void noteOn(NoteInfo &info);
   void noteOff(int_fast32_t noteId, double noteOffVelocity);
 
@@ -61,22 +68,17 @@ public:
     note.id = noteId;
     note.noteNumber = noteNumber + tuning;
     note.velocity = velocity;
-    midiNotes.push_back(note);
+    if (!midiNotes.push(note) && !note.isNoteOn) noteOff(note.id, note.velocity);
   }
 
   void processMidiNote(size_t frame)
   {
-    while (true) {
-      auto it = std::find_if(midiNotes.begin(), midiNotes.end(), [&](const NoteInfo &nt) {
-        return nt.frame == frame;
-      });
-      if (it == std::end(midiNotes)) return;
-      if (it->isNoteOn)
-        noteOn(*it);
+    midiNotes.pop(frame, [&](NoteInfo &nt) {
+      if (nt.isNoteOn)
+        noteOn(nt);
       else
-        noteOff(it->id, it->velocity);
-      midiNotes.erase(it);
-    }
+        noteOff(nt.id, nt.velocity);
+    });
   }
 
 private:
@@ -85,7 +87,7 @@ private:
   double calcNotePitch(double note);
   double processFrame(const std::array<double, 2> &externalInput);
 
-  std::vector<NoteInfo> midiNotes;
+  NoteQueue<NoteInfo> midiNotes;
   std::vector<NoteInfo> noteStack;
 
   static constexpr size_t upFold = 2;
@@ -8,6 +8,13 @@
 #include "../../test/synthtester.hpp"
 #include "../source/dsp/dspcore.hpp"
 
+#ifdef BENCH_DSP
+  #include "../../test/synthbench.hpp"
+using Tester = SynthBench<DSPCore>;
+#else
+using Tester = SynthTester<DSPCore>;
+#endif
+
 // CMake provides this macro, but just in case.
 #ifndef UHHYOU_PLUGIN_NAME
   #define UHHYOU_PLUGIN_NAME "DoubleLoopCymbal"
@@ -17,6 +24,6 @@
 
 int main()
 {
-  SynthTester<DSPCore> tester(UHHYOU_PLUGIN_NAME, OUT_DIR_PATH, 1);
+  Tester tester(UHHYOU_PLUGIN_NAME, OUT_DIR_PATH, 1);
   return tester.isFinished ? EXIT_SUCCESS : EXIT_FAILURE;
 }
@@ -10,8 +10,23 @@
 #include <algorithm>
 #include <numeric>
 
-#define NOTE_NAME Note_FixedInstruction
-#define DSPCORE_NAME DSPCore_FixedInstruction
+#if defined(UHHYOU_INSTRSET_AVX512)
+  #define NOTE_NAME Note_AVX512
+  #define DSPCORE_NAME DSPCore_AVX512
+  #define DSPCORE_FACTORY createDSPCore_AVX512
+#elif defined(UHHYOU_INSTRSET_AVX2)
+  #define NOTE_NAME Note_AVX2
+  #define DSPCORE_NAME DSPCore_AVX2
+  #define DSPCORE_FACTORY createDSPCore_AVX2
+#elif defined(UHHYOU_INSTRSET_AVX)
+  #define NOTE_NAME Note_AVX
+  #define DSPCORE_NAME DSPCore_AVX
+  #define DSPCORE_FACTORY createDSPCore_AVX
+#else
+  #define NOTE_NAME Note_FixedInstruction
+  #define DSPCORE_NAME DSPCore_FixedInstruction
+  #define DSPCORE_FACTORY createDSPCore_FixedInstruction
+#endif
 
 inline float clamp(float value, float min, float max)
 {
@@ -199,9 +214,11 @@ DSPCORE_NAME::DSPCORE_NAME() { midiNotes.reserve(128); }
 
 void DSPCORE_NAME::setup(double sampleRate)
 {
+  SmootherCommon<float>::Scope smootherScope(smootherState);
+
   this->sampleRate = float(sampleRate);
 
-  midiNotes.resize(0);
+  midiNotes.clear();
 
   SmootherCommon<float>::setSampleRate(this->sampleRate);
   SmootherCommon<float>::setTime(0.04f);
@@ -220,6 +237,8 @@ void DSPCORE_NAME::setup(double sampleRate)
 
 void DSPCORE_NAME::reset()
 {
+  SmootherCommon<float>::Scope smootherScope(smootherState);
+
   for (auto &note : notes) note.rest();
   lastNoteFreq = 1.0f;
 
@@ -230,6 +249,8 @@ void DSPCORE_NAME::reset()
 
 void DSPCORE_NAME::startup()
 {
+  SmootherCommon<float>::Scope smootherScope(smootherState);
+
   rng.setSeed(param.value[ParameterID::seed]->getInt());
 
   for (size_t i = 0; i < phaser.size(); ++i) {
@@ -239,6 +260,8 @@ void DSPCORE_NAME::startup()
 
 void DSPCORE_NAME::setParameters()
 {
+  SmootherCommon<float>::Scope smootherScope(smootherState);
+
   using ID = ParameterID::ID;
 
   SmootherCommon<float>::setTime(param.value[ID::smoothness]->getFloat());
@@ -269,6 +292,7 @@ void DSPCORE_NAME::setParameters()
 
 void DSPCORE_NAME::process(const size_t length, float *out0, float *out1)
 {
+  SmootherCommon<float>::Scope smootherScope(smootherState);
   ScopedNoDenormals scopedDenormals;
 
   SmootherCommon<float>::setBufferSize(float(length));
@@ -316,6 +340,8 @@ void DSPCORE_NAME::process(const size_t length, float *out0, float *out1)
 
 void DSPCORE_NAME::noteOn(int32_t identifier, int16_t pitch, float tuning, float velocity)
 {
+  SmootherCommon<float>::Scope smootherScope(smootherState);
+
   if (param.value[ParameterID::randomRetrigger]->getInt())
     rng.setSeed(param.value[ParameterID::seed]->getInt());
 
@@ -390,6 +416,8 @@ void DSPCORE_NAME::fillTransitionBuffer(size_t noteIndex)
 
 void DSPCORE_NAME::noteOff(int32_t noteId)
 {
+  SmootherCommon<float>::Scope smootherScope(smootherState);
+
   size_t i = 0;
   for (; i < notes.size(); ++i) {
     if (notes[i].id == noteId) break;
@@ -398,3 +426,8 @@ void DSPCORE_NAME::noteOff(int32_t noteId)
 
   notes[i].release();
 }
+
+std::unique_ptr<DSPInterface> DSPCORE_FACTORY()
+{
+  return std::make_unique<DSPCORE_NAME>();
+}
@@ -22,7 +22,18 @@ namespace Synth {
 
 PlugProcessor::PlugProcessor()
 {
-  dsp = std::make_unique<DSPCore_FixedInstruction>();
+#ifdef UHHYOU_SIMD_RUNTIME_DISPATCH
+  const auto iset = instrset_detect();
+  if (iset >= 10) {
+    dsp = createDSPCore_AVX512();
+  } else if (iset >= 8 && hasFMA3()) {
+    dsp = createDSPCore_AVX2();
+  } else {
+    dsp = createDSPCore_AVX();
+  }
+#else
+  dsp = createDSPCore_FixedInstruction();
+#endif
 
   setControllerClass(ControllerUID);
 }
@@ -61,6 +72,7 @@ tresult PLUGIN_API PlugProcessor::setupProcessing(Vst::ProcessSetup &setup)
 {
   if (dsp == nullptr) return kNotInitialized;
   dsp->setup(processSetup.sampleRate);
+  automation.setup(setup.maxSamplesPerBlock, dsp->param.value.size());
   return AudioEffect::setupProcessing(setup);
 }
 
@@ -69,6 +81,7 @@ tresult PLUGIN_API PlugProcessor::setActive(TBool state)
   if (dsp == nullptr) return kResultFalse;
   if (state) {
     dsp->setup(processSetup.sampleRate);
+    silence.setup(processSetup.sampleRate);
   } else {
     dsp->reset();
     lastState = 0;
@@ -80,20 +93,8 @@ tresult PLUGIN_API PlugProcessor::process(Vst::ProcessData &data)
 {
   if (dsp == nullptr) return kNotInitialized;
 
-  // Read inputs parameter changes.
-  if (data.inputParameterChanges) {
-    int32 parameterCount = data.inputParameterChanges->getParameterCount();
-    for (int32 index = 0; index < parameterCount; index++) {
-      auto queue = data.inputParameterChanges->getParameterData(index);
-      if (!queue) continue;
-      Vst::ParamValue value;
-      int32 sampleOffset;
-      if (queue->getPoint(queue->getPointCount() - 1, sampleOffset, value) != kResultTrue)
-        continue;
-      size_t id = queue->getParameterId();
-      if (id < dsp->param.value.size()) dsp->param.value[id]->setFromNormalized(value);
-    }
-  }
+  // Read inputs parameter changes and events.
+  automation.receive(data, dsp->param);
 
   if (data.processContext != nullptr) {
     uint64_t state = data.processContext->state;
@@ -106,50 +107,50 @@ tresult PLUGIN_API PlugProcessor::process(Vst::ProcessData &data)
     lastState = state;
   }
 
-  dsp->setParameters();
-
-  if (data.numOutputs == 0) return kResultOk;
-  if (data.numSamples <= 0) return kResultOk;
-  if (data.outputs[0].numChannels < 2) return kResultOk;
-  if (data.symbolicSampleSize == Vst::kSample64) return kResultOk;
-
-  if (data.inputEvents != nullptr) handleEvent(data);
+  if (
+    data.numOutputs == 0 || data.numSamples <= 0 || data.outputs[0].numChannels < 2
+    || data.symbolicSampleSize == Vst::kSample64)
+  {
+    automation.flush(dsp->param);
+    return kResultOk;
+  }
 
   float *out0 = data.outputs[0].channelBuffers32[0];
   float *out1 = data.outputs[0].channelBuffers32[1];
-  size_t length = data.numSamples < 0 ? 0 : size_t(data.numSamples);
-  dsp->process(length, out0, out1);
+  if (silence.skip<Vst::Sample32>(data, automation.isIdle())) return kResultOk;
+  automation.dispatch(
+    data.numSamples, dsp->param, [&](const Vst::Event &event) { handleEvent(event); },
+    [&](int32 offset, int32 length) {
+      dsp->setParameters();
+      dsp->process(size_t(length), out0 + offset, out1 + offset);
+    });
+  silence.update<Vst::Sample32>(data);
 
   return kResultOk;
 }
 
-void PlugProcessor::handleEvent(Vst::ProcessData &data)
+void PlugProcessor::handleEvent(const Vst::Event &event)
 {
   if (dsp == nullptr) return;
 
-  for (int32 index = 0; index < data.inputEvents->getEventCount(); ++index) {
-    Vst::Event event;
-    if (data.inputEvents->getEvent(index, event) != kResultOk) continue;
-    switch (event.type) {
-      case Vst::Event::kNoteOnEvent: {
-        // List of DAW that doesn't support note ID. Probably more.
-        // - Ableton Live 10.1.6
-        // - PreSonus Studio One 4.6.1
-        auto noteId
-          = event.noteOn.noteId == -1 ? event.noteOn.pitch : event.noteOn.noteId;
-        dsp->pushMidiNote(
-          true, event.sampleOffset, noteId, event.noteOn.pitch, event.noteOn.tuning,
-          event.noteOn.velocity);
-      } break;
-
-      case Vst::Event::kNoteOffEvent: {
-        auto noteId
-          = event.noteOff.noteId == -1 ? event.noteOff.pitch : event.noteOff.noteId;
-        dsp->pushMidiNote(false, event.sampleOffset, noteId, 0, 0, 0);
-      } break;
-
-        // Add other event type here.
-    }
+  switch (event.type) {
+    case Vst::Event::kNoteOnEvent: {
+      // List of DAW that doesn't support note ID. Probably more.
+      // - Ableton Live 10.1.6
+      // - PreSonus Studio One 4.6.1
+      auto noteId = event.noteOn.noteId == -1 ? event.noteOn.pitch : event.noteOn.noteId;
+      dsp->pushMidiNote(
+        true, event.sampleOffset, noteId, event.noteOn.pitch, event.noteOn.tuning,
+        event.noteOn.velocity);
+    } break;
+
+    case Vst::Event::kNoteOffEvent: {
+      auto noteId
+        = event.noteOff.noteId == -1 ? event.noteOff.pitch : event.noteOff.noteId;
+      dsp->pushMidiNote(false, event.sampleOffset, noteId, 0, 0, 0);
+    } break;
+
+      // Add other event type here.
   }
 }
 
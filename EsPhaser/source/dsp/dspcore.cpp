@@ -10,10 +10,24 @@
 #include <algorithm>
 #include <numeric>
 
-#define DSPCORE_NAME DSPCore_FixedInstruction
+#if defined(UHHYOU_INSTRSET_AVX512)
+  #define DSPCORE_NAME DSPCore_AVX512
+  #define DSPCORE_FACTORY createDSPCore_AVX512
+#elif defined(UHHYOU_INSTRSET_AVX2)
+  #define DSPCORE_NAME DSPCore_AVX2
+  #define DSPCORE_FACTORY createDSPCore_AVX2
+#elif defined(UHHYOU_INSTRSET_AVX)
+  #define DSPCORE_NAME DSPCore_AVX
+  #define DSPCORE_FACTORY createDSPCore_AVX
+#else
+  #define DSPCORE_NAME DSPCore_FixedInstruction
+  #define DSPCORE_FACTORY createDSPCore_FixedInstruction
+#endif
 
 void DSPCORE_NAME::setup(double sampleRate)
 {
+  SmootherCommon<float>::Scope smootherScope(smootherState);
+
   this->sampleRate = float(sampleRate);
 
   SmootherCommon<float>::setSampleRate(this->sampleRate);
@@ -46,6 +60,8 @@ void DSPCORE_NAME::setup(double sampleRate)
 
 void DSPCORE_NAME::reset()
 {
+  SmootherCommon<float>::Scope smootherScope(smootherState);
+
   using ID = ParameterID::ID;
 
   ASSIGN_PARAMETER(reset);
@@ -57,6 +73,8 @@ void DSPCORE_NAME::reset()
 
 void DSPCORE_NAME::startup()
 {
+  SmootherCommon<float>::Scope smootherScope(smootherState);
+
   for (size_t i = 0; i < phaser.size(); ++i) {
     phaser[i].phase = float(i) / phaser.size();
   }
@@ -64,6 +82,8 @@ void DSPCORE_NAME::startup()
 
 void DSPCORE_NAME::setParameters()
 {
+  SmootherCommon<float>::Scope smootherScope(smootherState);
+
   using ID = ParameterID::ID;
 
   ASSIGN_PARAMETER(push);
@@ -73,9 +93,11 @@ void DSPCORE_NAME::setParameters()
   phaser[1].setStage(phaserStage);
 }
 
-void DSPCORE_NAME::process(
-  const size_t length, const float *in0, const float *in1, float *out0, float *out1)
+template<typename Sample>
+void DSPCORE_NAME::processBlock(
+  const size_t length, const Sample *in0, const Sample *in1, Sample *out0, Sample *out1)
 {
+  SmootherCommon<float>::Scope smootherScope(smootherState);
   ScopedNoDenormals scopedDenormals;
 
   auto len_f = float(length);
@@ -103,3 +125,20 @@ void DSPCORE_NAME::process(
     out1[i] = in1[i] + mix * (phaser1 - in1[i]);
   }
 }
+
+void DSPCORE_NAME::process(
+  const size_t length, const float *in0, const float *in1, float *out0, float *out1)
+{
+  processBlock(length, in0, in1, out0, out1);
+}
+
+void DSPCORE_NAME::process(
+  const size_t length, const double *in0, const double *in1, double *out0, double *out1)
+{
+  processBlock(length, in0, in1, out0, out1);
+}
+
+std::unique_ptr<DSPInterface> DSPCORE_FACTORY()
+{
+  return std::make_unique<DSPCORE_NAME>();
+}
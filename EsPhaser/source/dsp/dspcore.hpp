@@ -10,6 +10,7 @@
 
 #include <array>
 #include <cmath>
+#include <memory>
 
 using namespace SomeDSP;
 using namespace Steinberg::Synth;
@@ -20,6 +21,7 @@ public:
 
   static const size_t maxVoice = 32;
   GlobalParameter param;
+  SmootherState<float> smootherState;
 
   virtual void setup(double sampleRate) = 0;
   virtual void reset() = 0;   // Stop sounds.
@@ -28,6 +30,9 @@ public:
   virtual void process(
     const size_t length, const float *in0, const float *in1, float *out0, float *out1)
     = 0;
+  virtual void process(
+    const size_t length, const double *in0, const double *in1, double *out0, double *out1)
+    = 0;
 };
 
 #define DSPCORE_CLASS(INSTRSET)                                                          \
@@ -43,8 +48,22 @@ public:
       const float *in1,                                                                  \
       float *out0,                                                                       \
       float *out1) override;                                                             \
+    void process(                                                                        \
+      const size_t length,                                                               \
+      const double *in0,                                                                 \
+      const double *in1,                                                                 \
+      double *out0,                                                                      \
+      double *out1) override;                                                            \
                                                                                          \
   private:                                                                               \
+    template<typename Sample>                                                            \
+    void processBlock(                                                                   \
+      const size_t length,                                                               \
+      const Sample *in0,                                                                 \
+      const Sample *in1,                                                                 \
+      Sample *out0,                                                                      \
+      Sample *out1);                                                                     \
+                                                                                         \
     float sampleRate = 44100.0f;                                                         \
                                                                                          \
     std::array<Thiran2Phaser, 2> phaser;                                                 \
@@ -60,4 +79,19 @@ public:
     LinearSmoother<float> interpCascadeOffset;                                           \
   };
 
+#if defined(UHHYOU_INSTRSET_AVX512)
+DSPCORE_CLASS(AVX512)
+#elif defined(UHHYOU_INSTRSET_AVX2)
+DSPCORE_CLASS(AVX2)
+#elif defined(UHHYOU_INSTRSET_AVX)
+DSPCORE_CLASS(AVX)
+#else
 DSPCORE_CLASS(FixedInstruction)
+#endif
+
+// Defined in `dspcore.cpp`. Only the instruction sets compiled into the binary are
+// linked.
+UHHYOU_DSPCORE_EXPORT std::unique_ptr<DSPInterface> createDSPCore_AVX512();
+UHHYOU_DSPCORE_EXPORT std::unique_ptr<DSPInterface> createDSPCore_AVX2();
+UHHYOU_DSPCORE_EXPORT std::unique_ptr<DSPInterface> createDSPCore_AVX();
+UHHYOU_DSPCORE_EXPORT std::unique_ptr<DSPInterface> createDSPCore_FixedInstruction();
@@ -19,6 +19,8 @@ template<typename T> inline T calcNotePitch(T note)
 
 void DSPCore::setup(double sampleRate)
 {
+  SmootherCommon<float>::Scope smootherScope(smootherState);
+
   this->sampleRate = float(sampleRate);
 
   SmootherCommon<float>::setSampleRate(this->sampleRate);
@@ -77,6 +79,8 @@ size_t DSPCore::getLatency() { return 0; }
 
 void DSPCore::reset()
 {
+  SmootherCommon<float>::Scope smootherScope(smootherState);
+
   rng.seed(9999991);
 
   midiNotes.clear();
@@ -101,6 +105,8 @@ void DSPCore::startup() {}
 
 void DSPCore::setParameters()
 {
+  SmootherCommon<float>::Scope smootherScope(smootherState);
+
   std::uniform_real_distribution<float> timeLfoDist(0.0f, 1.0f);
   for (size_t idx = 0; idx < nDelay; ++idx) {
     lowpassLfoTime[0][idx].process(timeLfoDist(rng));
@@ -131,49 +137,98 @@ void DSPCore::setParameters()
   prepareRefresh = false;
 }
 
+template<typename Sample>
 void DSPCore::process(
-  const size_t length, const float *in0, const float *in1, float *out0, float *out1)
+  const size_t length, const Sample *in0, const Sample *in1, Sample *out0, Sample *out1)
 {
+  SmootherCommon<float>::Scope smootherScope(smootherState);
   ScopedNoDenormals scopedDenormals;
 
   SmootherCommon<float>::setBufferSize(float(length));
 
-  for (size_t i = 0; i < length; ++i) {
-    processMidiNote(i);
+  constexpr auto maxBlockSize = FeedbackDelayNetwork<float, nDelay>::maxBlockSize;
+  std::array<std::array<float, maxBlockSize>, 2> blockBuffer;
+
+  size_t i = 0;
+  while (i < length) {
+    auto nFrame = std::min(
+      feedbackDelayNetwork[0].getBlockSize(length - i),
+      feedbackDelayNetwork[1].getBlockSize(length - i));
+
+    // Delay time is too short for block processing.
+    if (nFrame == 0) {
+      processMidiNote(i);
+      updateFilterCutoff();
+
+      auto splitPhaseOffset = interpSplitPhaseOffset.process();
+      auto splitSkew = interpSplitSkew.process();
+      auto stereoCross = interpStereoCross.process();
+      auto feedback = interpFeedback.process();
+
+      auto gateOut = gate.process(std::max(std::fabs(in0[i]), std::fabs(in1[i])));
+      stereoCross = std::min(1.0f, stereoCross + (1.0f - stereoCross) * gateOut);
+
+      auto fdnBuf0 = feedbackDelayNetwork[0].preProcess(splitPhaseOffset, splitSkew);
+      auto fdnBuf1 = feedbackDelayNetwork[1].preProcess(splitPhaseOffset, splitSkew);
+      crossBuffer[0]
+        = feedbackDelayNetwork[0].process(in0[i], fdnBuf1, stereoCross, feedback);
+      crossBuffer[1]
+        = feedbackDelayNetwork[1].process(in1[i], fdnBuf0, stereoCross, feedback);
+
+      auto dry = interpDry.process();
+      auto wet = interpWet.process();
+      out0[i] = dry * in0[i] + wet * crossBuffer[0];
+      out1[i] = dry * in1[i] + wet * crossBuffer[1];
+
+      ++i;
+      continue;
+    }
+
+    for (size_t k = 0; k < nFrame; ++k) {
+      processMidiNote(i + k);
+      updateFilterCutoff();
+
+      blockBuffer[0][k] = feedbackDelayNetwork[0].readFrame(k);
+      blockBuffer[1][k] = feedbackDelayNetwork[1].readFrame(k);
+    }
+
+    for (auto &fdn : feedbackDelayNetwork) fdn.multiplyBlock(nFrame);
+
+    for (size_t k = 0; k < nFrame; ++k, ++i) {
+      auto splitPhaseOffset = interpSplitPhaseOffset.process();
+      auto splitSkew = interpSplitSkew.process();
+      auto stereoCross = interpStereoCross.process();
+      auto feedback = interpFeedback.process();
+
+      auto gateOut = gate.process(std::max(std::fabs(in0[i]), std::fabs(in1[i])));
+      stereoCross = std::min(1.0f, stereoCross + (1.0f - stereoCross) * gateOut);
 
-    for (size_t idx = 0; idx < nDelay; ++idx) {
-      auto lowpassCutoff = interpLowpassCutoff[idx].process();
-      auto highpassCutoff = interpHighpassCutoff[idx].process();
-      for (auto &fdn : feedbackDelayNetwork) {
-        fdn.lowpassKp[idx] = lowpassCutoff;
-        fdn.highpassKp[idx] = highpassCutoff;
-      }
+      auto fdnBuf0 = feedbackDelayNetwork[0].getMixedSum(k);
+      auto fdnBuf1 = feedbackDelayNetwork[1].getMixedSum(k);
+      feedbackDelayNetwork[0].writeFrame(
+        k, splitPhaseOffset, splitSkew, in0[i], fdnBuf1, stereoCross, feedback);
+      feedbackDelayNetwork[1].writeFrame(
+        k, splitPhaseOffset, splitSkew, in1[i], fdnBuf0, stereoCross, feedback);
+
+      auto dry = interpDry.process();
+      auto wet = interpWet.process();
+      out0[i] = dry * in0[i] + wet * blockBuffer[0][k];
+      out1[i] = dry * in1[i] + wet * blockBuffer[1][k];
     }
 
-    auto splitPhaseOffset = interpSplitPhaseOffset.process();
-    auto splitSkew = interpSplitSkew.process();
-    auto stereoCross = interpStereoCross.process();
-    auto feedback = interpFeedback.process();
-
-    auto gateOut = gate.process(std::max(std::fabs(in0[i]), std::fabs(in1[i])));
-    stereoCross = std::min(1.0f, stereoCross + (1.0f - stereoCross) * gateOut);
-
-    auto fdnBuf0 = feedbackDelayNetwork[0].preProcess(splitPhaseOffset, splitSkew);
-    auto fdnBuf1 = feedbackDelayNetwork[1].preProcess(splitPhaseOffset, splitSkew);
-    crossBuffer[0]
-      = feedbackDelayNetwork[0].process(in0[i], fdnBuf1, stereoCross, feedback);
-    crossBuffer[1]
-      = feedbackDelayNetwork[1].process(in1[i], fdnBuf0, stereoCross, feedback);
-
-    auto dry = interpDry.process();
-    auto wet = interpWet.process();
-    out0[i] = dry * in0[i] + wet * crossBuffer[0];
-    out1[i] = dry * in1[i] + wet * crossBuffer[1];
+    for (auto &fdn : feedbackDelayNetwork) fdn.finishBlock(nFrame);
   }
 }
 
+template void DSPCore::process<float>(
+  const size_t length, const float *in0, const float *in1, float *out0, float *out1);
+template void DSPCore::process<double>(
+  const size_t length, const double *in0, const double *in1, double *out0, double *out1);
+
 void DSPCore::noteOn(NoteInfo &info)
 {
+  SmootherCommon<float>::Scope smootherScope(smootherState);
+
   notePitchMultiplier = calcNotePitch(info.pitch);
   updateDelayTime();
 
@@ -182,6 +237,8 @@ void DSPCore::noteOn(NoteInfo &info)
 
 void DSPCore::noteOff(int_fast32_t noteId)
 {
+  SmootherCommon<float>::Scope smootherScope(smootherState);
+
   auto it = std::find_if(noteStack.begin(), noteStack.end(), [&](const NoteInfo &info) {
     return info.id == noteId;
   });
@@ -196,6 +253,18 @@ void DSPCore::noteOff(int_fast32_t noteId)
   updateDelayTime();
 }
 
+void DSPCore::updateFilterCutoff()
+{
+  for (size_t idx = 0; idx < nDelay; ++idx) {
+    auto lowpassCutoff = interpLowpassCutoff[idx].process();
+    auto highpassCutoff = interpHighpassCutoff[idx].process();
+    for (auto &fdn : feedbackDelayNetwork) {
+      fdn.lowpassKp[idx] = lowpassCutoff;
+      fdn.highpassKp[idx] = highpassCutoff;
+    }
+  }
+}
+
 void DSPCore::updateDelayTime()
 {
   using ID = ParameterID::ID;
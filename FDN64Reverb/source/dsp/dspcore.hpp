@@ -4,6 +4,7 @@
 #pragma once
 
 #include "../../../common/dsp/constants.hpp"
+#include "../../../common/dsp/notequeue.hpp"
 #include "../../../common/dsp/smoother.hpp"
 #include "../parameter.hpp"
 #include "fdnreverb.hpp"
@@ -30,14 +31,20 @@ public:
   }
 
   GlobalParameter param;
+  SmootherState<float> smootherState;
 
   void setup(double sampleRate);
   void reset();
   void startup();
   size_t getLatency();
   void setParameters();
+  template<typename Sample>
   void process(
-    const size_t length, const float *in0, const float *in1, float *out0, float *out1);
+    const size_t length,
+    const Sample *in0,
+    const Sample *in1,
+    Sample *out0,
+    Sample *out1);
   void noteOn(NoteInfo &info);
   void noteOff(int_fast32_t noteId);
 
@@ -55,28 +62,24 @@ public:
     note.id = noteId;
     note.pitch = pitch + tuning;
     note.velocity = velocity;
-    midiNotes.push_back(note);
+    if (!midiNotes.push(note) && !note.isNoteOn) noteOff(note.id);
   }
 
   void processMidiNote(size_t frame)
   {
-    while (true) {
-      auto it = std::find_if(midiNotes.begin(), midiNotes.end(), [&](const NoteInfo &nt) {
-        return nt.frame == frame;
-      });
-      if (it == std::end(midiNotes)) return;
-      if (it->isNoteOn)
-        noteOn(*it);
+    midiNotes.pop(frame, [&](NoteInfo &nt) {
+      if (nt.isNoteOn)
+        noteOn(nt);
       else
-        noteOff(it->id);
-      midiNotes.erase(it);
-    }
+        noteOff(nt.id);
+    });
   }
 
 private:
+  void updateFilterCutoff();
   void updateDelayTime();
 
-  std::vector<NoteInfo> midiNotes;
+  NoteQueue<NoteInfo> midiNotes;
   std::vector<NoteInfo> noteStack;
   float notePitchMultiplier = float(1);
 
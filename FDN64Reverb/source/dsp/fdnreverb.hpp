@@ -4,8 +4,11 @@
 #pragma once
 
 #include "../../../common/dsp/constants.hpp"
+#include "../../../common/dsp/paralleldelaybank.hpp"
 #include "../../../common/dsp/smoother.hpp"
 #include "../../../lib/pcg-cpp/pcg_random.hpp"
+#include "../../../common/dsp/blockfdn.hpp"
+#include "feedbackmatrix.hpp"
 #include "matrixtype.hpp"
 
 #include <algorithm>
@@ -51,44 +54,6 @@ public:
   }
 };
 
-template<typename Sample> class Delay {
-public:
-  int wptr = 0;
-  std::vector<Sample> buf;
-
-  void setup(Sample sampleRate, Sample maxTime)
-  {
-    auto &&size = size_t(sampleRate * maxTime) + 2;
-    buf.resize(size < 4 ? 4 : size);
-
-    reset();
-  }
-
-  void reset() { std::fill(buf.begin(), buf.end(), Sample(0)); }
-
-  Sample process(Sample input, Sample timeInSample)
-  {
-    const int bufSize = buf.size();
-
-    // Set delay time.
-    Sample clamped = std::clamp(timeInSample, Sample(0), Sample(bufSize - 1));
-    int timeInt = int(clamped);
-    Sample rFraction = clamped - Sample(timeInt);
-
-    int rptr0 = wptr - timeInt;
-    int rptr1 = rptr0 - 1;
-    if (rptr0 < 0) rptr0 += bufSize; // Unsigned negative overflow case.
-    if (rptr1 < 0) rptr1 += bufSize; // Unsigned negative overflow case.
-
-    // Write to buffer.
-    buf[wptr] = input;
-    if (++wptr >= bufSize) wptr = 0;
-
-    // Read from buffer.
-    return buf[rptr0] + rFraction * (buf[rptr1] - buf[rptr0]);
-  }
-};
-
 // Integer sample delay.
 template<typename Sample> class IntDelay {
 private:
@@ -271,17 +236,27 @@ public:
 If `length` is too long, compiler might silently fail to allocate stack.
 */
 template<typename Sample, size_t length> class FeedbackDelayNetwork {
+public:
+  static constexpr size_t maxBlockSize = 64;
+
 private:
   std::array<std::array<Sample, length>, length> matrix{};
-  std::array<std::array<Sample, length>, 2> buf{};
-  std::array<Delay<Sample>, length> delay;
+  FeedbackMatrix<Sample, length> feedbackMatrix;
+  BlockFdnBuffer<Sample, length, maxBlockSize> block;
+  ParallelDelayBank<Sample, length> delay;
   std::array<DoubleEMAFilterKp<Sample>, length> lowpass;
   std::array<EMAHighpass<Sample>, length> highpass;
 
+  // Split gain is computed at every `splitGainInterval` samples, and linearly
+  // interpolated in between.
+  static constexpr size_t splitGainInterval = 16;
   std::array<Sample, length> splitGain{};
+  std::array<Sample, length> splitGainTarget{};
+  std::array<Sample, length> splitGainDelta{};
+  size_t splitGainCounter = 0;
+  bool isSplitGainReset = true;
   size_t cycle = 100000;
   size_t counter = 0;
-  size_t bufIndex = 0;
 
 public:
   Sample rate = Sample(1);
@@ -430,6 +405,7 @@ public:
                                    : scale * squared[row] * squared[col];
       }
     }
+    feedbackMatrix.setHouseholder(scale, squared);
   }
 
   /**
@@ -600,7 +576,8 @@ public:
       dim && ((dim & (dim - 1)) == 0),
       "FeedbackDelayNetwork::constructHadamardSylvester(): dim must be power of 2.");
 
-    mat[0][0] = Sample(1) / std::sqrt(Sample(dim));
+    const auto scale = Sample(1) / std::sqrt(Sample(dim));
+    mat[0][0] = scale;
 
     size_t start = 1;
     size_t end = 2;
@@ -616,6 +593,7 @@ public:
       start *= 2;
       end *= 2;
     }
+    feedbackMatrix.setHadamard(scale);
   }
 
   /**
@@ -668,20 +646,29 @@ public:
     }
   }
 
+  /**
+  Circulant orthogonal and Hadamard set `feedbackMatrix` from their parameters, and return
+  early. Other types pass the dense `matrix` to `FeedbackMatrix::set`.
+  */
   void randomizeMatrix(unsigned matrixType, unsigned seed)
   {
     if (matrixType == FeedbackMatrixType::specialOrthogonal) {
       randomSpecialOrthogonal(seed, matrix);
     } else if (matrixType == FeedbackMatrixType::circulantOrthogonal) {
       randomCirculantOrthogonal(seed, length, matrix);
+      return;
     } else if (matrixType == FeedbackMatrixType::circulant4) {
       randomCirculantOrthogonal(seed, 4, matrix);
+      return;
     } else if (matrixType == FeedbackMatrixType::circulant8) {
       randomCirculantOrthogonal(seed, 8, matrix);
+      return;
     } else if (matrixType == FeedbackMatrixType::circulant16) {
       randomCirculantOrthogonal(seed, 16, matrix);
+      return;
     } else if (matrixType == FeedbackMatrixType::circulant32) {
       randomCirculantOrthogonal(seed, 32, matrix);
+      return;
     } else if (matrixType == FeedbackMatrixType::upperTriangularPositive) {
       randomUpperTriangular(seed, 0, Sample(1), matrix);
     } else if (matrixType == FeedbackMatrixType::upperTriangularNegative) {
@@ -700,16 +687,19 @@ public:
       randomAbsorbent(seed, Sample(-1), 0, matrix);
     } else if (matrixType == FeedbackMatrixType::hadamard) {
       constructHadamardSylvester(matrix);
+      return;
     } else if (matrixType == FeedbackMatrixType::conference) {
       constructConference(matrix);
     } else { // matrixType == FeedbackMatrixType::orthogonal, or default.
       randomOrthogonal(seed, matrix);
     }
+    feedbackMatrix.set(matrixType, matrix);
   }
 
   void setup(Sample sampleRate, Sample maxTime)
   {
-    for (auto &dl : delay) dl.setup(sampleRate, maxTime);
+    auto size = size_t(sampleRate * maxTime) + 2;
+    delay.setup(Sample(std::max(size, size_t(4)) - 1));
 
     lowpassKp.fill(Sample(1));
     highpassKp.fill(Sample(0.0006542843087824565)); // 5Hz cutoff when fs=48000Hz.
@@ -726,59 +716,165 @@ public:
 
   void reset()
   {
-    buf.fill({});
-    for (auto &dl : delay) dl.reset();
+    block.reset();
+    delay.reset();
     for (auto &lp : lowpass) lp.reset();
     for (auto &hp : highpass) hp.reset();
 
     counter = 0;
+    splitGainCounter = 0;
+    isSplitGainReset = true;
   }
 
   /**
   `offset` is normalized phase in [0, 1].
   `skew` >= 0.
   */
-  void fillSplitGain(Sample offset, Sample skew)
+  void fillSplitGain(std::array<Sample, length> &gain, Sample offset, Sample skew)
   {
-    for (size_t idx = 0; idx < splitGain.size(); ++idx) {
-      auto phase = offset + Sample(idx) / Sample(splitGain.size());
-      splitGain[idx] = std::exp(skew * std::sin(Sample(twopi) * phase));
+    for (size_t idx = 0; idx < length; ++idx) {
+      auto phase = offset + Sample(idx) / Sample(length);
+      gain[idx] = std::exp(skew * std::sin(Sample(twopi) * phase));
     }
-    auto sum = std::accumulate(splitGain.begin(), splitGain.end(), Sample(0));
-    for (auto &value : splitGain) value /= sum;
+    auto sum = std::accumulate(gain.begin(), gain.end(), Sample(0));
+    for (auto &value : gain) value /= sum;
   }
 
-  Sample preProcess(Sample splitPhaseOffset, Sample splitSkew)
+  /**
+  Advances the rotation of split gain by 1 sample.
+
+  At every `splitGainInterval` samples, the gain at the end of next interval is computed
+  as a target, assuming `splitPhaseOffset` and `splitSkew` stay the same. Sum of split
+  gain stays 1 while interpolating, because the sum of both ends are 1.
+  */
+  void updateSplitGain(Sample splitPhaseOffset, Sample splitSkew)
   {
     if (++counter >= cycle) counter = 0;
 
-    fillSplitGain(splitPhaseOffset + Sample(counter) / Sample(cycle), splitSkew);
+    if (isSplitGainReset) {
+      isSplitGainReset = false;
+      fillSplitGain(
+        splitGain, splitPhaseOffset + Sample(counter) / Sample(cycle), splitSkew);
+      return;
+    }
 
-    bufIndex ^= 1;
-    auto &front = buf[bufIndex];
-    auto &back = buf[bufIndex ^ 1];
-    front.fill(0);
-    for (size_t i = 0; i < length; ++i) {
-      for (size_t j = 0; j < length; ++j) front[i] += matrix[i][j] * back[j];
+    if (splitGainCounter == 0) {
+      splitGainCounter = splitGainInterval;
+      auto ahead = (counter + splitGainInterval - 1) % cycle;
+      auto phase = splitPhaseOffset + Sample(ahead) / Sample(cycle);
+      fillSplitGain(splitGainTarget, phase, splitSkew);
+      for (size_t idx = 0; idx < length; ++idx) {
+        splitGainDelta[idx]
+          = (splitGainTarget[idx] - splitGain[idx]) / Sample(splitGainInterval);
+      }
     }
+    --splitGainCounter;
+
+    if (splitGainCounter == 0) {
+      splitGain = splitGainTarget;
+    } else {
+      for (size_t idx = 0; idx < length; ++idx) splitGain[idx] += splitGainDelta[idx];
+    }
+  }
+
+  Sample preProcess(Sample splitPhaseOffset, Sample splitSkew)
+  {
+    updateSplitGain(splitPhaseOffset, splitSkew);
+
+    auto &front = block.mixed(0);
+    feedbackMatrix.process(block.last(), front);
     return std::accumulate(front.begin(), front.end(), Sample(0));
   }
 
   Sample process(Sample input, Sample crossIn, Sample stereoCross, Sample feedback)
   {
-    auto &front = buf[bufIndex];
+    auto &front = block.mixed(0);
+    auto &back = block.last();
 
     crossIn /= -Sample(length);
+    std::array<Sample, length> time;
     for (size_t idx = 0; idx < length; ++idx) {
       auto crossed = front[idx] + stereoCross * (crossIn - front[idx]);
-      auto sig = splitGain[idx] * input + feedback * crossed;
-      auto delayed = delay[idx].process(sig, delayTimeSample[idx].process(rate));
-      auto lowpassed = lowpass[idx].process(delayed, lowpassKp[idx]);
-      front[idx] = highpass[idx].process(lowpassed, highpassKp[idx]);
+      back[idx] = splitGain[idx] * input + feedback * crossed;
+      time[idx] = delayTimeSample[idx].process(rate);
     }
 
-    return std::accumulate(front.begin(), front.end(), Sample(0));
+    delay.process(back, time);
+
+    for (size_t idx = 0; idx < length; ++idx) {
+      auto lowpassed = lowpass[idx].process(back[idx], lowpassKp[idx]);
+      back[idx] = highpass[idx].process(lowpassed, highpassKp[idx]);
+    }
+
+    return std::accumulate(back.begin(), back.end(), Sample(0));
+  }
+
+  /**
+  Returns the number of frames that can be processed as a block, or 0 when the shortest
+  delay is too short. Block processing goes as following:
+
+  1. Call `readFrame` for each frame.
+  2. Call `multiplyBlock`.
+  3. Call `writeFrame` for each frame. `crossIn` is from `getMixedSum` of other channel.
+  4. Call `finishBlock`.
+
+  The result is the same as calling `preProcess` and `process` for each frame. See
+  `BlockFdnBuffer` for details.
+  */
+  size_t getBlockSize(size_t maxFrames)
+  {
+    auto minTime = std::numeric_limits<Sample>::max();
+    for (auto &time : delayTimeSample) minTime = std::min(minTime, time.getValue());
+    return block.blockSize(minTime, rate, maxFrames);
+  }
+
+  Sample readFrame(size_t frame)
+  {
+    std::array<Sample, length> time;
+    for (size_t idx = 0; idx < length; ++idx) {
+      time[idx] = delayTimeSample[idx].process(rate);
+    }
+
+    auto &out = block.output(frame);
+    delay.read(frame, time, out);
+
+    for (size_t idx = 0; idx < length; ++idx) {
+      auto lowpassed = lowpass[idx].process(out[idx], lowpassKp[idx]);
+      out[idx] = highpass[idx].process(lowpassed, highpassKp[idx]);
+    }
+    return std::accumulate(out.begin(), out.end(), Sample(0));
+  }
+
+  void multiplyBlock(size_t nFrame) { block.multiply(feedbackMatrix, nFrame); }
+
+  Sample getMixedSum(size_t frame)
+  {
+    auto &mixed = block.mixed(frame);
+    return std::accumulate(mixed.begin(), mixed.end(), Sample(0));
   }
+
+  void writeFrame(
+    size_t frame,
+    Sample splitPhaseOffset,
+    Sample splitSkew,
+    Sample input,
+    Sample crossIn,
+    Sample stereoCross,
+    Sample feedback)
+  {
+    updateSplitGain(splitPhaseOffset, splitSkew);
+
+    auto &mixed = block.mixed(frame);
+    crossIn /= -Sample(length);
+    std::array<Sample, length> sig;
+    for (size_t idx = 0; idx < length; ++idx) {
+      auto crossed = mixed[idx] + stereoCross * (crossIn - mixed[idx]);
+      sig[idx] = splitGain[idx] * input + feedback * crossed;
+    }
+    delay.write(sig);
+  }
+
+  void finishBlock(size_t nFrame) { block.finish(nFrame); }
 };
 
 } // namespace SomeDSP
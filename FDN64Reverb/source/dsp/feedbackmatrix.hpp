@@ -0,0 +1,182 @@
+// SPDX-License-Identifier: GPL-3.0-only
+// Copyright Takamitsu Endo (ryukau@gmail.com)
+
+#pragma once
+
+#include "../../../common/dsp/blockfdn.hpp"
+#include "matrixtype.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+namespace SomeDSP {
+
+/**
+Multiplies feedback matrix to a vector, using the structure of each `FeedbackMatrixType`.
+
+`set()` takes a dense matrix built by `FeedbackDelayNetwork`, and extracts the values
+that a kernel needs. Circulant orthogonal and Hadamard are instead given by
+`setHouseholder()` and `setHadamard()` from their parameters, because recovering them from
+rounded matrix elements loses precision. Kernels are following:
+
+- Hadamard: Fast Walsh-Hadamard transform. O(N log N).
+- Circulant orthogonal: `s * q * q^T - I`, which is a rank 1 update of identity. O(N).
+- Schroeder: Diagonal except last 2 rows. O(N).
+- Absorbent: Top half is `A * (x2 - G * x1)`, and bottom half is diagonal. O(N^2 / 4).
+- Others: Dense. O(N^2).
+
+Dense kernel stores the matrix in column major order for `multiplyColumnMajor`.
+Triangular matrices also use dense kernel, because skipping zeros breaks the
+vectorization and becomes slower.
+*/
+template<typename Sample, size_t length> class FeedbackMatrix {
+  static_assert(
+    length >= 2 && (length & (length - 1)) == 0,
+    "FeedbackMatrix: length must be power of 2.");
+
+public:
+  using Matrix = std::array<std::array<Sample, length>, length>;
+
+private:
+  enum class Kernel {
+    dense,
+    schroeder,
+    absorbent,
+    householder,
+    hadamard,
+  };
+
+  static constexpr size_t half = length / 2;
+
+  Kernel kernel = Kernel::dense;
+  Matrix column{}; // column[j][i] is the element at i-th row and j-th column.
+  std::array<Sample, length> diag{};
+  std::array<Sample, length> work{};
+  Sample scale = Sample(1);
+
+  void fromDense(const Matrix &mat)
+  {
+    for (size_t row = 0; row < length; ++row) {
+      for (size_t col = 0; col < length; ++col) column[col][row] = mat[row][col];
+    }
+  }
+
+public:
+  void set(unsigned matrixType, const Matrix &mat)
+  {
+    using namespace FeedbackMatrixType;
+
+    switch (matrixType) {
+      case schroederPositive:
+      case schroederNegative: {
+        kernel = Kernel::schroeder;
+        for (size_t i = 0; i < length; ++i) diag[i] = mat[i][i];
+        column[0] = mat[length - 2]; // Last 2 rows are stored as is.
+        column[1] = mat[length - 1];
+      } break;
+
+      case absorbentPositive:
+      case absorbentNegative: {
+        // `diag` holds `G` in first half, and `I - G^2` in second half.
+        kernel = Kernel::absorbent;
+        fromDense(mat);
+        for (size_t i = 0; i < half; ++i) {
+          diag[i] = mat[half + i][half + i];
+          diag[half + i] = mat[half + i][i];
+        }
+      } break;
+
+      default: { // `orthogonal`, `specialOrthogonal`, triangulars, `conference`.
+        kernel = Kernel::dense;
+        fromDense(mat);
+      } break;
+    }
+  }
+
+  // `s * q * q^T - I`. `vector` is `q`, and `diag` holds it as is.
+  void setHouseholder(Sample s, const std::array<Sample, length> &vector)
+  {
+    kernel = Kernel::householder;
+    scale = s;
+    diag = vector;
+  }
+
+  // Walsh-Hadamard transform multiplied by `s`.
+  void setHadamard(Sample s)
+  {
+    kernel = Kernel::hadamard;
+    scale = s;
+  }
+
+  void process(const std::array<Sample, length> &x, std::array<Sample, length> &y)
+  {
+    switch (kernel) {
+      default:
+      case Kernel::dense: {
+        multiplyColumnMajor(column, &x, &y, 1);
+      } break;
+
+      case Kernel::schroeder: {
+        Sample sum0 = 0;
+        Sample sum1 = 0;
+        for (size_t i = 0; i < length; ++i) {
+          sum0 += column[0][i] * x[i];
+          sum1 += column[1][i] * x[i];
+        }
+        for (size_t i = 0; i < length - 2; ++i) y[i] = diag[i] * x[i];
+        y[length - 2] = sum0;
+        y[length - 1] = sum1;
+      } break;
+
+      case Kernel::absorbent: {
+        for (size_t i = 0; i < half; ++i) work[i] = x[half + i] - diag[i] * x[i];
+        for (size_t i = 0; i < half; ++i) {
+          y[half + i] = diag[half + i] * x[i] + diag[i] * x[half + i];
+        }
+        std::array<Sample, half> sum{};
+        for (size_t j = 0; j < half; ++j) {
+          const auto &cl = column[half + j];
+          const auto wj = work[j];
+          for (size_t i = 0; i < half; ++i) sum[i] += cl[i] * wj;
+        }
+        std::copy(sum.begin(), sum.end(), y.begin());
+      } break;
+
+      case Kernel::householder: {
+        Sample dot = 0;
+        for (size_t i = 0; i < length; ++i) dot += diag[i] * x[i];
+        dot *= scale;
+        for (size_t i = 0; i < length; ++i) y[i] = diag[i] * dot - x[i];
+      } break;
+
+      case Kernel::hadamard: {
+        y = x;
+        for (size_t width = 1; width < length; width *= 2) {
+          for (size_t start = 0; start < length; start += 2 * width) {
+            for (size_t i = start; i < start + width; ++i) {
+              auto a = y[i];
+              auto b = y[i + width];
+              y[i] = a + b;
+              y[i + width] = a - b;
+            }
+          }
+        }
+        for (auto &value : y) value *= scale;
+      } break;
+    }
+  }
+
+  // Processes `nFrame` frames. Dense kernel is done as matrix-matrix product.
+  void process(
+    const std::array<Sample, length> *x, std::array<Sample, length> *y, size_t nFrame)
+  {
+    if (kernel == Kernel::dense) {
+      multiplyColumnMajor(column, x, y, nFrame);
+      return;
+    }
+    for (size_t k = 0; k < nFrame; ++k) process(x[k], y[k]);
+  }
+};
+
+} // namespace SomeDSP
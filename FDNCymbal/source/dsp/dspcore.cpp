@@ -22,9 +22,11 @@ DSPCore::DSPCore() { midiNotes.reserve(128); }
 
 void DSPCore::setup(double sampleRate)
 {
+  SmootherCommon<float>::Scope smootherScope(smootherState);
+
   this->sampleRate = float(sampleRate);
 
-  midiNotes.resize(0);
+  midiNotes.clear();
 
   SmootherCommon<float>::setSampleRate(this->sampleRate);
   SmootherCommon<float>::setTime(0.01f);
@@ -53,6 +55,8 @@ void DSPCore::setup(double sampleRate)
 
 void DSPCore::reset()
 {
+  SmootherCommon<float>::Scope smootherScope(smootherState);
+
   using ID = ParameterID::ID;
 
   pulsar.reset();
@@ -104,6 +108,8 @@ void DSPCore::reset()
 
 void DSPCore::startup()
 {
+  SmootherCommon<float>::Scope smootherScope(smootherState);
+
   rng.seed = param.value[ParameterID::seed]->getInt();
   rngStick.seed = 0;
   rngTremolo.seed = 0;
@@ -116,6 +122,8 @@ void DSPCore::startup()
 
 void DSPCore::setParameters()
 {
+  SmootherCommon<float>::Scope smootherScope(smootherState);
+
   using ID = ParameterID::ID;
 
   SmootherCommon<float>::setTime(param.value[ID::smoothness]->getFloat());
@@ -154,9 +162,11 @@ void DSPCore::setParameters()
     param.value[ID::allpass2HighpassCutoff]->getFloat(), highpassQ);
 }
 
+template<typename Sample>
 void DSPCore::process(
-  const size_t length, const float *in0, const float *in1, float *out0, float *out1)
+  const size_t length, const Sample *in0, const Sample *in1, Sample *out0, Sample *out1)
 {
+  SmootherCommon<float>::Scope smootherScope(smootherState);
   ScopedNoDenormals scopedDenormals;
 
   SmootherCommon<float>::setBufferSize(float(length));
@@ -241,8 +251,15 @@ void DSPCore::process(
   }
 }
 
+template void DSPCore::process<float>(
+  const size_t length, const float *in0, const float *in1, float *out0, float *out1);
+template void DSPCore::process<double>(
+  const size_t length, const double *in0, const double *in1, double *out0, double *out1);
+
 void DSPCore::noteOn(int32_t noteId, int16_t pitch, float tuning, float velocity)
 {
+  SmootherCommon<float>::Scope smootherScope(smootherState);
+
   NoteInfo info;
   info.id = noteId;
   info.frequency = midiNoteToFrequency(pitch, tuning);
@@ -325,6 +342,8 @@ void DSPCore::noteOn(int32_t noteId, int16_t pitch, float tuning, float velocity
 
 void DSPCore::noteOff(int32_t noteId)
 {
+  SmootherCommon<float>::Scope smootherScope(smootherState);
+
   auto it = std::find_if(noteStack.begin(), noteStack.end(), [&](const NoteInfo &info) {
     return info.id == noteId;
   });
@@ -27,6 +27,8 @@ template<typename T> inline T addAsymmetry(T value, T asym)
 
 void DSPCore::setup(double sampleRate)
 {
+  SmootherCommon<double>::Scope smootherScope(smootherState);
+
   this->sampleRate = double(sampleRate);
 
   reset();
@@ -80,6 +82,8 @@ void DSPCore::updateUpRate()
 
 void DSPCore::reset()
 {
+  SmootherCommon<double>::Scope smootherScope(smootherState);
+
   oversampling = param.value[ParameterID::ID::oversampling]->getInt();
   updateUpRate();
 
@@ -118,6 +122,8 @@ void DSPCore::startup() {}
 
 void DSPCore::setParameters()
 {
+  SmootherCommon<double>::Scope smootherScope(smootherState);
+
   size_t newOversampling = param.value[ParameterID::ID::oversampling]->getInt();
   if (oversampling != newOversampling) {
     oversampling = newOversampling;
@@ -214,23 +220,25 @@ std::array<double, 2> DSPCore::processFrame(
   };
 }
 
+template<typename Sample>
 void DSPCore::process(
   const size_t length,
-  const float *in0,
-  const float *in1,
-  const float *in2,
-  const float *in3,
-  float *out0,
-  float *out1)
+  const Sample *in0,
+  const Sample *in1,
+  const Sample *in2,
+  const Sample *in3,
+  Sample *out0,
+  Sample *out1)
 {
+  SmootherCommon<double>::Scope smootherScope(smootherState);
   ScopedNoDenormals scopedDenormals;
 
   using ID = ParameterID::ID;
   const auto &pv = param.value;
 
   bool enableSidechain = pv[ID::modSideChain]->getInt();
-  const float *side0 = enableSidechain ? in2 : in0;
-  const float *side1 = enableSidechain ? in3 : in1;
+  const Sample *side0 = enableSidechain ? in2 : in0;
+  const Sample *side1 = enableSidechain ? in3 : in1;
 
   SmootherCommon<double>::setBufferSize(double(length));
 
@@ -297,8 +305,27 @@ void DSPCore::process(
   if (tooMuchFeedback) pv[ID::tooMuchFeedback]->setFromInt(1);
 }
 
+template void DSPCore::process<float>(
+  const size_t length,
+  const float *in0,
+  const float *in1,
+  const float *in2,
+  const float *in3,
+  float *out0,
+  float *out1);
+template void DSPCore::process<double>(
+  const size_t length,
+  const double *in0,
+  const double *in1,
+  const double *in2,
+  const double *in3,
+  double *out0,
+  double *out1);
+
 void DSPCore::noteOn(NoteInfo &info)
 {
+  SmootherCommon<double>::Scope smootherScope(smootherState);
+
   using ID = ParameterID::ID;
   auto &pv = param.value;
 
@@ -312,6 +339,8 @@ void DSPCore::noteOn(NoteInfo &info)
 
 void DSPCore::noteOff(int_fast32_t noteId)
 {
+  SmootherCommon<double>::Scope smootherScope(smootherState);
+
   using ID = ParameterID::ID;
   auto &pv = param.value;
 
@@ -8,15 +8,17 @@
 #include <algorithm>
 #include <numeric>
 
-inline float maxAbs(const size_t length, const float *buffer)
+template<typename Sample> inline Sample maxAbs(const size_t length, const Sample *buffer)
 {
-  float max = 0.0f;
+  Sample max = 0;
   for (size_t i = 0; i < length; ++i) max = std::max(max, std::fabs(buffer[i]));
   return max;
 }
 
 void DSPCore::setup(double sampleRate)
 {
+  SmootherCommon<float>::Scope smootherScope(smootherState);
+
   this->sampleRate = float(sampleRate);
 
   SmootherCommon<float>::setSampleRate(this->sampleRate);
@@ -40,6 +42,8 @@ void DSPCore::setup(double sampleRate)
 
 void DSPCore::reset()
 {
+  SmootherCommon<float>::Scope smootherScope(smootherState);
+
   ASSIGN_PARAMETER(reset);
 
   for (auto &shpr : shaper) shpr.reset();
@@ -51,6 +55,8 @@ void DSPCore::startup() {}
 
 size_t DSPCore::getLatency()
 {
+  SmootherCommon<float>::Scope smootherScope(smootherState);
+
   auto &&latency = activateLimiter ? limiter[0].latency() : 0;
   latency += oversample ? shaper[0].latency() : 0;
   return latency;
@@ -58,6 +64,8 @@ size_t DSPCore::getLatency()
 
 void DSPCore::setParameters()
 {
+  SmootherCommon<float>::Scope smootherScope(smootherState);
+
   ASSIGN_PARAMETER(push);
 
   activateLimiter = pv[ID::limiter]->getInt();
@@ -68,9 +76,11 @@ void DSPCore::setParameters()
   }
 }
 
+template<typename Sample>
 void DSPCore::process(
-  const size_t length, const float *in0, const float *in1, float *out0, float *out1)
+  const size_t length, const Sample *in0, const Sample *in1, Sample *out0, Sample *out1)
 {
+  SmootherCommon<float>::Scope smootherScope(smootherState);
   ScopedNoDenormals scopedDenormals;
 
   SmootherCommon<float>::setBufferSize(float(length));
@@ -107,3 +117,8 @@ void DSPCore::process(
     out1[i] = frame[1];
   }
 }
+
+template void DSPCore::process<float>(
+  const size_t length, const float *in0, const float *in1, float *out0, float *out1);
+template void DSPCore::process<double>(
+  const size_t length, const double *in0, const double *in1, double *out0, double *out1);
@@ -115,6 +115,8 @@ inline double pitchRatio(double pitch, double spread, double rndCent, Rng &rng)
 
 void DSPCore::setup(double sampleRate)
 {
+  SmootherCommon<double>::Scope smootherScope(smootherState);
+
   noteStack.reserve(1024);
   noteStack.resize(0);
 
@@ -260,6 +262,8 @@ void DSPCore::resetCollision()
 
 void DSPCore::reset()
 {
+  SmootherCommon<double>::Scope smootherScope(smootherState);
+
   noteNumber = 57.0;
   velocity = 0;
 
@@ -305,6 +309,8 @@ void DSPCore::reset()
 
 void DSPCore::startup()
 {
+  SmootherCommon<double>::Scope smootherScope(smootherState);
+
   using ID = ParameterID::ID;
   const auto &pv = param.value;
   noiseRng.seed(pv[ID::seed]->getInt());
@@ -313,6 +319,8 @@ void DSPCore::startup()
 
 void DSPCore::setParameters()
 {
+  SmootherCommon<double>::Scope smootherScope(smootherState);
+
   size_t newOverSampling = param.value[ParameterID::ID::overSampling]->getInt();
   if (overSampling != newOverSampling) {
     overSampling = newOverSampling;
@@ -472,9 +480,11 @@ std::array<double, 2> DSPCore::processFrame(const std::array<double, 2> &externa
   };
 }
 
+template<typename Sample>
 void DSPCore::process(
-  const size_t length, const float *in0, const float *in1, float *out0, float *out1)
+  const size_t length, const Sample *in0, const Sample *in1, Sample *out0, Sample *out1)
 {
+  SmootherCommon<double>::Scope smootherScope(smootherState);
   ScopedNoDenormals scopedDenormals;
 
   using ID = ParameterID::ID;
@@ -556,8 +566,15 @@ void DSPCore::process(
   if (isSecondaryCollided) pv[ID::isSecondaryCollided]->setFromInt(1);
 }
 
+template void DSPCore::process<float>(
+  const size_t length, const float *in0, const float *in1, float *out0, float *out1);
+template void DSPCore::process<double>(
+  const size_t length, const double *in0, const double *in1, double *out0, double *out1);
+
 void DSPCore::noteOn(NoteInfo &info)
 {
+  SmootherCommon<double>::Scope smootherScope(smootherState);
+
   using ID = ParameterID::ID;
   auto &pv = param.value;
 
@@ -609,6 +626,8 @@ void DSPCore::noteOn(NoteInfo &info)
 
 void DSPCore::noteOff(int_fast32_t noteId)
 {
+  SmootherCommon<double>::Scope smootherScope(smootherState);
+
   using ID = ParameterID::ID;
   auto &pv = param.value;
 
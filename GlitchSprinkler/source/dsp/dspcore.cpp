@@ -13,6 +13,8 @@
 
 void DSPCore::setup(double sampleRate_)
 {
+  SmootherCommon<double>::Scope smootherScope(smootherState);
+
   activeNote.reserve(1024);
   activeNote.resize(0);
 
@@ -145,6 +147,8 @@ void Voice::reset()
 
 void DSPCore::reset()
 {
+  SmootherCommon<double>::Scope smootherScope(smootherState);
+
   ASSIGN_PARAMETER_CORE(reset);
 
   previousBeatsElapsed = 0;
@@ -154,8 +158,8 @@ void DSPCore::reset()
   polynomial.updateCoefficients(true);
   isPolynomialUpdated = true;
 
-  modifierNotes.resize(0);
-  midiNotes.resize(0);
+  modifierNotes.clear();
+  midiNotes.clear();
   activeNote.resize(0);
   activeModifier.resize(0);
   noteIndices.resize(0);
@@ -170,6 +174,8 @@ void DSPCore::reset()
 
 void DSPCore::startup()
 {
+  SmootherCommon<double>::Scope smootherScope(smootherState);
+
   using ID = ParameterID::ID;
   const auto &pv = param.value;
 
@@ -180,6 +186,8 @@ void Voice::setParameters() { ASSIGN_PARAMETER_VOICE(push); }
 
 void DSPCore::setParameters()
 {
+  SmootherCommon<double>::Scope smootherScope(smootherState);
+
   ASSIGN_PARAMETER_CORE(push);
 
   for (auto &x : voices) x.setParameters();
@@ -298,6 +306,7 @@ std::array<double, 2> Voice::processFrame()
 
 void DSPCore::process(const size_t length, float *out0, float *out1)
 {
+  SmootherCommon<double>::Scope smootherScope(smootherState);
   ScopedNoDenormals scopedDenormals;
 
   using ID = ParameterID::ID;
@@ -342,6 +351,8 @@ void DSPCore::process(const size_t length, float *out0, float *out1)
 
 void DSPCore::noteOn(NoteInfo &info)
 {
+  SmootherCommon<double>::Scope smootherScope(smootherState);
+
   using ID = ParameterID::ID;
   auto &pv = param.value;
 
@@ -700,6 +711,8 @@ void Voice::updateNote()
 
 void DSPCore::noteOff(int_fast32_t noteId)
 {
+  SmootherCommon<double>::Scope smootherScope(smootherState);
+
   using ID = ParameterID::ID;
   auto &pv = param.value;
 
@@ -5,6 +5,7 @@
 
 #include "../../../common/dsp/constants.hpp"
 #include "../../../common/dsp/multirate.hpp"
+#include "../../../common/dsp/notequeue.hpp"
 #include "../../../common/dsp/smoother.hpp"
 #include "../parameter.hpp"
 #include "polynomial.hpp"
@@ -92,6 +93,7 @@ public:
   };
 
   GlobalParameter param;
+  SmootherState<double> smootherState;
 
   double sampleRate = 48000.0;
 
@@ -132,8 +134,8 @@ public:
   // Maybe make it possible to change the pitch modifier channel.
   static constexpr size_t pitchModifierChannel = 15;
 
-  std::vector<NoteInfo> modifierNotes;
-  std::vector<NoteInfo> midiNotes;
+  NoteQueue<NoteInfo> modifierNotes;
+  NoteQueue<NoteInfo> midiNotes;
   std::vector<NoteInfo> activeNote;
   std::vector<NoteInfo> activeModifier;
   std::vector<size_t> noteIndices;
@@ -186,27 +188,22 @@ public:
     note.velocity = velocity;
 
     if (note.channel == pitchModifierChannel) {
-      modifierNotes.push_back(note);
+      if (!modifierNotes.push(note) && !note.isNoteOn) modNoteOff(note.id);
     } else {
-      midiNotes.push_back(note);
+      if (!midiNotes.push(note) && !note.isNoteOn) noteOff(note.id);
     }
   }
 
-#define DEFINE_NOTE_PROC_FUNC(FUNC_NAME, VECTOR, ON_FUNC, OFF_FUNC)                      \
+#define DEFINE_NOTE_PROC_FUNC(FUNC_NAME, QUEUE, ON_FUNC, OFF_FUNC)                       \
   void FUNC_NAME(size_t frame)                                                           \
   {                                                                                      \
-    while (true) {                                                                       \
-      auto it = std::find_if(VECTOR.begin(), VECTOR.end(), [&](const NoteInfo &nt) {     \
-        return nt.frame == frame;                                                        \
-      });                                                                                \
-      if (it == std::end(VECTOR)) return;                                                \
-      if (it->isNoteOn) {                                                                \
-        ON_FUNC(*it);                                                                    \
+    QUEUE.pop(frame, [&](NoteInfo &nt) {                                                 \
+      if (nt.isNoteOn) {                                                                 \
+        ON_FUNC(nt);                                                                     \
       } else {                                                                           \
-        OFF_FUNC(it->id);                                                                \
+        OFF_FUNC(nt.id);                                                                 \
       }                                                                                  \
-      VECTOR.erase(it);                                                                  \
-    }                                                                                    \
+    });                                                                                  \
   }
 
   DEFINE_NOTE_PROC_FUNC(processMidiNote, midiNotes, noteOn, noteOff);
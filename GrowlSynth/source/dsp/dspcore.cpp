@@ -23,6 +23,8 @@ inline double calcPitch(double semitone, double equalTemperament = 12.0)
 
 void DSPCore::setup(double sampleRate)
 {
+  SmootherCommon<double>::Scope smootherScope(smootherState);
+
   noteStack.reserve(1024);
   noteStack.resize(0);
 
@@ -98,6 +100,8 @@ void DSPCore::setup(double sampleRate)
 
 void DSPCore::reset()
 {
+  SmootherCommon<double>::Scope smootherScope(smootherState);
+
   ASSIGN_PARAMETER(reset);
 
   startup();
@@ -120,6 +124,8 @@ void DSPCore::startup() { rng.seed(0); }
 
 void DSPCore::setParameters()
 {
+  SmootherCommon<double>::Scope smootherScope(smootherState);
+
   ASSIGN_PARAMETER(push);
   ASSIGN_MOD_COMB_PARAMETER(push);
 }
@@ -167,6 +173,7 @@ double DSPCore::processSample()
 
 void DSPCore::process(const size_t length, float *out0, float *out1)
 {
+  SmootherCommon<double>::Scope smootherScope(smootherState);
   ScopedNoDenormals scopedDenormals;
 
   using ID = ParameterID::ID;
@@ -199,6 +206,8 @@ void DSPCore::process(const size_t length, float *out0, float *out1)
 
 void DSPCore::noteOn(NoteInfo &info)
 {
+  SmootherCommon<double>::Scope smootherScope(smootherState);
+
   using ID = ParameterID::ID;
   auto &pv = param.value;
 
@@ -248,6 +257,8 @@ void DSPCore::noteOn(NoteInfo &info)
 
 void DSPCore::noteOff(int_fast32_t noteId)
 {
+  SmootherCommon<double>::Scope smootherScope(smootherState);
+
   using ID = ParameterID::ID;
   auto &pv = param.value;
 
@@ -7,8 +7,23 @@
 
 #include "dspcore.hpp"
 
-#define NOTE_NAME Note_FixedInstruction
-#define DSPCORE_NAME DSPCore_FixedInstruction
+#if defined(UHHYOU_INSTRSET_AVX512)
+  #define NOTE_NAME Note_AVX512
+  #define DSPCORE_NAME DSPCore_AVX512
+  #define DSPCORE_FACTORY createDSPCore_AVX512
+#elif defined(UHHYOU_INSTRSET_AVX2)
+  #define NOTE_NAME Note_AVX2
+  #define DSPCORE_NAME DSPCore_AVX2
+  #define DSPCORE_FACTORY createDSPCore_AVX2
+#elif defined(UHHYOU_INSTRSET_AVX)
+  #define NOTE_NAME Note_AVX
+  #define DSPCORE_NAME DSPCore_AVX
+  #define DSPCORE_FACTORY createDSPCore_AVX
+#else
+  #define NOTE_NAME Note_FixedInstruction
+  #define DSPCORE_NAME DSPCore_FixedInstruction
+  #define DSPCORE_FACTORY createDSPCore_FixedInstruction
+#endif
 
 inline float clamp(float value, float min, float max)
 {
@@ -194,9 +209,11 @@ DSPCORE_NAME::DSPCORE_NAME() { midiNotes.reserve(128); }
 
 void DSPCORE_NAME::setup(double sampleRate)
 {
+  SmootherCommon<float>::Scope smootherScope(smootherState);
+
   this->sampleRate = float(sampleRate);
 
-  midiNotes.resize(0);
+  midiNotes.clear();
 
   SmootherCommon<float>::setSampleRate(this->sampleRate);
   SmootherCommon<float>::setTime(0.04f);
@@ -217,6 +234,8 @@ void DSPCORE_NAME::setup(double sampleRate)
 
 void DSPCORE_NAME::reset()
 {
+  SmootherCommon<float>::Scope smootherScope(smootherState);
+
   using ID = ParameterID::ID;
 
   SmootherCommon<float>::setTime(param.value[ID::smoothness]->getFloat());
@@ -257,6 +276,8 @@ void DSPCORE_NAME::startup() { rng.seed = param.value[ParameterID::seed]->getInt
 
 void DSPCORE_NAME::setParameters()
 {
+  SmootherCommon<float>::Scope smootherScope(smootherState);
+
   using ID = ParameterID::ID;
 
   SmootherCommon<float>::setTime(param.value[ID::smoothness]->getFloat());
@@ -292,6 +313,7 @@ void DSPCORE_NAME::setParameters()
 
 void DSPCORE_NAME::process(const size_t length, float *out0, float *out1)
 {
+  SmootherCommon<float>::Scope smootherScope(smootherState);
   ScopedNoDenormals scopedDenormals;
 
   SmootherCommon<float>::setBufferSize(float(length));
@@ -337,6 +359,8 @@ void DSPCORE_NAME::process(const size_t length, float *out0, float *out1)
 
 void DSPCORE_NAME::noteOn(int32_t noteId, int16_t pitch, float tuning, float velocity)
 {
+  SmootherCommon<float>::Scope smootherScope(smootherState);
+
   size_t noteIdx = 0;
   size_t mostSilent = 0;
   float gain = 1.0f;
@@ -383,7 +407,14 @@ void DSPCORE_NAME::noteOn(int32_t noteId, int16_t pitch, float tuning, float vel
 
 void DSPCORE_NAME::noteOff(int32_t noteId)
 {
+  SmootherCommon<float>::Scope smootherScope(smootherState);
+
   for (auto &x : notes) {
     if (x.id == noteId && x.state != NoteState::release) x.release();
   }
 }
+
+std::unique_ptr<DSPInterface> DSPCORE_FACTORY()
+{
+  return std::make_unique<DSPCORE_NAME>();
+}
@@ -4,6 +4,7 @@
 #pragma once
 
 #include "../../../common/dsp/constants.hpp"
+#include "../../../common/dsp/notequeue.hpp"
 #include "../../../common/dsp/smoother.hpp"
 #include "../parameter.hpp"
 #include "delay.hpp"
@@ -13,6 +14,7 @@
 
 #include <array>
 #include <cmath>
+#include <memory>
 
 using namespace SomeDSP;
 using namespace Steinberg::Synth;
@@ -62,6 +64,7 @@ public:
 
   static const size_t maxVoice = 32;
   GlobalParameter param;
+  SmootherState<float> smootherState;
 
   virtual void setup(double sampleRate) = 0;
   virtual void reset() = 0;   // Stop sounds.
@@ -80,7 +83,7 @@ public:
     float velocity;
   };
 
-  std::vector<MidiNote> midiNotes;
+  NoteQueue<MidiNote> midiNotes;
 
   virtual void pushMidiNote(
     bool isNoteOn,
@@ -127,23 +130,17 @@ mpt stands for Max Poly Transition. I guess this sounds weird for English native
       note.pitch = pitch;                                                                \
       note.tuning = tuning;                                                              \
       note.velocity = velocity;                                                          \
-      midiNotes.push_back(note);                                                         \
+      if (!midiNotes.push(note) && !note.isNoteOn) noteOff(note.id);                     \
     }                                                                                    \
                                                                                          \
     void processMidiNote(uint32_t frame) override                                        \
     {                                                                                    \
-      while (true) {                                                                     \
-        auto it                                                                          \
-          = std::find_if(midiNotes.begin(), midiNotes.end(), [&](const MidiNote &nt) {   \
-              return nt.frame == frame;                                                  \
-            });                                                                          \
-        if (it == std::end(midiNotes)) return;                                           \
-        if (it->isNoteOn)                                                                \
-          noteOn(it->id, it->pitch, it->tuning, it->velocity);                           \
+      midiNotes.pop(frame, [&](MidiNote &nt) {                                           \
+        if (nt.isNoteOn)                                                                 \
+          noteOn(nt.id, nt.pitch, nt.tuning, nt.velocity);                               \
         else                                                                             \
-          noteOff(it->id);                                                               \
-        midiNotes.erase(it);                                                             \
-      }                                                                                  \
+          noteOff(nt.id);                                                                \
+      });                                                                                \
     }                                                                                    \
                                                                                          \
   private:                                                                               \
@@ -166,5 +163,23 @@ mpt stands for Max Poly Transition. I guess this sounds weird for English native
     size_t mptStop = 0;                                                                  \
   };
 
+#if defined(UHHYOU_INSTRSET_AVX512)
+NOTE_CLASS(AVX512)
+DSPCORE_CLASS(AVX512)
+#elif defined(UHHYOU_INSTRSET_AVX2)
+NOTE_CLASS(AVX2)
+DSPCORE_CLASS(AVX2)
+#elif defined(UHHYOU_INSTRSET_AVX)
+NOTE_CLASS(AVX)
+DSPCORE_CLASS(AVX)
+#else
 NOTE_CLASS(FixedInstruction)
 DSPCORE_CLASS(FixedInstruction)
+#endif
+
+// Defined in `dspcore.cpp`. Only the instruction sets compiled into the binary are
+// linked.
+UHHYOU_DSPCORE_EXPORT std::unique_ptr<DSPInterface> createDSPCore_AVX512();
+UHHYOU_DSPCORE_EXPORT std::unique_ptr<DSPInterface> createDSPCore_AVX2();
+UHHYOU_DSPCORE_EXPORT std::unique_ptr<DSPInterface> createDSPCore_AVX();
+UHHYOU_DSPCORE_EXPORT std::unique_ptr<DSPInterface> createDSPCore_FixedInstruction();
@@ -10,6 +10,8 @@
 
 #include "public.sdk/source/vst/vstaudioeffect.h"
 
+#include "../../common/automationdispatcher.hpp"
+#include "../../common/silencedetector.hpp"
 #include "dsp/dspcore.hpp"
 
 #include <memory>
@@ -41,10 +43,12 @@ public:
     return (Vst::IAudioProcessor *)new PlugProcessor();
   }
 
-  void handleEvent(Vst::ProcessData &data);
+  void handleEvent(const Vst::Event &event);
 
 protected:
   uint64_t lastState = 0;
+  AutomationDispatcher automation;
+  SilenceDetector silence;
   std::unique_ptr<DSPInterface> dsp;
 };
 
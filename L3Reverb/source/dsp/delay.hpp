@@ -4,16 +4,18 @@
 #pragma once
 
 #include "../../../common/dsp/constants.hpp"
+#include "../../../common/dsp/delayarena.hpp"
 #include "../../../common/dsp/smoother.hpp"
 
 #include <algorithm>
 #include <array>
 #include <climits>
-#include <vector>
 
 namespace SomeDSP {
 
-// 2x oversampled delay.
+/**
+2x oversampled delay. `buf` points into `DelayArena`, which is zero filled by its owner.
+*/
 template<typename Sample> class Delay {
 public:
   Sample w1 = 0;
@@ -21,23 +23,17 @@ public:
   int wptr = 0;
   int rptr = 0;
   int size = 0;
-  std::vector<Sample> buf;
+  Sample *buf = nullptr;
 
-  void setup(Sample sampleRate, Sample maxTime)
+  void setup(DelayArena<Sample> &arena, Sample sampleRate, Sample maxTime)
   {
     size = int(Sample(2) * sampleRate * maxTime) + 1;
     if (size < 4) size = 4;
 
-    buf.resize(size);
-
-    reset();
+    buf = arena.allocate(size);
   }
 
-  void reset()
-  {
-    w1 = 0;
-    std::fill(buf.begin(), buf.end(), Sample(0));
-  }
+  void reset() { w1 = 0; }
 
   Sample process(Sample input, Sample sampleRate, Sample seconds)
   {
@@ -84,7 +80,10 @@ public:
   Sample buffer = 0;
   Delay<Sample> delay;
 
-  void setup(Sample sampleRate, Sample maxTime) { delay.setup(sampleRate, maxTime); }
+  void setup(DelayArena<Sample> &arena, Sample sampleRate, Sample maxTime)
+  {
+    delay.setup(arena, sampleRate, maxTime);
+  }
 
   void reset()
   {
@@ -112,9 +111,11 @@ public:
   std::array<Sample, nest> buffer{};
   std::array<LongAllpass<Sample>, nest> allpass;
 
-  void setup(Sample sampleRate, Sample maxTime)
+  void setup(DelayArena<Sample> &arena, Sample sampleRate, Sample maxTime)
   {
-    for (auto &ap : allpass) ap.setup(sampleRate, maxTime);
+    for (size_t idx = nest - 1; idx != size_t(-1); --idx) {
+      allpass[idx].setup(arena, sampleRate, maxTime);
+    }
   }
 
   void reset()
@@ -150,9 +151,11 @@ public:
   std::array<ExpSmoother<Sample>, nest> feed;
   std::array<NestedLongAllpass<Sample, nSection1>, nest> allpass;
 
-  void setup(Sample sampleRate, Sample maxTime)
+  void setup(DelayArena<Sample> &arena, Sample sampleRate, Sample maxTime)
   {
-    for (auto &ap : allpass) ap.setup(sampleRate, maxTime);
+    for (size_t idx = nest - 1; idx != size_t(-1); --idx) {
+      allpass[idx].setup(arena, sampleRate, maxTime);
+    }
   }
 
   void reset()
@@ -187,9 +190,11 @@ public:
   std::array<ExpSmoother<Sample>, nest> feed;
   std::array<NestD2<Sample, nSection1, nSection2>, nest> allpass;
 
-  void setup(Sample sampleRate, Sample maxTime)
+  void setup(DelayArena<Sample> &arena, Sample sampleRate, Sample maxTime)
   {
-    for (auto &ap : allpass) ap.setup(sampleRate, maxTime);
+    for (size_t idx = nest - 1; idx != size_t(-1); --idx) {
+      allpass[idx].setup(arena, sampleRate, maxTime);
+    }
   }
 
   void reset()
@@ -230,9 +235,11 @@ public:
   std::array<ExpSmoother<Sample>, nest> feed;
   std::array<NestD3<Sample, nSection1, nSection2, nSection3>, nest> allpass;
 
-  void setup(Sample sampleRate, Sample maxTime)
+  void setup(DelayArena<Sample> &arena, Sample sampleRate, Sample maxTime)
   {
-    for (auto &ap : allpass) ap.setup(sampleRate, maxTime);
+    for (size_t idx = nest - 1; idx != size_t(-1); --idx) {
+      allpass[idx].setup(arena, sampleRate, maxTime);
+    }
   }
 
   void reset()
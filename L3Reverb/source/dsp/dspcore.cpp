@@ -7,12 +7,17 @@
 
 void DSPCore::setup(double sampleRate)
 {
+  SmootherCommon<float>::Scope smootherScope(smootherState);
+
   this->sampleRate = float(sampleRate);
 
   SmootherCommon<float>::setSampleRate(this->sampleRate);
   SmootherCommon<float>::setTime(0.2f);
 
-  for (auto &dly : delay) dly.setup(this->sampleRate, float(Scales::time.getMax()));
+  const auto maxTime = float(Scales::time.getMax());
+  delayArena.layout([&](DelayArena<float> &arena) {
+    for (auto &dly : delay) dly.setup(arena, this->sampleRate, maxTime);
+  });
 
   reset();
 }
@@ -118,6 +123,8 @@ template<typename T> inline T calcNotePitch(T note)
 
 void DSPCore::reset()
 {
+  SmootherCommon<float>::Scope smootherScope(smootherState);
+
   using ID = ParameterID::ID;
 
   midiNotes.clear();
@@ -126,6 +133,7 @@ void DSPCore::reset()
 
   startup();
 
+  delayArena.reset();
   for (auto &dly : delay) dly.reset();
   delayOut.fill(0);
 
@@ -134,6 +142,8 @@ void DSPCore::reset()
 
 void DSPCore::startup()
 {
+  SmootherCommon<float>::Scope smootherScope(smootherState);
+
   refreshSeed();
 
   timeRng.seed(timeSeed);
@@ -146,6 +156,8 @@ void DSPCore::startup()
 
 void DSPCore::setParameters()
 {
+  SmootherCommon<float>::Scope smootherScope(smootherState);
+
   using ID = ParameterID::ID;
 
   SmootherCommon<float>::setTime(param.value[ID::smoothness]->getFloat());
@@ -162,9 +174,11 @@ void DSPCore::setParameters()
   ASSIGN_ALLPASS_PARAMETER(push);
 }
 
+template<typename Sample>
 void DSPCore::process(
-  const size_t length, const float *in0, const float *in1, float *out0, float *out1)
+  const size_t length, const Sample *in0, const Sample *in1, Sample *out0, Sample *out1)
 {
+  SmootherCommon<float>::Scope smootherScope(smootherState);
   ScopedNoDenormals scopedDenormals;
 
   SmootherCommon<float>::setBufferSize(float(length));
@@ -191,8 +205,15 @@ void DSPCore::process(
   }
 }
 
+template void DSPCore::process<float>(
+  const size_t length, const float *in0, const float *in1, float *out0, float *out1);
+template void DSPCore::process<double>(
+  const size_t length, const double *in0, const double *in1, double *out0, double *out1);
+
 void DSPCore::noteOn(NoteInfo &info)
 {
+  SmootherCommon<float>::Scope smootherScope(smootherState);
+
   notePitchMultiplier = calcNotePitch(info.pitch);
   updateDelayTime();
 
@@ -201,6 +222,8 @@ void DSPCore::noteOn(NoteInfo &info)
 
 void DSPCore::noteOff(int_fast32_t noteId)
 {
+  SmootherCommon<float>::Scope smootherScope(smootherState);
+
   auto it = std::find_if(noteStack.begin(), noteStack.end(), [&](const NoteInfo &info) {
     return info.id == noteId;
   });
@@ -7,12 +7,16 @@
 
 void DSPCore::setup(double sampleRate)
 {
+  SmootherCommon<float>::Scope smootherScope(smootherState);
+
   this->sampleRate = float(sampleRate);
 
   SmootherCommon<float>::setSampleRate(this->sampleRate);
   SmootherCommon<float>::setTime(0.2f);
 
-  delay.setup(this->sampleRate, float(Scales::time.getMax()));
+  delayArena.layout([&](DelayArena<float> &arena) {
+    delay.setup(arena, this->sampleRate, float(Scales::time.getMax()));
+  });
 
   reset();
 }
@@ -25,12 +29,15 @@ inline std::array<float, 2> calcOffset(float offset, float mul)
 
 void DSPCore::reset()
 {
+  SmootherCommon<float>::Scope smootherScope(smootherState);
+
   using ID = ParameterID::ID;
 
   midiNotes.clear();
   noteStack.clear();
   notePitchMultiplier = float(1);
 
+  delayArena.reset();
   delay.reset();
 
   auto timeMul = notePitchMultiplier * param.value[ID::timeMultiply]->getFloat();
@@ -82,6 +89,8 @@ void DSPCore::startup() { rng.seed(0); }
 
 void DSPCore::setParameters()
 {
+  SmootherCommon<float>::Scope smootherScope(smootherState);
+
   using ID = ParameterID::ID;
 
   SmootherCommon<float>::setTime(param.value[ID::smoothness]->getFloat());
@@ -131,9 +140,11 @@ void DSPCore::setParameters()
   interpWet.push(param.value[ID::wet]->getFloat());
 }
 
+template<typename Sample>
 void DSPCore::process(
-  const size_t length, const float *in0, const float *in1, float *out0, float *out1)
+  const size_t length, const Sample *in0, const Sample *in1, Sample *out0, Sample *out1)
 {
+  SmootherCommon<float>::Scope smootherScope(smootherState);
   ScopedNoDenormals scopedDenormals;
 
   SmootherCommon<float>::setBufferSize(float(length));
@@ -171,6 +182,11 @@ void DSPCore::process(
   }
 }
 
+template void DSPCore::process<float>(
+  const size_t length, const float *in0, const float *in1, float *out0, float *out1);
+template void DSPCore::process<double>(
+  const size_t length, const double *in0, const double *in1, double *out0, double *out1);
+
 template<typename T> inline T calcNotePitch(T note)
 {
   auto pitch = std::exp2((note - T(69)) / T(12));
@@ -179,6 +195,8 @@ template<typename T> inline T calcNotePitch(T note)
 
 void DSPCore::noteOn(NoteInfo &info)
 {
+  SmootherCommon<float>::Scope smootherScope(smootherState);
+
   notePitchMultiplier = calcNotePitch(info.pitch);
   updateDelayTime();
 
@@ -187,6 +205,8 @@ void DSPCore::noteOn(NoteInfo &info)
 
 void DSPCore::noteOff(int_fast32_t noteId)
 {
+  SmootherCommon<float>::Scope smootherScope(smootherState);
+
   auto it = std::find_if(noteStack.begin(), noteStack.end(), [&](const NoteInfo &info) {
     return info.id == noteId;
   });
@@ -32,7 +32,7 @@ void Note::noteOn(
   float pan,
   float phase,
   float sampleRate,
-  Wavetable &wavetable,
+  const WavetableRenderer &wavetable,
   NoteProcessInfo &info,
   GlobalParameter &param)
 {
@@ -49,16 +49,15 @@ void Note::noteOn(
     notePitch + info.masterPitch.getValue(), info.equalTemperament.getValue(),
     info.pitchA4Hz.getValue());
 
-  // wavetable.refreshTable(noteFreq, osc.table);
-  osc.setFrequency(notePitch, noteFreq, wavetable.tableBaseFreq, wavetable.tableSize);
+  const auto &table = wavetable.get(noteToTableIndex(notePitch));
+  osc.setFrequency(notePitch, noteFreq, table.tableBaseFreq, table.size());
 
   if (param.value[ID::oscPhaseReset]->getInt()) {
     std::uniform_real_distribution<float> dist(0.0f, 1.0f);
     const auto phaseRnd
       = param.value[ID::oscPhaseRandom]->getInt() ? dist(info.rng) : 1.0f;
     osc.setPhase(
-      phase + phaseRnd * param.value[ID::oscInitialPhase]->getFloat(),
-      wavetable.tableSize);
+      phase + phaseRnd * param.value[ID::oscInitialPhase]->getFloat(), table.size());
   }
 
   filter.reset();
@@ -98,12 +97,12 @@ bool Note::isAttacking() { return gainEnvelope.isAttacking(); }
 float Note::getGain() { return gain; }
 
 std::array<float, 2>
-Note::process(float sampleRate, Wavetable &wavetable, NoteProcessInfo &info)
+Note::process(float sampleRate, const WavetableRenderer &wavetable, NoteProcessInfo &info)
 {
   gain = velocity * gainEnvelope.process();
   if (gainEnvelope.isTerminated()) state = NoteState::rest;
 
-  const auto oscOut = osc.process(wavetable.table, wavetable.tableSize);
+  const auto oscOut = osc.process(wavetable.get(osc.tableIndex));
 
   const auto cutAmt = info.filterAmount.getValue();
   const auto cutoff = std::clamp(
@@ -130,16 +129,16 @@ DSPCore::DSPCore()
   noteIndices.reserve(maxVoice);
   voiceIndices.reserve(maxVoice);
 
-  peakInfos.resize(nOvertone);
-
   midiNotes.reserve(maxVoice);
 }
 
 void DSPCore::setup(double sampleRate)
 {
+  SmootherCommon<float>::Scope smootherScope(smootherState);
+
   this->sampleRate = float(sampleRate);
 
-  midiNotes.resize(0);
+  midiNotes.clear();
 
   SmootherCommon<float>::setSampleRate(this->sampleRate);
   SmootherCommon<float>::setTime(0.04f);
@@ -151,10 +150,16 @@ void DSPCore::setup(double sampleRate)
 
   startup();
   prepareRefresh = true;
+
+  isTableRefreshRequested.store(false, std::memory_order_release);
+  wavetable.setDiskCacheDirectory(getTableCacheDirectory("LightPadSynth"));
+  wavetable.reset(getPadSynthParameter());
 }
 
 void DSPCore::reset()
 {
+  SmootherCommon<float>::Scope smootherScope(smootherState);
+
   using ID = ParameterID::ID;
 
   panCounter = 0;
@@ -175,6 +180,8 @@ void DSPCore::startup() { info.rng.seed(param.value[ParameterID::seed]->getInt()
 
 void DSPCore::setParameters(float tempo)
 {
+  SmootherCommon<float>::Scope smootherScope(smootherState);
+
   using ID = ParameterID::ID;
 
   SmootherCommon<float>::setTime(param.value[ID::smoothness]->getFloat());
@@ -233,15 +240,22 @@ void DSPCore::setParameters(float tempo)
     refreshTable();
   isTableRefeshed = param.value[ID::refreshTable]->getInt();
 
+  if (isTableRefreshRequested.exchange(false, std::memory_order_acq_rel))
+    wavetable.request(getPadSynthParameter());
+
   prepareRefresh = false;
 }
 
 void DSPCore::process(const size_t length, float *out0, float *out1)
 {
+  SmootherCommon<float>::Scope smootherScope(smootherState);
   ScopedNoDenormals scopedDenormals;
 
   SmootherCommon<float>::setBufferSize(float(length));
 
+  wavetable.lock();
+  param.value[ParameterID::guiTableProgress]->setFromFloat(wavetable.getProgress());
+
   std::array<float, 2> frame{};
   for (uint32_t i = 0; i < length; ++i) {
     processMidiNote(i);
@@ -269,6 +283,8 @@ void DSPCore::process(const size_t length, float *out0, float *out1)
     out0[i] = masterGain * frame[0];
     out1[i] = masterGain * frame[1];
   }
+
+  wavetable.unlock();
 }
 
 void DSPCore::setUnisonPan(size_t nUnison)
@@ -384,6 +400,8 @@ void DSPCore::setUnisonPan(size_t nUnison)
 
 void DSPCore::noteOn(int32_t identifier, int16_t pitch, float tuning, float velocity)
 {
+  SmootherCommon<float>::Scope smootherScope(smootherState);
+
   using ID = ParameterID::ID;
 
   const size_t nUnison = 1 + param.value[ID::nUnison]->getInt();
@@ -465,24 +483,33 @@ void DSPCore::fillTransitionBuffer(size_t noteIndex)
 
 void DSPCore::noteOff(int32_t noteId)
 {
+  SmootherCommon<float>::Scope smootherScope(smootherState);
+
   for (size_t i = 0; i < notes.size(); ++i)
     if (notes[i].id == noteId) notes[i].release();
 }
 
 void DSPCore::refreshTable()
+{
+  isTableRefreshRequested.store(true, std::memory_order_release);
+}
+
+PadSynthParameter<nOvertone> DSPCore::getPadSynthParameter()
 {
   using ID = ParameterID::ID;
 
-  reset();
+  PadSynthParameter<nOvertone> rq;
+  rq.sampleRate = sampleRate;
+  rq.tableBaseFreq = param.value[ID::tableBaseFrequency]->getFloat();
 
-  const float tableBaseFreq = param.value[ID::tableBaseFrequency]->getFloat();
   const float pitchMultiplier = param.value[ID::overtonePitchMultiply]->getFloat();
   const float pitchModulo = param.value[ID::overtonePitchModulo]->getFloat();
   const float gainPow = param.value[ID::overtoneGainPower]->getFloat();
   const float widthMul = param.value[ID::overtoneWidthMultiply]->getFloat();
 
+  auto &peakInfos = rq.peakInfos;
   for (size_t idx = 0; idx < peakInfos.size(); ++idx) {
-    peakInfos[idx].frequency = (pitchMultiplier * idx + 1.0f) * tableBaseFreq
+    peakInfos[idx].frequency = (pitchMultiplier * idx + 1.0f) * rq.tableBaseFreq
       * param.value[ID::overtonePitch0 + idx]->getFloat();
     if (pitchModulo != 0) {
       peakInfos[idx].frequency = fmodf(
@@ -497,14 +524,15 @@ void DSPCore::refreshTable()
 
   size_t bufferSize = param.value[ID::tableBufferSize]->getInt();
   if (bufferSize >= 12) bufferSize = 11;
-  wavetable.resize(1024 << bufferSize);
-
-  wavetable.padsynth(
-    sampleRate, tableBaseFreq, peakInfos, param.value[ID::padSynthSeed]->getInt(),
-    param.value[ID::spectrumExpand]->getFloat(),
-    param.value[ID::spectrumRotate]->getFloat(),
-    param.value[ID::profileComb]->getInt() + 1, param.value[ID::profileShape]->getFloat(),
-    param.value[ID::uniformPhaseProfile]->getInt());
+  rq.tableSize = 1024 << bufferSize;
+
+  rq.seed = param.value[ID::padSynthSeed]->getInt();
+  rq.expand = param.value[ID::spectrumExpand]->getFloat();
+  rq.rotate = param.value[ID::spectrumRotate]->getFloat();
+  rq.profileSkip = param.value[ID::profileComb]->getInt() + 1;
+  rq.profileShape = param.value[ID::profileShape]->getFloat();
+  rq.uniformPhaseProfile = param.value[ID::uniformPhaseProfile]->getInt();
+  return rq;
 }
 
 void DSPCore::refreshLfo()
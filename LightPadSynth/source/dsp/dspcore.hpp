@@ -4,13 +4,16 @@
 #pragma once
 
 #include "../../../common/dsp/constants.hpp"
+#include "../../../common/dsp/notequeue.hpp"
 #include "../../../common/dsp/smoother.hpp"
+#include "../../../common/dsp/tablerenderer.hpp"
 #include "../parameter.hpp"
 #include "delay.hpp"
 #include "envelope.hpp"
 #include "oscillator.hpp"
 
 #include <array>
+#include <atomic>
 #include <cmath>
 #include <random>
 
@@ -35,6 +38,8 @@ notePitchToFrequency(float notePitch, float equalTemperament, float a4Hz = 440.0
 
 enum class NoteState { active, release, rest };
 
+using WavetableRenderer = TableRenderer<PadSynthRenderer<nOvertone>, maxMidiNoteNumber>;
+
 struct NoteProcessInfo {
   std::minstd_rand rng{0};
 
@@ -144,7 +149,7 @@ public:
     float pan,
     float phase,
     float sampleRate,
-    Wavetable &wavetable,
+    const WavetableRenderer &wavetable,
     NoteProcessInfo &info,
     GlobalParameter &param);
   void release();
@@ -154,7 +159,7 @@ public:
   bool isAttacking();
   float getGain();
   std::array<float, 2>
-  process(float sampleRate, Wavetable &wavetable, NoteProcessInfo &info);
+  process(float sampleRate, const WavetableRenderer &wavetable, NoteProcessInfo &info);
 };
 
 class DSPCore {
@@ -170,8 +175,9 @@ public:
 
   static constexpr size_t maxVoice = 128;
   GlobalParameter param;
+  SmootherState<float> smootherState;
 
-  std::vector<MidiNote> midiNotes;
+  NoteQueue<MidiNote> midiNotes;
 
   DSPCore();
 
@@ -186,6 +192,13 @@ public:
   void refreshTable();
   void refreshLfo();
 
+  // True while PADsynth tables are rendered on background thread.
+  bool isRenderingTable() const
+  {
+    return isTableRefreshRequested.load(std::memory_order_acquire)
+      || wavetable.isRendering();
+  }
+
   void pushMidiNote(
     bool isNoteOn,
     uint32_t frame,
@@ -201,35 +214,30 @@ public:
     note.pitch = pitch;
     note.tuning = tuning;
     note.velocity = velocity;
-    midiNotes.push_back(note);
+    if (!midiNotes.push(note) && !note.isNoteOn) noteOff(note.id);
   }
 
   void processMidiNote(uint32_t frame)
   {
-    while (true) {
-      auto it = std::find_if(midiNotes.begin(), midiNotes.end(), [&](const MidiNote &nt) {
-        return nt.frame == frame;
-      });
-      if (it == std::end(midiNotes)) return;
-      if (it->isNoteOn)
-        noteOn(it->id, it->pitch, it->tuning, it->velocity);
+    midiNotes.pop(frame, [&](MidiNote &nt) {
+      if (nt.isNoteOn)
+        noteOn(nt.id, nt.pitch, nt.tuning, nt.velocity);
       else
-        noteOff(it->id);
-      midiNotes.erase(it);
-    }
+        noteOff(nt.id);
+    });
   }
 
 private:
   void setUnisonPan(size_t nUnison);
+  PadSynthParameter<nOvertone> getPadSynthParameter();
 
   float sampleRate = 44100.0f;
 
-  std::vector<PeakInfo<float>> peakInfos;
-
   bool prepareRefresh = true;
   bool isTableRefeshed = false;
   bool isLFORefreshed = false;
-  Wavetable wavetable;
+  std::atomic<bool> isTableRefreshRequested{false};
+  WavetableRenderer wavetable;
   LfoWavetable<lfoTableSize> lfoWavetable;
 
   size_t nVoice = 32;
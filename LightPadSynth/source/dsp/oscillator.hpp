@@ -3,16 +3,17 @@
 
 #pragma once
 
-#define POCKETFFT_NO_MULTITHREADING
-#include "../../../lib/AudioFFT/AudioFFT.h"
-
 #include "../../../common/dsp/constants.hpp"
+#include "../../../common/dsp/fft.hpp"
+#include "../../../common/dsp/tablediskcache.hpp"
 
 #include <algorithm>
+#include <array>
 #include <cmath>
 #include <complex>
 #include <cstring>
 #include <deque>
+#include <memory>
 #include <numeric>
 #include <random>
 #include <vector>
@@ -35,11 +36,46 @@ template<typename Sample> struct PeakInfo {
   Sample gain = 0;
   Sample phase = 0;
   Sample bandWidth = 1;
+
+  bool operator==(const PeakInfo &) const = default;
 };
 
 constexpr size_t initialTableSize = 262144;
 constexpr size_t maxMidiNoteNumber = 128;
 
+inline size_t noteToTableIndex(float notePitch)
+{
+  size_t index = size_t(notePitch);
+  return index >= maxMidiNoteNumber ? maxMidiNoteNumber - 1 : index;
+}
+
+template<size_t nPeak> struct PadSynthParameter {
+  float sampleRate = 44100.0f;
+  float tableBaseFreq = 20.0f;
+  size_t tableSize = initialTableSize;
+  std::array<PeakInfo<float>, nPeak> peakInfos{};
+  uint32_t seed = 0;
+  float expand = 1.0f;
+  float rotate = 0.0f;
+  uint32_t profileSkip = 1; // 1 or greater.
+  float profileShape = 1.0f;
+  bool uniformPhaseProfile = false;
+
+  bool operator==(const PadSynthParameter &) const = default;
+
+  TableKey key() const
+  {
+    TableKey key;
+    key.add(sampleRate).add(tableBaseFreq).add(uint64_t(tableSize));
+    for (const auto &peak : peakInfos) {
+      key.add(peak.frequency).add(peak.gain).add(peak.phase).add(peak.bandWidth);
+    }
+    key.add(seed).add(expand).add(rotate).add(profileSkip).add(profileShape);
+    key.add(uniformPhaseProfile);
+    return key;
+  }
+};
+
 /**
 Last element of table is padded for linear interpolation.
 For example, consider following table:
@@ -56,32 +92,97 @@ tablePadded = [11, 22, 33, 44, 11].
 ```
  */
 struct Wavetable {
+  TableBuffer table;
+  float tableBaseFreq = 20.0f;
+
+  size_t size() const { return table.empty() ? 0 : table.size() - 1; }
+};
+
+/**
+Renders a `Wavetable` for each MIDI note. Used as `Renderer` of `TableRenderer`.
+
+`prepare` builds the spectrum, and `render` band-limits it for the MIDI note. Tables of
+high notes have only a few harmonics left, so they are rendered at shorter length with
+`tableBaseFreq` raised by the same ratio.
+
+All tables of a request are placed in one arena allocated by `prepare`, in note order with
+64 bytes alignment. Each `Wavetable` holds a reference to the arena, so the arena is freed
+after the last table of the request is released.
+ */
+template<size_t nPeak> class PadSynthRenderer {
+public:
+  using Request = PadSynthParameter<nPeak>;
+  using Table = Wavetable;
+
+  struct Scratch {
+    std::vector<float> tmpSpecRe;
+    std::vector<float> tmpSpecIm;
+    FftwBuffer<std::complex<float>> bandLimited;
+    RealInverseFft ifft;
+
+    void resize(size_t tableSize)
+    {
+      size_t spectrumSize = tableSize / 2 + 1;
+      tmpSpecRe.resize(spectrumSize);
+      tmpSpecIm.resize(spectrumSize);
+      if (bandLimited.size() != spectrumSize) bandLimited.resize(spectrumSize);
+    }
+  };
+
+private:
+  // A table is shortened until a cycle of its highest harmonic spans `minOversample`
+  // samples. Notes below `tableBaseFreq * minOversample` use full length.
+  static constexpr float minOversample = 16.0f;
+  static constexpr size_t minTableSize = 64;
+  static constexpr size_t alignment = 64; // In bytes.
+  static constexpr size_t alignSize = alignment / sizeof(float);
+
   std::vector<float> spectrumRe;
   std::vector<float> spectrumIm;
-  std::vector<float> tmpSpecRe;
-  std::vector<float> tmpSpecIm;
-  std::vector<std::vector<float>> table;
   float tableBaseFreq = 20.0f;
-  static const size_t tableSize = initialTableSize;
-  audiofft::AudioFFT fft;
+  size_t tableSize = 0;
 
-  Wavetable() { resize(initialTableSize); }
+  std::shared_ptr<std::vector<float>> arena;
+  float *arenaBase = nullptr;
+  std::array<size_t, maxMidiNoteNumber> offset{};
 
-  void resize(size_t tableSize)
+  static float noteFrequency(size_t index)
   {
-    size_t spectrumSize = tableSize / 2 + 1;
-    spectrumRe.resize(spectrumSize);
-    spectrumIm.resize(spectrumSize);
-    tmpSpecRe.resize(spectrumSize);
-    tmpSpecIm.resize(spectrumSize);
+    return 440.0f * std::pow(2.0f, (int(index) - 69.0f) / 12.0f);
+  }
 
-    table.resize(maxMidiNoteNumber);
-    for (auto &tbl : table) tbl.resize(tableSize + 1);
+  // Halve the length per octave. Playback speed is kept by scaling `tableBaseFreq`.
+  static size_t getShift(size_t tableSize, float tableBaseFreq, float frequency)
+  {
+    size_t shift = 0;
+    while ((tableSize >> (shift + 1)) >= minTableSize
+           && float(size_t(2) << shift) * minOversample * tableBaseFreq <= frequency)
+    {
+      ++shift;
+    }
+    return shift;
+  }
 
-    fft.init(tableSize);
+  size_t getShift(size_t index) const
+  {
+    return getShift(tableSize, tableBaseFreq, noteFrequency(index));
   }
 
-  size_t getTableSize() { return tableSize; }
+  void allocateArena()
+  {
+    size_t used = 0;
+    for (size_t idx = 0; idx < maxMidiNoteNumber; ++idx) {
+      offset[idx] = used;
+      const size_t padded = (tableSize >> getShift(idx)) + 1;
+      used += (padded + alignSize - 1) / alignSize * alignSize;
+    }
+
+    arena = std::make_shared<std::vector<float>>(used + alignSize);
+    void *ptr = arena->data();
+    size_t space = arena->size() * sizeof(float);
+    std::align(alignment, used * sizeof(float), ptr, space);
+    arenaBase = static_cast<float *>(ptr);
+  }
 
   inline float profile(float fi, float bwi, float shape)
   {
@@ -90,28 +191,36 @@ struct Wavetable {
     return powf(expf(-x * x) / bwi, shape);
   }
 
-  void padsynth(
-    float sampleRate,
-    float tableBaseFreq,
-    std::vector<PeakInfo<float>> &peakInfos,
-    uint32_t seed,
-    float expand,
-    float rotate,
-    uint32_t profileSkip, // 1 or greater.
-    float profileShape,
-    bool uniformPhaseProfile)
+public:
+  static size_t tableLength(const Request &rq, size_t index)
   {
-    if (profileSkip < 1) profileSkip = 1;
+    const auto shift = getShift(rq.tableSize, rq.tableBaseFreq, noteFrequency(index));
+    return (rq.tableSize >> shift) + 1;
+  }
 
-    this->tableBaseFreq = tableBaseFreq;
+  void prepare(const Request &rq, Scratch &scratch)
+  {
+    tableSize = rq.tableSize;
+    spectrumRe.resize(tableSize / 2 + 1);
+    spectrumIm.resize(tableSize / 2 + 1);
+    scratch.resize(tableSize);
+    auto &tmpSpecRe = scratch.tmpSpecRe;
+    auto &tmpSpecIm = scratch.tmpSpecIm;
+
+    const auto sampleRate = rq.sampleRate;
+    const auto profileSkip = std::max<uint32_t>(rq.profileSkip, 1);
+    const auto expand = rq.expand;
+    const auto rotate = rq.rotate;
+
+    tableBaseFreq = rq.tableBaseFreq;
 
     for (size_t bin = 1; bin < spectrumRe.size(); ++bin) {
       spectrumRe[bin] = 0.0f;
       spectrumIm[bin] = 0.0f;
     }
 
-    std::minstd_rand rng(seed);
-    for (const auto &peak : peakInfos) {
+    std::minstd_rand rng(rq.seed);
+    for (const auto &peak : rq.peakInfos) {
       float bandHz = (powf(2.0f, peak.bandWidth / 1200.0f) - 1.0f) * peak.frequency;
       float bandIdx = bandHz / (2.0f * sampleRate);
 
@@ -128,13 +237,12 @@ struct Wavetable {
       auto phase = distPhase(rng);
       for (int32_t bin = start; bin < end; bin += profileSkip) {
         auto radius = peak.gain
-          * profile(bin / float(spectrumRe.size()) - freqIdx, bandIdx, profileShape);
-        if (!uniformPhaseProfile) phase = distPhase(rng);
+          * profile(bin / float(spectrumRe.size()) - freqIdx, bandIdx, rq.profileShape);
+        if (!rq.uniformPhaseProfile) phase = distPhase(rng);
         spectrumRe[bin] += radius * cosf(phase);
         spectrumIm[bin] += radius * sinf(phase);
       }
     }
-
     if (expand != 1.0f || rotate != 0) {
       size_t rot = size_t(fabs(rotate) * spectrumRe.size());
       if (rot < spectrumRe.size()) {
@@ -176,7 +284,7 @@ struct Wavetable {
       sum += sqrtf(spectrumRe[i] * spectrumRe[i] + spectrumIm[i] * spectrumIm[i]);
 
     if (sum != 0) {
-      sum = 0.5f * sum / tableSize;
+      sum = 0.5f * sum / initialTableSize;
       for (size_t i = 0; i < spectrumRe.size(); ++i) {
         auto value = std::complex<float>(spectrumRe[i], spectrumIm[i]) / sum;
         spectrumRe[i] = value.real();
@@ -184,24 +292,44 @@ struct Wavetable {
       }
     }
 
-    for (int i = 0; i < int(table.size()); ++i)
-      refreshTable(440.0f * std::pow(2.0f, (i - 69.0f) / 12.0f), table[i]);
+    allocateArena();
   }
 
-  void refreshTable(float frequency, std::vector<float> &table)
+  void render(size_t index, Table &wavetable, Scratch &scratch) const
   {
+    scratch.resize(tableSize);
+    auto &bandLimited = scratch.bandLimited;
+
+    const float frequency = noteFrequency(index);
     size_t bandIdx = size_t(spectrumRe.size() * tableBaseFreq / frequency);
     bandIdx = std::clamp<size_t>(bandIdx, 1, spectrumRe.size());
 
-    std::copy_n(spectrumRe.begin(), bandIdx, tmpSpecRe.begin());
-    std::copy_n(spectrumIm.begin(), bandIdx, tmpSpecIm.begin());
-    std::fill(tmpSpecRe.begin() + bandIdx, tmpSpecRe.end(), 0.0f);
-    std::fill(tmpSpecIm.begin() + bandIdx, tmpSpecIm.end(), 0.0f);
+    const size_t shift = getShift(index);
+    const size_t size = tableSize >> shift;
+    const size_t spectrumSize = size / 2 + 1;
+    if (shift > 0) bandIdx = std::min(bandIdx, size / 2);
 
-    fft.ifft(table.data(), tmpSpecRe.data(), tmpSpecIm.data());
+    wavetable.table.view(arena, arenaBase + offset[index], size + 1);
+    wavetable.tableBaseFreq = tableBaseFreq * float(size_t(1) << shift);
+
+    for (size_t bin = 0; bin < bandIdx; ++bin) {
+      bandLimited[bin] = std::complex<float>(spectrumRe[bin], spectrumIm[bin]);
+    }
+    std::fill(
+      bandLimited.begin() + bandIdx, bandLimited.begin() + spectrumSize,
+      std::complex<float>{});
+
+    // Plan depends on alignment of `wavetable.table`, which differs between arenas.
+    auto output = wavetable.table.data();
+    scratch.ifft.init(size, bandLimited.data(), output);
+    scratch.ifft.execute(bandLimited.data(), output);
+
+    // Scaling of full length table also applies to shortened ones.
+    const float scale = 1.0f / float(tableSize);
+    for (size_t i = 0; i < size; ++i) output[i] *= scale;
 
     // Fill padded elements.
-    table[table.size() - 1] = table[0];
+    wavetable.table[wavetable.table.size() - 1] = wavetable.table[0];
   }
 };
 
@@ -213,8 +341,7 @@ struct TableOsc {
   void
   setFrequency(float notePitch, float frequency, float tableBaseFreq, size_t tableSize)
   {
-    tableIndex = size_t(notePitch);
-    if (tableIndex >= maxMidiNoteNumber) tableIndex = maxMidiNoteNumber - 1;
+    tableIndex = noteToTableIndex(notePitch);
 
     tick = frequency / tableBaseFreq;
     if (tick >= tableSize || tick < 0.0f) tick = 0;
@@ -233,12 +360,14 @@ struct TableOsc {
     tableIndex = 0;
   }
 
-  float process(std::vector<std::vector<float>> &table, size_t tableSize)
+  // `wavetable` may be replaced by a table of different size while a note is playing.
+  float process(const Wavetable &wavetable)
   {
-    const auto &tbl = table[tableIndex];
+    const auto &tbl = wavetable.table;
+    const auto tableSize = float(wavetable.size());
 
     phase += tick;
-    if (phase >= tableSize) phase -= tableSize;
+    if (phase >= tableSize) phase = std::fmod(phase, tableSize);
 
     size_t x0 = size_t(phase);
     return tbl[x0] + (phase - float(x0)) * (tbl[x0 + 1] - tbl[x0]);
@@ -108,7 +108,10 @@ enum ID {
   refreshLFO,
   refreshTable,
 
+  guiTableProgress,
+
   ID_ENUM_LENGTH,
+  ID_ENUM_GUI_START = guiTableProgress,
 };
 } // namespace ParameterID
 
@@ -340,6 +343,9 @@ struct GlobalParameter : public ParameterInterface {
     value[ID::refreshTable] = std::make_unique<UIntValue>(
       0, Scales::boolScale, "refreshTable", Info::kCanAutomate);
 
+    value[ID::guiTableProgress] = std::make_unique<LinearValue>(
+      1.0, Scales::defaultScale, "guiTableProgress", Info::kIsReadOnly);
+
     for (size_t id = 0; id < value.size(); ++id) value[id]->setId(Vst::ParamID(id));
   }
 
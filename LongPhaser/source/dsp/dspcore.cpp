@@ -15,6 +15,8 @@ template<typename T> inline T lerp(T a, T b, T t) { return a + t * (b - a); }
 
 void DSPCore::setup(double sampleRate)
 {
+  SmootherCommon<double>::Scope smootherScope(smootherState);
+
   this->sampleRate = double(sampleRate);
 
   pitchSmoothingKp = EMAFilter<double>::secondToP(upRate, double(0.01));
@@ -68,6 +70,8 @@ void DSPCore::updateUpRate()
 
 void DSPCore::reset()
 {
+  SmootherCommon<double>::Scope smootherScope(smootherState);
+
   oversampling = param.value[ParameterID::ID::oversampling]->getInt();
   updateUpRate();
 
@@ -100,6 +104,8 @@ void DSPCore::startup() { synchronizer.reset(upRate, tempo, getTempoSyncInterval
 
 void DSPCore::setParameters()
 {
+  SmootherCommon<double>::Scope smootherScope(smootherState);
+
   bool newOversampling = param.value[ParameterID::ID::oversampling]->getInt();
   if (oversampling != newOversampling) {
     oversampling = newOversampling;
@@ -191,9 +197,11 @@ void DSPCore::processFrame(std::array<double, 2> &frame)
   frame[1] = feedbackBuffer[1] * outputGain.getValue();
 }
 
+template<typename Sample>
 void DSPCore::process(
-  const size_t length, const float *in0, const float *in1, float *out0, float *out1)
+  const size_t length, const Sample *in0, const Sample *in1, Sample *out0, Sample *out1)
 {
+  SmootherCommon<double>::Scope smootherScope(smootherState);
   ScopedNoDenormals scopedDenormals;
 
   using ID = ParameterID::ID;
@@ -250,8 +258,15 @@ void DSPCore::process(
   if (transitionCounter == 0) previousAllpassStage = currentAllpassStage;
 }
 
+template void DSPCore::process<float>(
+  const size_t length, const float *in0, const float *in1, float *out0, float *out1);
+template void DSPCore::process<double>(
+  const size_t length, const double *in0, const double *in1, double *out0, double *out1);
+
 void DSPCore::noteOn(NoteInfo &info)
 {
+  SmootherCommon<double>::Scope smootherScope(smootherState);
+
   notePitchInv.push(calcNotePitch(info.pitch));
 
   noteStack.push_back(info);
@@ -259,6 +274,8 @@ void DSPCore::noteOn(NoteInfo &info)
 
 void DSPCore::noteOff(int_fast32_t noteId)
 {
+  SmootherCommon<double>::Scope smootherScope(smootherState);
+
   auto it = std::find_if(noteStack.begin(), noteStack.end(), [&](const NoteInfo &info) {
     return info.id == noteId;
   });
@@ -18,6 +18,7 @@ using namespace Steinberg::Synth;
 class DSPCore {
 public:
   GlobalParameter param;
+  SmootherState<float> smootherState;
   bool isPlaying = false;
   float tempo = 120.0f;
   float beatsElapsed = 0.0f;
@@ -26,8 +27,13 @@ public:
   void reset();
   void startup();
   void setParameters();
+  template<typename Sample>
   void process(
-    const size_t length, const float *in0, const float *in1, float *out0, float *out1);
+    const size_t length,
+    const Sample *in0,
+    const Sample *in1,
+    Sample *out0,
+    Sample *out1);
 
 private:
   float getTempoSyncInterval();
@@ -25,6 +25,8 @@ inline double calcPitch(double semitone, double equalTemperament = 12.0)
 
 void DSPCore::setup(double sampleRate)
 {
+  SmootherCommon<double>::Scope smootherScope(smootherState);
+
   noteStack.reserve(1024);
   noteStack.resize(0);
 
@@ -101,6 +103,8 @@ void DSPCore::setup(double sampleRate)
 
 void DSPCore::reset()
 {
+  SmootherCommon<double>::Scope smootherScope(smootherState);
+
   ASSIGN_PARAMETER(reset);
 
   previousSeed = pv[ID::fdnSeed]->getInt();
@@ -135,6 +139,8 @@ void DSPCore::startup() {}
 
 void DSPCore::setParameters()
 {
+  SmootherCommon<double>::Scope smootherScope(smootherState);
+
   ASSIGN_PARAMETER(push);
 
   auto seed = pv[ID::fdnSeed]->getInt();
@@ -215,6 +221,7 @@ double DSPCore::processSample()
 
 void DSPCore::process(const size_t length, float *out0, float *out1)
 {
+  SmootherCommon<double>::Scope smootherScope(smootherState);
   ScopedNoDenormals scopedDenormals;
 
   using ID = ParameterID::ID;
@@ -244,6 +251,8 @@ void DSPCore::process(const size_t length, float *out0, float *out1)
 
 void DSPCore::noteOn(NoteInfo &info)
 {
+  SmootherCommon<double>::Scope smootherScope(smootherState);
+
   using ID = ParameterID::ID;
   auto &pv = param.value;
 
@@ -337,6 +346,8 @@ void DSPCore::noteOn(NoteInfo &info)
 
 void DSPCore::noteOff(int_fast32_t noteId)
 {
+  SmootherCommon<double>::Scope smootherScope(smootherState);
+
   using ID = ParameterID::ID;
   auto &pv = param.value;
 
@@ -15,6 +15,8 @@ template<typename T> T lerp(T a, T b, T t) { return a + t * (b - a); }
 
 void DSPCore::setup(double sampleRate)
 {
+  SmootherCommon<float>::Scope smootherScope(smootherState);
+
   this->sampleRate = float(sampleRate);
 
   SmootherCommon<float>::setSampleRate(this->sampleRate);
@@ -22,11 +24,23 @@ void DSPCore::setup(double sampleRate)
 
   reset();
   startup();
-  prepareRefresh = true;
+
+  // `reset` leaves a job of the convolver to the worker, which may still read the FIR.
+  convolver.drain();
+
+  // First FIR is designed here. Following ones are designed on worker thread.
+  requestedCutoffHz = param.value[ParameterID::cutoffHz]->getFloat();
+  firBuilder.reset(getFirRequest(requestedCutoffHz));
+  convolver.setFir(firBuilder.get());
 }
 
 size_t DSPCore::getLatency() { return fftconvLatency; }
 
+NuttallFirRequest DSPCore::getFirRequest(float cutoffHz)
+{
+  return {firPartition, sampleRate, cutoffHz, false};
+}
+
 #define ASSIGN_PARAMETER(METHOD)                                                         \
   using ID = ParameterID::ID;                                                            \
   const auto &pv = param.value;                                                          \
@@ -36,9 +50,11 @@ size_t DSPCore::getLatency() { return fftconvLatency; }
 
 void DSPCore::reset()
 {
+  SmootherCommon<float>::Scope smootherScope(smootherState);
+
   ASSIGN_PARAMETER(reset);
 
-  for (auto &cnv : convolver) cnv.reset();
+  convolver.reset();
   for (auto &dly : delay) dly.reset();
 
   startup();
@@ -48,19 +64,25 @@ void DSPCore::startup() {}
 
 void DSPCore::setParameters()
 {
+  SmootherCommon<float>::Scope smootherScope(smootherState);
+
   ASSIGN_PARAMETER(push);
 
-  if (prepareRefresh || (!isFirRefreshed && pv[ID::refreshFir]->getInt())) {
-    auto cutoffHz = pv[ID::cutoffHz]->getFloat();
-    for (auto &cnv : convolver) cnv.refreshFir(sampleRate, cutoffHz, false);
+  auto cutoffHz = pv[ID::cutoffHz]->getFloat();
+  if (
+    cutoffHz != requestedCutoffHz || (!isFirRefreshed && pv[ID::refreshFir]->getInt()))
+  {
+    firBuilder.request(getFirRequest(cutoffHz));
+    requestedCutoffHz = cutoffHz;
   }
   isFirRefreshed = pv[ID::refreshFir]->getInt();
-  prepareRefresh = false;
 }
 
+template<typename Sample>
 void DSPCore::process(
-  const size_t length, const float *in0, const float *in1, float *out0, float *out1)
+  const size_t length, const Sample *in0, const Sample *in1, Sample *out0, Sample *out1)
 {
+  SmootherCommon<float>::Scope smootherScope(smootherState);
   ScopedNoDenormals scopedDenormals;
 
   SmootherCommon<float>::setBufferSize(float(length));
@@ -68,17 +90,27 @@ void DSPCore::process(
   using ID = ParameterID::ID;
   const auto &pv = param.value;
 
+  // New FIR is swapped in after the convolver finished crossfading to the last one.
+  if (!convolver.isFading()) {
+    firBuilder.releasePrevious();
+    if (firBuilder.acquire()) convolver.fadeTo(firBuilder.get());
+  }
+
   for (size_t i = 0; i < length; ++i) {
-    auto lp0 = convolver[0].process(in0[i]);
-    auto lp1 = convolver[1].process(in1[i]);
+    auto lp = convolver.process({float(in0[i]), float(in1[i])});
 
-    auto hp0 = delay[0].process(in0[i]) - lp0;
-    auto hp1 = delay[1].process(in1[i]) - lp1;
+    auto hp0 = delay[0].process(in0[i]) - lp[0];
+    auto hp1 = delay[1].process(in1[i]) - lp[1];
 
     auto hpGain = interpHighpassGain.process();
     auto lpGain = interpLowpassGain.process();
 
-    out0[i] = lpGain * lp0 + hpGain * hp0;
-    out1[i] = lpGain * lp1 + hpGain * hp1;
+    out0[i] = lpGain * lp[0] + hpGain * hp0;
+    out1[i] = lpGain * lp[1] + hpGain * hp1;
   }
 }
+
+template void DSPCore::process<float>(
+  const size_t length, const float *in0, const float *in1, float *out0, float *out1);
+template void DSPCore::process<double>(
+  const size_t length, const double *in0, const double *in1, double *out0, double *out1);
@@ -3,6 +3,7 @@
 
 #pragma once
 
+#include "../../../common/dsp/backgroundbuilder.hpp"
 #include "../../../common/dsp/constants.hpp"
 #include "../../../common/dsp/lightlimiter.hpp"
 #include "../../../common/dsp/smoother.hpp"
@@ -15,30 +16,43 @@ using namespace SomeDSP;
 using namespace Steinberg::Synth;
 
 constexpr size_t firLengthInPow2 = 15;
-constexpr size_t blockSizeInPow2 = 11;
-constexpr size_t nBlock = size_t(1) << (firLengthInPow2 - blockSizeInPow2);
-constexpr size_t fftconvLatency = (size_t(1) << firLengthInPow2) / 2 - 1;
+constexpr size_t nFirTap = size_t(1) << firLengthInPow2;
+constexpr size_t fftconvLatency = nFirTap / 2 - 1;
+constexpr PartitionSpec firPartition{nFirTap};
 
 class DSPCore {
 public:
+  DSPCore() { convolver.init(firPartition); }
+
   GlobalParameter param;
+  SmootherState<float> smootherState;
 
   void setup(double sampleRate);
   void reset();
   void startup();
   size_t getLatency();
   void setParameters();
+  template<typename Sample>
   void process(
-    const size_t length, const float *in0, const float *in1, float *out0, float *out1);
+    const size_t length,
+    const Sample *in0,
+    const Sample *in1,
+    Sample *out0,
+    Sample *out1);
 
 private:
+  NuttallFirRequest getFirRequest(float cutoffHz);
+
   float sampleRate = 44100.0f;
-  bool prepareRefresh = false;
+  float requestedCutoffHz = 0.0f;
   bool isFirRefreshed = false;
 
   ExpSmoother<float> interpHighpassGain;
   ExpSmoother<float> interpLowpassGain;
 
-  std::array<SplitConvolver<nBlock, blockSizeInPow2>, 2> convolver;
+  // FIR is designed on worker thread. `convolver` must be destroyed first, because it
+  // refers to the FIR in `firBuilder`.
+  BackgroundBuilder<NuttallFirRequest, NuttallPartitionedFir> firBuilder;
+  PartitionedConvolver<2> convolver;
   std::array<FixedIntDelay<float, fftconvLatency>, 2> delay;
 };
@@ -4,14 +4,18 @@
 #pragma once
 
 #include "../../../common/dsp/constants.hpp"
-#include "../../../lib/fftw3/fftw3.h"
+#include "../../../common/dsp/fft.hpp"
+#include "../../../common/dsp/workerpool.hpp"
 
 #include <algorithm>
 #include <array>
+#include <atomic>
 #include <cmath>
 #include <complex>
-#include <mutex>
+#include <cstdint>
+#include <memory>
 #include <numeric>
+#include <thread>
 #include <vector>
 
 namespace SomeDSP {
@@ -58,316 +62,652 @@ getNuttallFir(size_t nTap, float sampleRate, float cutoffHz, bool isHighpass)
   return coefficient;
 }
 
-template<typename Sample, size_t nTap> class DirectConvolver {
-private:
-  std::array<Sample, nTap> co{};
-  std::array<Sample, nTap> buf{};
+/**
+Partitioning of FIR used by `PartitionedFir` and `PartitionedConvolver`.
 
-public:
-  void setFir(std::vector<float> &source)
+`latency` selects the mode.
+- 0: Zero latency. First `firstBlockSize` taps are computed in direct form.
+- Otherwise: Output is delayed by `latency` samples, and the direct form head is skipped.
+  `latency` is used as the first block size, and it's rounded up to power of 2.
+
+Block sizes must be power of 2.
+*/
+struct PartitionSpec {
+  size_t nTap = 0;
+  size_t latency = 0;
+  size_t firstBlockSize = 64;
+  size_t maxBlockSize = 8192;
+};
+
+struct PartitionLayout {
+  struct Stage {
+    size_t blockSize = 1;
+    size_t nPartition = 1;
+    size_t firStart = 0;       // Index of first tap in FIR.
+    size_t stride = 1;         // Length of a spectrum slot. Padded to keep alignment.
+    size_t spectrumOffset = 0; // Position in `PartitionedFir::spectrum`.
+    bool isDeferred = false;
+  };
+
+  size_t nTap = 0;
+  size_t latency = 0;
+  size_t headSize = 0;
+  size_t spectrumSize = 0;
+  std::vector<Stage> stages;
+
+  PartitionLayout(const PartitionSpec &spec) : nTap(spec.nTap)
   {
-    if (source.size() < nTap) return;
-    std::copy(source.begin(), source.begin() + nTap, co.begin());
+    size_t N = spec.firstBlockSize;
+    if (spec.latency > 0) {
+      N = 1;
+      while (N < spec.latency) N *= 2;
+    }
+    const size_t maxBlockSize = std::max(spec.maxBlockSize, N);
+
+    latency = spec.latency > 0 ? N : 0;
+    headSize = spec.latency > 0 ? 0 : std::min(N, nTap);
+
+    // Stage positions are on FIR delayed by `latency`. A stage is deferred when it starts
+    // at 2 N, and the stage before it ends there.
+    const size_t end = nTap + latency;
+    size_t start = N;
+    while (start < end) {
+      const size_t nextN = std::min(4 * N, maxBlockSize);
+      const size_t stageEnd = std::min(nextN > N ? 2 * nextN : end, end);
+
+      Stage st;
+      st.blockSize = N;
+      st.nPartition = (stageEnd - start + N - 1) / N;
+      st.firStart = start - latency;
+      st.stride = (N + 1 + 7) / 8 * 8;
+      st.spectrumOffset = spectrumSize;
+      st.isDeferred = start >= 2 * N;
+      stages.push_back(st);
+
+      spectrumSize += st.nPartition * st.stride;
+      start += st.nPartition * N;
+      N = nextN;
+    }
   }
+};
 
-  void reset() { buf.fill({}); }
+/**
+FIR prepared for `PartitionedConvolver`. Spectra of partitions are computed here, so
+filter design and FFT can be done outside of audio thread.
+*/
+struct PartitionedFir {
+  std::vector<float> head;
+  FftwBuffer<std::complex<float>> spectrum; // [stage][nPartition][stride].
 
-  Sample process(Sample input)
+  // Taps after `spec.nTap` are ignored. Missing taps are filled by 0.
+  void set(const PartitionSpec &spec, const std::vector<float> &source)
   {
-    std::rotate(buf.rbegin(), buf.rbegin() + 1, buf.rend());
-    buf[0] = input;
-
-    Sample output = 0;
-    for (size_t n = 0; n < nTap; ++n) output += buf[n] * co[n];
-    return output;
+    const PartitionLayout layout(spec);
+
+    auto tap = [&](size_t index) {
+      return index < source.size() && index < layout.nTap ? source[index] : float(0);
+    };
+
+    head.resize(layout.headSize);
+    for (size_t idx = 0; idx < layout.headSize; ++idx) head[idx] = tap(idx);
+
+    spectrum.resize(layout.spectrumSize);
+    for (const auto &st : layout.stages) {
+      const size_t N = st.blockSize;
+
+      FftwBuffer<float> padded(2 * N);
+      RealForwardFft fft;
+      fft.init(2 * N, padded.data(), spectrum.data() + st.spectrumOffset);
+
+      for (size_t p = 0; p < st.nPartition; ++p) {
+        // FFT scaling is also applied here.
+        const size_t offset = st.firStart + p * N;
+        for (size_t idx = 0; idx < N; ++idx) {
+          padded[idx] = tap(offset + idx) / float(2 * N);
+        }
+        fft.execute(padded.data(), spectrum.data() + st.spectrumOffset + p * st.stride);
+      }
+    }
   }
 };
 
-class OverlapSaveConvolver {
+/**
+Non-uniformly partitioned FFT convolver with frequency-domain delay lines (FDL).
+
+Filter is split into a direct form head and stages. Each stage is a uniformly partitioned
+overlap-save convolver of block size `N`, and it keeps the spectra of past input blocks in
+its FDL. Block size grows 4 times per stage up to `maxBlockSize`, so a long FIR costs only
+a few FFTs per sample. See `PartitionSpec` for latency modes.
+
+A stage starting at tap `2 N` or later has one block of spare time before its output is
+used. Those stages are posted to the process-wide `WorkerPool`, and audio thread never
+waits for it. "The worker" below is the pool thread that picks up the job. When the queue
+is busy, the job is left for audio thread. At the deadline, audio thread takes a job that
+the worker hasn't picked up. When the worker is still running the job, audio thread
+computes the same job into its own FDL slot and output bank, and the result of the worker
+is discarded. Until the worker is done with the discarded job, its resources are held and
+the stage is computed on audio thread. Output doesn't depend on the timing of the worker.
+
+FDL slots are referred by index. `history` holds the slots of past blocks, and a job
+writes the spectrum of its block to a free slot. A deferred stage has `2 * nPartition`
+slots and 3 output banks, which are enough to keep the job of the worker, the job of audio
+thread, and the block being read apart.
+
+`fadeTo` switches FIR without click. Head and each stage crossfade their own output from
+old FIR to new FIR over their next block. The old FIR must be kept alive while
+`isFading()` returns true.
+
+`nChannel` inputs are filtered by the same FIR. FIR and worker are shared.
+
+Reference:
+- William G. Gardner, 1993-11-11, "Efficient Convolution Without Latency"
+- Frank Wefers, 2015, "Partitioned convolution algorithms for real-time auralization"
+*/
+template<size_t nChannel> class PartitionedConvolver {
 private:
-  // `fftwMutex` is used to lock FFTW3 calls except `fftw*_execute`.
-  static std::mutex fftwMutex;
-
-  static constexpr size_t nBuffer = 2;
-
-  size_t half = 1;
-  size_t bufSize = 2;
-  size_t spcSize = 1; // spc = spectrum.
-
-  std::array<float *, nBuffer> buf;
-  std::complex<float> *spc;
-  std::complex<float> *fir;
-  float *flt; // filtered.
-  float *coefficient;
-
-  std::array<fftwf_plan, nBuffer> forwardPlan;
-  fftwf_plan inversePlan;
-  fftwf_plan firPlan;
-
-  size_t front = 0;
-  std::array<size_t, nBuffer> wptr{};
-  size_t rptr = 0;
-  size_t offset = 0;
-
-public:
-  void init(size_t nTap, size_t delay = 0)
+  enum Status : uint32_t { idle, posted, running, done };
+
+  static constexpr size_t nBank = 3;
+
+  struct Job {
+    const PartitionedFir *fir = nullptr;
+    const PartitionedFir *fadeFrom = nullptr; // Crossfades from this FIR when set.
+    size_t window = 0;
+    size_t bank = 0;
+    std::vector<uint32_t> slot; // FDL slots from newest block. `slot[0]` is written.
+  };
+
+  struct Scratch {
+    FftwBuffer<std::complex<float>> accumulator;
+    FftwBuffer<float> filtered;
+    FftwBuffer<float> fadeFiltered;
+  };
+
+  struct Stage;
+
+  // Task of the pool. Runs the posted job of `stage` unless audio thread took it.
+  struct Task : public WorkerPool::Job {
+    PartitionedConvolver *owner = nullptr;
+    Stage *stage = nullptr;
+
+    void run() override { owner->runPosted(*stage); }
+  };
+
+  struct Stage {
+    PartitionLayout::Stage layout;
+    Task task;
+
+    size_t pos = 0;
+    size_t readBank = 0;
+    std::atomic<uint32_t> status{idle};
+
+    // `fadeFrom` is set by `fadeTo`, and moved to `job` on next block.
+    const PartitionedFir *fadeFrom = nullptr;
+
+    // `job` is not yet committed while `hasJob`. A posted job is copied to `workerJob`.
+    // `isHeld` is true while the worker may touch `workerJob`, including a discarded one.
+    Job job;
+    Job workerJob;
+    bool hasJob = false;
+    bool isComputed = false;
+    bool isPosted = false;
+    bool isHeld = false;
+
+    std::vector<uint32_t> history; // FDL slots of past blocks, newest first.
+    std::vector<uint32_t> slotUse; // Reference count of each FDL slot.
+
+    std::vector<float> input;  // [nChannel][2 * N], sliding.
+    std::vector<float> output; // [nBank][nChannel][N].
+    std::array<std::array<FftwBuffer<float>, nChannel>, 2> window;
+    FftwBuffer<std::complex<float>> fdl; // [nChannel][nSlot][stride].
+    std::array<Scratch, 2> scratch;      // [worker, audio thread].
+
+    RealForwardFft forwardFft;
+    RealInverseFft inverseFft;
+  };
+
+  size_t nTap = 0;
+  size_t latencySample = 0;
+  const PartitionedFir *fir = nullptr;
+
+  size_t headSize = 0;
+  size_t headPtr = 0;
+  size_t headFadeCounter = 0;
+  const PartitionedFir *headFadeFrom = nullptr;
+  std::vector<float> headBuffer; // [nChannel][2 * headSize].
+
+  std::vector<std::unique_ptr<Stage>> stages;
+
+  std::shared_ptr<WorkerPool> pool;
+
+  // Multiplies FDL and FIR spectra, then inverse FFT to `dest`.
+  void convolve(
+    Stage &st,
+    const Job &job,
+    const std::complex<float> *fdl,
+    const PartitionedFir &src,
+    Scratch &sc,
+    float *dest)
   {
-    const std::lock_guard<std::mutex> fftwLock(fftwMutex);
-
-    offset = delay;
-
-    half = nTap;
-    bufSize = 2 * half;
-    spcSize = nTap + 1;
-
-    for (size_t idx = 0; idx < nBuffer; ++idx) {
-      buf[idx] = (float *)fftwf_malloc(sizeof(float) * bufSize);
+    const auto &lt = st.layout;
+    const size_t nBin = lt.blockSize + 1;
+    const auto spectrum = src.spectrum.data() + lt.spectrumOffset;
+
+    std::fill(sc.accumulator.begin(), sc.accumulator.end(), std::complex<float>(0, 0));
+    auto acc = reinterpret_cast<float *>(sc.accumulator.data());
+    for (size_t p = 0; p < lt.nPartition; ++p) {
+      auto x = reinterpret_cast<const float *>(fdl + job.slot[p] * lt.stride);
+      auto h = reinterpret_cast<const float *>(spectrum + p * lt.stride);
+      for (size_t i = 0; i < 2 * nBin; i += 2) {
+        acc[i] += x[i] * h[i] - x[i + 1] * h[i + 1];
+        acc[i + 1] += x[i] * h[i + 1] + x[i + 1] * h[i];
+      }
     }
-    spc = (std::complex<float> *)fftwf_malloc(sizeof(std::complex<float>) * spcSize);
-    flt = (float *)fftwf_malloc(sizeof(float) * bufSize);
-
-    coefficient = (float *)fftwf_malloc(sizeof(float) * bufSize);
-    std::fill(coefficient, coefficient + bufSize, float(0));
 
-    fir = (std::complex<float> *)fftwf_malloc(sizeof(std::complex<float>) * spcSize);
-    std::fill(fir, fir + spcSize, std::complex<float>(0, 0));
+    st.inverseFft.execute(sc.accumulator.data(), dest);
+  }
 
-    for (size_t idx = 0; idx < nBuffer; ++idx) {
-      forwardPlan[idx] = fftwf_plan_dft_r2c_1d(
-        int(bufSize), buf[idx], reinterpret_cast<fftwf_complex *>(spc), FFTW_ESTIMATE);
+  // Writes last half of overlap-save output to `job.bank`. Crossfades when `fadeFrom` is
+  // set. `st.window` and FDL slots other than `job.slot[0]` are only read.
+  void runJob(Stage &st, const Job &job, Scratch &sc)
+  {
+    const auto &lt = st.layout;
+    const size_t N = lt.blockSize;
+    const size_t nSlot = st.slotUse.size();
+
+    for (size_t ch = 0; ch < nChannel; ++ch) {
+      auto fdl = st.fdl.data() + ch * nSlot * lt.stride;
+      st.forwardFft.execute(
+        st.window[job.window][ch].data(), fdl + job.slot[0] * lt.stride);
+
+      convolve(st, job, fdl, *job.fir, sc, sc.filtered.data());
+      auto dest = st.output.begin() + (job.bank * nChannel + ch) * N;
+      if (job.fadeFrom == nullptr) {
+        std::copy_n(sc.filtered.begin() + N, N, dest);
+        continue;
+      }
+
+      convolve(st, job, fdl, *job.fadeFrom, sc, sc.fadeFiltered.data());
+      for (size_t idx = 0; idx < N; ++idx) {
+        const auto from = sc.fadeFiltered[N + idx];
+        const auto to = sc.filtered[N + idx];
+        dest[idx] = from + float(idx + 1) / float(N) * (to - from);
+      }
     }
-    inversePlan = fftwf_plan_dft_c2r_1d(
-      int(bufSize), reinterpret_cast<fftwf_complex *>(spc), flt, FFTW_ESTIMATE);
-    firPlan = fftwf_plan_dft_r2c_1d(
-      int(bufSize), coefficient, reinterpret_cast<fftwf_complex *>(fir), FFTW_ESTIMATE);
   }
 
-  ~OverlapSaveConvolver()
+  static uint32_t getFreeSlot(const Stage &st)
   {
-    const std::lock_guard<std::mutex> fftwLock(fftwMutex);
-
-    for (auto &fp : forwardPlan) fftwf_destroy_plan(fp);
-    fftwf_destroy_plan(inversePlan);
-    fftwf_destroy_plan(firPlan);
-
-    for (auto &bf : buf) fftwf_free(bf);
-    fftwf_free(spc);
-    fftwf_free(fir);
-    fftwf_free(flt);
-    fftwf_free(coefficient);
+    for (uint32_t slot = 0; slot < st.slotUse.size(); ++slot) {
+      if (st.slotUse[slot] == 0) return slot;
+    }
+    return 0; // Unreachable. Slots are allocated for the worst case.
   }
 
-  void setFir(std::vector<float> &source, size_t start, size_t end)
+  // Returns an output bank which is neither read nor held by the worker.
+  static size_t getFreeBank(const Stage &st)
   {
-    std::copy(source.begin() + start, source.begin() + end, coefficient);
+    for (size_t bank = 0; bank < nBank; ++bank) {
+      if (bank != st.readBank && !(st.isHeld && bank == st.workerJob.bank)) return bank;
+    }
+    return 0; // Unreachable.
+  }
 
-    // FFT scaling.
-    for (size_t idx = 0; idx < half; ++idx) coefficient[idx] /= float(bufSize);
+  void allocate(Stage &st)
+  {
+    st.job.slot[0] = getFreeSlot(st);
+    std::copy(st.history.begin(), st.history.end(), st.job.slot.begin() + 1);
+    st.job.bank = getFreeBank(st);
+  }
 
-    fftwf_execute(firPlan);
+  void release(Stage &st)
+  {
+    for (auto slot : st.workerJob.slot) --st.slotUse[slot];
+    st.isHeld = false;
+    st.isPosted = false;
+    st.status.store(idle, std::memory_order_relaxed);
   }
 
-  void reset()
+  // Releases a discarded job after the worker is done with it.
+  void reclaim(Stage &st)
   {
-    wptr[0] = half + offset;
-    wptr[1] = offset;
-    for (auto &w : wptr) w %= bufSize;
-    front = wptr[1] < wptr[0] ? 0 : 1;
-    rptr = half + offset % half;
-
-    for (size_t idx = 0; idx < nBuffer; ++idx) {
-      std::fill(buf[idx], buf[idx] + bufSize, float(0));
+    if (
+      st.isHeld && !st.isPosted && st.status.load(std::memory_order_acquire) == done)
+    {
+      release(st);
     }
-    std::fill(spc, spc + spcSize, std::complex<float>(0, 0));
-    std::fill(flt, flt + bufSize, float(0));
   }
 
-  float process(float input)
+  /**
+  Makes sure that the output of `st.job` is ready, without waiting for the worker. A job
+  that isn't picked up by the worker is taken, and computed on the calling thread. When
+  the worker is running the job, the job is computed again into other FDL slot and output
+  bank.
+  */
+  void finish(Stage &st)
   {
-    buf[0][wptr[0]] = input;
-    buf[1][wptr[1]] = input;
-
-    for (auto &w : wptr) {
-      if (++w >= bufSize) w = 0;
+    if (!st.hasJob || st.isComputed) return;
+    st.isComputed = true;
+
+    if (st.isPosted) {
+      uint32_t expected = posted;
+      if (st.status.compare_exchange_strong(
+            expected, running, std::memory_order_acq_rel, std::memory_order_acquire))
+      {
+        runJob(st, st.workerJob, st.scratch[1]);
+        st.status.store(done, std::memory_order_relaxed);
+        return;
+      }
+      if (expected == done) return;
+      st.isPosted = false;
     }
 
-    if (wptr[front] == 0) {
-      fftwf_execute(forwardPlan[front]);
-      for (size_t i = 0; i < spcSize; ++i) spc[i] *= fir[i];
-      fftwf_execute(inversePlan);
+    allocate(st);
+    runJob(st, st.job, st.scratch[1]);
+  }
 
-      front ^= 1;
+  // Switches output to `st.job`, and pushes its FDL slot to `history`.
+  void commit(Stage &st)
+  {
+    if (!st.hasJob) return;
+    finish(st);
+
+    if (!st.history.empty()) {
+      const auto slot = st.job.slot[0];
+      ++st.slotUse[slot];
+      --st.slotUse[st.history.back()];
+      std::copy_backward(st.history.begin(), st.history.end() - 1, st.history.end());
+      st.history[0] = slot;
     }
+    st.readBank = st.job.bank;
+    if (st.isPosted) release(st);
 
-    if (++rptr >= bufSize) rptr = half;
-    return flt[rptr];
+    st.hasJob = false;
+    st.isComputed = false;
+    st.job.fadeFrom = nullptr;
   }
-};
-
-/**
-FFT convolver without latency.
-
-It must be `lengthInPow2 > minBlockSizeInPowerOfTwo`.
 
-Signal to noise ratio is around -120 dB (1 : 1e-6). Slightly worse than direct
-overlap-add.
-
-This is an impelmentation of minimum computation cost solution in following paper:
-- William G. Gardner, 1993-11-11, "Efficient Convolution Without Latency"
-*/
-template<size_t lengthInPow2, size_t minBlockSizeInPow2 = 4> class ImmediateConvolver {
-private:
-  static constexpr size_t nTap = size_t(1) << lengthInPow2;
-  static constexpr size_t nFftConvolver = lengthInPow2 - minBlockSizeInPow2;
-
-  DirectConvolver<float, size_t(1) << minBlockSizeInPow2> firstConvolver;
-  std::array<OverlapSaveConvolver, nFftConvolver> fftConvolver;
-  std::array<float, nFftConvolver> sumBuffer{};
-
-public:
-  ImmediateConvolver()
+  void processBlockBoundary(Stage &st)
   {
-    static_assert(
-      lengthInPow2 > minBlockSizeInPow2,
-      "ImmediateConvolver: lengthInPow2 must be greater than minBlockSizeInPow2.");
+    const size_t N = st.layout.blockSize;
+
+    commit(st);
+    reclaim(st);
+
+    st.job.fir = fir;
+    st.job.fadeFrom = st.fadeFrom;
+    st.fadeFrom = nullptr;
+    st.job.window = st.isHeld ? st.workerJob.window ^ 1 : 0;
+    for (size_t ch = 0; ch < nChannel; ++ch) {
+      auto input = st.input.begin() + ch * 2 * N;
+      std::copy_n(input, 2 * N, st.window[st.job.window][ch].begin());
+      std::copy_n(input + N, N, input);
+    }
+    st.hasJob = true;
 
-    for (size_t idx = 0; idx < nFftConvolver; ++idx) {
-      fftConvolver[idx].init(size_t(1) << (minBlockSizeInPow2 + idx));
+    if (!st.layout.isDeferred) {
+      commit(st);
+      return;
     }
+    if (st.isHeld) return; // Computed on audio thread at next boundary.
 
-    reset();
-  }
+    allocate(st);
+    st.workerJob = st.job;
+    for (auto slot : st.workerJob.slot) ++st.slotUse[slot];
+    st.isHeld = true;
+    st.isPosted = true;
+    st.status.store(posted, std::memory_order_release);
 
-  inline size_t latency()
-  {
-    // Latency of FIR filter specific to `refreshFir()`.
-    return nTap / 2 - 1;
+    // When the queue is busy, the job stays posted and `finish` takes it at the deadline.
+    pool->tryPost(st.task);
   }
 
-  void refreshFir(float sampleRate, float cutoffHz, bool isHighpass)
+  /**
+  Pool thread. A task may outlive its job when audio thread took the job, or may run the
+  job posted after it. Both are fine, because only a posted job is run.
+  */
+  void runPosted(Stage &st)
   {
-    auto coefficient = getNuttallFir(nTap, sampleRate, cutoffHz, isHighpass);
-
-    // Set FIR coefficients.
-    firstConvolver.setFir(coefficient);
-    for (size_t idx = 0; idx < nFftConvolver; ++idx) {
-      fftConvolver[idx].setFir(
-        coefficient, size_t(1) << (minBlockSizeInPow2 + idx),
-        size_t(1) << (minBlockSizeInPow2 + idx + 1));
+    uint32_t expected = posted;
+    if (!st.status.compare_exchange_strong(
+          expected, running, std::memory_order_acq_rel, std::memory_order_relaxed))
+    {
+      return;
     }
+    runJob(st, st.workerJob, st.scratch[0]);
+    st.status.store(done, std::memory_order_release);
   }
 
-  void setFir(std::vector<float> &source)
+  // Removes queued tasks, and waits until running ones return.
+  void cancelTasks()
   {
-    if (source.size() < nTap) source.resize(nTap);
-
-    firstConvolver.setFir(source);
-    for (size_t idx = 0; idx < nFftConvolver; ++idx) {
-      size_t start = size_t(1) << (minBlockSizeInPow2 + idx);
-      size_t end = size_t(1) << (minBlockSizeInPow2 + idx + 1);
-      fftConvolver[idx].setFir(source, start, end);
-    }
+    if (!pool) return;
+    for (auto &st : stages) pool->cancel(st->task);
   }
 
-  void reset()
+  float headDot(const float *buf, const PartitionedFir &src)
   {
-    firstConvolver.reset();
-    for (auto &conv : fftConvolver) conv.reset();
-    sumBuffer.fill({});
+    float sum = 0;
+    for (size_t idx = 0; idx < headSize; ++idx) sum += buf[headPtr + idx] * src.head[idx];
+    return sum;
   }
 
-  float process(float input)
-  {
-    float output = std::accumulate(sumBuffer.begin(), sumBuffer.end(), float(0));
+public:
+  PartitionedConvolver() = default;
+  PartitionedConvolver(const PartitionedConvolver &) = delete;
+  PartitionedConvolver &operator=(const PartitionedConvolver &) = delete;
 
-    for (size_t idx = 0; idx < nFftConvolver; ++idx)
-      sumBuffer[idx] = fftConvolver[idx].process(input);
+  ~PartitionedConvolver() { cancelTasks(); }
 
-    return output + firstConvolver.process(input);
+  // Allocates buffers and acquires the pool. Output is 0 until `setFir` is called.
+  void init(const PartitionSpec &spec)
+  {
+    cancelTasks();
+    if (!pool) pool = WorkerPool::acquire();
+
+    const PartitionLayout layout(spec);
+
+    nTap = layout.nTap;
+    latencySample = layout.latency;
+    fir = nullptr;
+
+    headSize = layout.headSize;
+    headBuffer.resize(nChannel * 2 * headSize);
+
+    stages.clear();
+    for (const auto &lt : layout.stages) {
+      const size_t N = lt.blockSize;
+      const size_t nSlot = lt.isDeferred ? 2 * lt.nPartition : lt.nPartition;
+
+      auto st = std::make_unique<Stage>();
+      st->layout = lt;
+      st->task.owner = this;
+      st->task.stage = st.get();
+      st->job.slot.resize(lt.nPartition);
+      st->workerJob.slot.resize(lt.nPartition);
+      st->history.resize(lt.nPartition - 1);
+      std::iota(st->history.begin(), st->history.end(), uint32_t(0));
+      st->slotUse.resize(nSlot);
+      for (auto slot : st->history) ++st->slotUse[slot];
+      st->input.resize(nChannel * 2 * N);
+      st->output.resize(nBank * nChannel * N);
+      for (auto &wd : st->window) {
+        for (auto &buf : wd) buf.resize(2 * N);
+      }
+      st->fdl.resize(nChannel * nSlot * lt.stride);
+      for (auto &sc : st->scratch) {
+        sc.accumulator.resize(N + 1);
+        sc.filtered.resize(2 * N);
+        sc.fadeFiltered.resize(2 * N);
+      }
+
+      st->forwardFft.init(2 * N, st->window[0][0].data(), st->fdl.data());
+      st->inverseFft.init(
+        2 * N, st->scratch[0].accumulator.data(), st->scratch[0].filtered.data());
+
+      stages.push_back(std::move(st));
+    }
+    reset();
   }
-};
 
-class FixedIntDelayVector {
-public:
-  std::vector<float> buf{};
-  size_t ptr = 0;
+  size_t latency() const { return latencySample; }
 
-  void resize(size_t size) { buf.resize(size); }
-  void reset(float value = 0) { std::fill(buf.begin(), buf.end(), value); }
-
-  float process(float input)
+  /**
+  Waits until the worker is done with all jobs. Posted jobs are computed on the calling
+  thread. Call this before a FIR given to this convolver is freed. Not for audio thread.
+  */
+  void drain()
   {
-    if (++ptr >= buf.size()) ptr -= buf.size();
-    auto output = buf[ptr];
-    buf[ptr] = input;
-    return output;
+    for (auto &st : stages) {
+      finish(*st);
+      while (st->isHeld && st->status.load(std::memory_order_acquire) == running) {
+        std::this_thread::yield();
+      }
+      reclaim(*st);
+    }
   }
-};
-
-/**
-A variation of convolver without latency.
 
-SplitConvolver splits filter kernel into several blocks, then compute the blocks in
-different timings. This is a mitigation of CPU load spikes that's caused by FFT.
+  /**
+  Switches FIR immediately. `source` must be made from the same `PartitionSpec` given to
+  `init`, and it must be alive until it's replaced. Calls `drain`.
+  */
+  void setFir(const PartitionedFir &source)
+  {
+    drain();
+
+    fir = &source;
+    headFadeCounter = 0;
+    headFadeFrom = nullptr;
+    for (auto &st : stages) {
+      st->fadeFrom = nullptr;
+      st->job.fadeFrom = nullptr;
+    }
+  }
 
-Memory usage can be reduced by sharing input buffer.
-*/
-template<size_t nBlock, size_t blockSizeInPow2, size_t minBlockSizeInPow2 = 4>
-class SplitConvolver {
-public:
-  static constexpr size_t nTap = nBlock * (size_t(1) << blockSizeInPow2);
-  static constexpr size_t nFftConvolver = nBlock - 2;
-  static constexpr size_t blockSize = size_t(1) << blockSizeInPow2;
+  // Audio thread. Must not be called while `isFading()` is true.
+  void fadeTo(const PartitionedFir &source)
+  {
+    if (fir == nullptr) {
+      setFir(source);
+      return;
+    }
 
-  ImmediateConvolver<blockSizeInPow2, minBlockSizeInPow2> immediateConvolver;
-  OverlapSaveConvolver firstFftConvolver;
-  std::array<OverlapSaveConvolver, nFftConvolver> fftConvolver;
-  std::array<FixedIntDelayVector, nFftConvolver> outputDelay;
-  float buf = 0;
+    headFadeFrom = fir;
+    headFadeCounter = headSize;
+    for (auto &st : stages) st->fadeFrom = fir;
+    fir = &source;
+  }
 
-  SplitConvolver()
+  // Also true while the worker is running a discarded job on old FIR.
+  bool isFading() const
   {
-    firstFftConvolver.init(blockSize, blockSize / nBlock);
-    for (size_t idx = 0; idx < nFftConvolver; ++idx) {
-      size_t offset = (idx + 2) * blockSize / nBlock;
-      fftConvolver[idx].init(blockSize, offset);
-      outputDelay[idx].resize((idx + 1) * blockSize + 1);
+    if (headFadeCounter > 0) return true;
+    for (const auto &st : stages) {
+      if (st->fadeFrom != nullptr) return true;
+      if (st->hasJob && st->job.fadeFrom != nullptr) return true;
+      const auto &wj = st->workerJob;
+      if (st->isHeld && (wj.fadeFrom != nullptr || wj.fir != fir)) return true;
     }
+    return false;
   }
 
+  // Audio thread. Doesn't wait for the worker. Fading FIR is finished immediately.
   void reset()
   {
-    immediateConvolver.reset();
-
-    firstFftConvolver.reset();
-    for (size_t idx = 0; idx < nFftConvolver; ++idx) {
-      fftConvolver[idx].reset();
-      outputDelay[idx].reset();
+    headPtr = 0;
+    headFadeCounter = 0;
+    headFadeFrom = nullptr;
+    std::fill(headBuffer.begin(), headBuffer.end(), float(0));
+
+    for (auto &st : stages) {
+      // Job not picked up by the worker is cancelled. Running one is discarded.
+      if (st->isPosted) {
+        uint32_t expected = posted;
+        st->status.compare_exchange_strong(
+          expected, done, std::memory_order_acq_rel, std::memory_order_relaxed);
+        st->isPosted = false;
+      }
+      reclaim(*st);
+
+      st->hasJob = false;
+      st->isComputed = false;
+      st->job.fadeFrom = nullptr;
+      st->fadeFrom = nullptr;
+      st->pos = 0;
+      std::fill(st->input.begin(), st->input.end(), float(0));
+
+      const auto &lt = st->layout;
+      const size_t nSlot = st->slotUse.size();
+      for (auto slot : st->history) --st->slotUse[slot];
+      for (auto &slot : st->history) {
+        slot = getFreeSlot(*st);
+        ++st->slotUse[slot];
+        for (size_t ch = 0; ch < nChannel; ++ch) {
+          std::fill_n(
+            st->fdl.begin() + (ch * nSlot + slot) * lt.stride, lt.stride,
+            std::complex<float>(0, 0));
+        }
+      }
+
+      const size_t bankSize = nChannel * lt.blockSize;
+      st->readBank = getFreeBank(*st);
+      std::fill_n(st->output.begin() + st->readBank * bankSize, bankSize, float(0));
     }
-    buf = 0;
   }
 
-  void refreshFir(float sampleRate, float cutoffHz, bool isHighpass)
+  std::array<float, nChannel> process(const std::array<float, nChannel> &input)
   {
-    auto coefficient = getNuttallFir(nTap, sampleRate, cutoffHz, isHighpass);
+    std::array<float, nChannel> output{};
+    if (fir == nullptr) return output;
+
+    if (headSize > 0) {
+      for (size_t ch = 0; ch < nChannel; ++ch) {
+        // Input is written twice to read the newest `headSize` samples contiguously.
+        auto buf = headBuffer.data() + ch * 2 * headSize;
+        buf[headPtr] = input[ch];
+        buf[headPtr + headSize] = input[ch];
+        output[ch] = headDot(buf, *fir);
+        if (headFadeCounter > 0) {
+          const auto from = headDot(buf, *headFadeFrom);
+          const auto ratio = float(headSize - headFadeCounter + 1) / float(headSize);
+          output[ch] = from + ratio * (output[ch] - from);
+        }
+      }
+      if (headFadeCounter > 0 && --headFadeCounter == 0) headFadeFrom = nullptr;
+      headPtr = headPtr == 0 ? headSize - 1 : headPtr - 1;
+    }
 
-    immediateConvolver.setFir(coefficient);
-    firstFftConvolver.setFir(coefficient, blockSize, 2 * blockSize);
-    for (size_t idx = 0; idx < nFftConvolver; ++idx) {
-      fftConvolver[idx].setFir(coefficient, (idx + 2) * blockSize, (idx + 3) * blockSize);
+    for (auto &st : stages) {
+      const size_t N = st->layout.blockSize;
+      for (size_t ch = 0; ch < nChannel; ++ch) {
+        st->input[ch * 2 * N + N + st->pos] = input[ch];
+        output[ch] += st->output[(st->readBank * nChannel + ch) * N + st->pos];
+      }
+      if (++st->pos >= N) {
+        st->pos = 0;
+        processBlockBoundary(*st);
+      }
     }
+
+    return output;
   }
+};
 
-  float process(float input)
+/**
+Request of `BackgroundBuilder` to design lowpass or highpass FIR by `getNuttallFir`, and
+prepare it as `PartitionedFir`.
+*/
+struct NuttallFirRequest {
+  PartitionSpec spec;
+  float sampleRate = 48000.0f;
+  float cutoffHz = 20.0f;
+  bool isHighpass = false;
+};
+
+struct NuttallPartitionedFir : public PartitionedFir {
+  void build(const NuttallFirRequest &rq)
   {
-    auto output = immediateConvolver.process(input);
-    output += buf;
-    buf = firstFftConvolver.process(input);
-    for (size_t idx = 0; idx < nFftConvolver; ++idx) {
-      auto value = fftConvolver[idx].process(input);
-      output += outputDelay[idx].process(value);
-    }
-    return output;
+    set(rq.spec, getNuttallFir(rq.spec.nTap, rq.sampleRate, rq.cutoffHz, rq.isHighpass));
   }
 };
 
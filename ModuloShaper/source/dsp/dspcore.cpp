@@ -8,15 +8,17 @@
 #include <algorithm>
 #include <numeric>
 
-inline float maxAbs(const size_t length, const float *buffer)
+template<typename Sample> inline Sample maxAbs(const size_t length, const Sample *buffer)
 {
-  float max = 0.0f;
+  Sample max = 0;
   for (size_t i = 0; i < length; ++i) max = std::max(max, std::fabs(buffer[i]));
   return max;
 }
 
 void DSPCore::setup(double sampleRate)
 {
+  SmootherCommon<float>::Scope smootherScope(smootherState);
+
   this->sampleRate = float(sampleRate);
 
   SmootherCommon<float>::setSampleRate(this->sampleRate);
@@ -49,6 +51,8 @@ void DSPCore::setup(double sampleRate)
 
 void DSPCore::reset()
 {
+  SmootherCommon<float>::Scope smootherScope(smootherState);
+
   ASSIGN_PARAMETER(reset);
 
   for (auto &shaper : shaperNaive) shaper.reset();
@@ -62,6 +66,8 @@ void DSPCore::startup() {}
 
 size_t DSPCore::getLatency()
 {
+  SmootherCommon<float>::Scope smootherScope(smootherState);
+
   auto latency = activateLimiter ? limiter[0].latency() : 0;
   if (shaperType == 1)
     return shaperNaive[0].latency() + latency;
@@ -74,6 +80,8 @@ size_t DSPCore::getLatency()
 
 void DSPCore::setParameters()
 {
+  SmootherCommon<float>::Scope smootherScope(smootherState);
+
   ASSIGN_PARAMETER(push);
 
   for (auto &lm : limiter) {
@@ -83,9 +91,11 @@ void DSPCore::setParameters()
   }
 }
 
+template<typename Sample>
 void DSPCore::process(
-  const size_t length, const float *in0, const float *in1, float *out0, float *out1)
+  const size_t length, const Sample *in0, const Sample *in1, Sample *out0, Sample *out1)
 {
+  SmootherCommon<float>::Scope smootherScope(smootherState);
   ScopedNoDenormals scopedDenormals;
 
   SmootherCommon<float>::setBufferSize(float(length));
@@ -168,3 +178,8 @@ void DSPCore::process(
     out1[i] = frame[1];
   }
 }
+
+template void DSPCore::process<float>(
+  const size_t length, const float *in0, const float *in1, float *out0, float *out1);
+template void DSPCore::process<double>(
+  const size_t length, const double *in0, const double *in1, double *out0, double *out1);
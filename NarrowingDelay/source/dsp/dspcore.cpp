@@ -22,6 +22,8 @@ template<typename T> inline T processLfoWave(T phase, T clip, T skew) noexcept
 
 void DSPCore::setup(double sampleRate)
 {
+  SmootherCommon<double>::Scope smootherScope(smootherState);
+
   this->sampleRate = double(sampleRate);
 
   pitchSmoothingKp = EMAFilter<double>::secondToP(upRate, double(0.01));
@@ -75,6 +77,8 @@ void DSPCore::updateUpRate()
 
 void DSPCore::reset()
 {
+  SmootherCommon<double>::Scope smootherScope(smootherState);
+
   oversampling = param.value[ParameterID::ID::oversampling]->getInt();
   updateUpRate();
 
@@ -101,6 +105,8 @@ void DSPCore::startup() { synchronizer.reset(upRate, tempo, getTempoSyncInterval
 
 void DSPCore::setParameters()
 {
+  SmootherCommon<double>::Scope smootherScope(smootherState);
+
   size_t newOversampling = param.value[ParameterID::ID::oversampling]->getInt();
   if (oversampling != newOversampling) {
     oversampling = newOversampling;
@@ -175,9 +181,11 @@ std::array<double, 2> DSPCore::processFrame(double in0, double in1)
   return {in0, in1};
 }
 
+template<typename Sample>
 void DSPCore::process(
-  const size_t length, const float *in0, const float *in1, float *out0, float *out1)
+  const size_t length, const Sample *in0, const Sample *in1, Sample *out0, Sample *out1)
 {
+  SmootherCommon<double>::Scope smootherScope(smootherState);
   ScopedNoDenormals scopedDenormals;
 
   using ID = ParameterID::ID;
@@ -223,8 +231,15 @@ void DSPCore::process(
   }
 }
 
+template void DSPCore::process<float>(
+  const size_t length, const float *in0, const float *in1, float *out0, float *out1);
+template void DSPCore::process<double>(
+  const size_t length, const double *in0, const double *in1, double *out0, double *out1);
+
 void DSPCore::noteOn(NoteInfo &info)
 {
+  SmootherCommon<double>::Scope smootherScope(smootherState);
+
   notePitch.push(calcNotePitch(info.pitch));
 
   noteStack.push_back(info);
@@ -232,6 +247,8 @@ void DSPCore::noteOn(NoteInfo &info)
 
 void DSPCore::noteOff(int_fast32_t noteId)
 {
+  SmootherCommon<double>::Scope smootherScope(smootherState);
+
   auto it = std::find_if(noteStack.begin(), noteStack.end(), [&](const NoteInfo &info) {
     return info.id == noteId;
   });
@@ -8,15 +8,17 @@
 #include <algorithm>
 #include <numeric>
 
-inline float maxAbs(const size_t length, const float *buffer)
+template<typename Sample> inline Sample maxAbs(const size_t length, const Sample *buffer)
 {
-  float max = 0.0f;
+  Sample max = 0;
   for (size_t i = 0; i < length; ++i) max = std::max(max, std::fabs(buffer[i]));
   return max;
 }
 
 void DSPCore::setup(double sampleRate)
 {
+  SmootherCommon<float>::Scope smootherScope(smootherState);
+
   this->sampleRate = float(sampleRate);
 
   SmootherCommon<float>::setSampleRate(this->sampleRate);
@@ -27,6 +29,8 @@ void DSPCore::setup(double sampleRate)
 
 void DSPCore::reset()
 {
+  SmootherCommon<float>::Scope smootherScope(smootherState);
+
   using ID = ParameterID::ID;
   auto &pv = param.value;
 
@@ -44,6 +48,8 @@ void DSPCore::startup() {}
 
 size_t DSPCore::getLatency()
 {
+  SmootherCommon<float>::Scope smootherScope(smootherState);
+
   auto &&latency = activateLimiter ? limiter[0].latency() : 0;
   latency += oversample ? shaper[0].latency() : 0;
   return latency;
@@ -51,6 +57,8 @@ size_t DSPCore::getLatency()
 
 void DSPCore::setParameters()
 {
+  SmootherCommon<float>::Scope smootherScope(smootherState);
+
   using ID = ParameterID::ID;
   auto &pv = param.value;
 
@@ -74,9 +82,11 @@ void DSPCore::setParameters()
   }
 }
 
+template<typename Sample>
 void DSPCore::process(
-  const size_t length, const float *in0, const float *in1, float *out0, float *out1)
+  const size_t length, const Sample *in0, const Sample *in1, Sample *out0, Sample *out1)
 {
+  SmootherCommon<float>::Scope smootherScope(smootherState);
   ScopedNoDenormals scopedDenormals;
 
   SmootherCommon<float>::setBufferSize(float(length));
@@ -112,3 +122,8 @@ void DSPCore::process(
     out1[i] = frame[1];
   }
 }
+
+template void DSPCore::process<float>(
+  const size_t length, const float *in0, const float *in1, float *out0, float *out1);
+template void DSPCore::process<double>(
+  const size_t length, const double *in0, const double *in1, double *out0, double *out1);
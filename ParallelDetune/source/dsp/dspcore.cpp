@@ -23,6 +23,8 @@ template<typename T> inline T freqToSvfG(T normalizedFreq)
 
 void DSPCore::setup(double sampleRate)
 {
+  SmootherCommon<double>::Scope smootherScope(smootherState);
+
   this->sampleRate = double(sampleRate);
   upRate = double(sampleRate) * upFold;
 
@@ -89,6 +91,8 @@ size_t DSPCore::getLatency() { return 0; }
 
 void DSPCore::reset()
 {
+  SmootherCommon<double>::Scope smootherScope(smootherState);
+
   ASSIGN_PARAMETER(reset);
 
   midiNotes.clear();
@@ -113,10 +117,17 @@ void DSPCore::reset()
 
 void DSPCore::startup() { synchronizer.reset(upRate, tempo, getTempoSyncInterval()); }
 
-void DSPCore::setParameters() { ASSIGN_PARAMETER(push); }
+void DSPCore::setParameters()
+{
+  SmootherCommon<double>::Scope smootherScope(smootherState);
+
+  ASSIGN_PARAMETER(push);
+}
 
 std::array<double, 2> DSPCore::processFrame(double in0, double in1)
 {
+  SmootherCommon<double>::Scope smootherScope(smootherState);
+
   notePitch.process(pitchSmoothingKp);
 
   lfoPhaseConstant.process();
@@ -217,9 +228,11 @@ std::array<double, 2> DSPCore::processFrame(double in0, double in1)
   return {in0, in1};
 }
 
+template<typename Sample>
 void DSPCore::process(
-  const size_t length, const float *in0, const float *in1, float *out0, float *out1)
+  const size_t length, const Sample *in0, const Sample *in1, Sample *out0, Sample *out1)
 {
+  SmootherCommon<double>::Scope smootherScope(smootherState);
   ScopedNoDenormals scopedDenormals;
 
   using ID = ParameterID::ID;
@@ -248,8 +261,15 @@ void DSPCore::process(
   }
 }
 
+template void DSPCore::process<float>(
+  const size_t length, const float *in0, const float *in1, float *out0, float *out1);
+template void DSPCore::process<double>(
+  const size_t length, const double *in0, const double *in1, double *out0, double *out1);
+
 void DSPCore::noteOn(NoteInfo &info)
 {
+  SmootherCommon<double>::Scope smootherScope(smootherState);
+
   notePitch.push(calcNotePitch(info.pitch));
 
   noteStack.push_back(info);
@@ -257,6 +277,8 @@ void DSPCore::noteOn(NoteInfo &info)
 
 void DSPCore::noteOff(int_fast32_t noteId)
 {
+  SmootherCommon<double>::Scope smootherScope(smootherState);
+
   auto it = std::find_if(noteStack.begin(), noteStack.end(), [&](const NoteInfo &info) {
     return info.id == noteId;
   });
@@ -35,6 +35,8 @@ float DSPCore::getTempoSyncInterval()
 
 void DSPCore::setup(double sampleRate)
 {
+  SmootherCommon<float>::Scope smootherScope(smootherState);
+
   this->sampleRate = float(sampleRate);
 
   phaseSyncCutoffKp = float(EMAFilter<double>::cutoffToP(sampleRate, 0.1));
@@ -96,6 +98,8 @@ size_t DSPCore::getLatency() { return 0; }
 
 void DSPCore::reset()
 {
+  SmootherCommon<float>::Scope smootherScope(smootherState);
+
   ASSIGN_PARAMETER(reset);
 
   midiNotes.clear();
@@ -115,10 +119,17 @@ void DSPCore::reset()
 
 void DSPCore::startup()
 {
+  SmootherCommon<float>::Scope smootherScope(smootherState);
+
   synchronizer.reset(sampleRate * OverSampler::fold, tempo, getTempoSyncInterval());
 }
 
-void DSPCore::setParameters() { ASSIGN_PARAMETER(push); }
+void DSPCore::setParameters()
+{
+  SmootherCommon<float>::Scope smootherScope(smootherState);
+
+  ASSIGN_PARAMETER(push);
+}
 
 inline void convertToMidSide(float &left, float &right)
 {
@@ -142,9 +153,11 @@ inline std::array<float, 2> getStereoLean(float value, float lean)
   return {value, value * (float(1) - lean)};
 }
 
+template<typename Sample>
 void DSPCore::process(
-  const size_t length, const float *in0, const float *in1, float *out0, float *out1)
+  const size_t length, const Sample *in0, const Sample *in1, Sample *out0, Sample *out1)
 {
+  SmootherCommon<float>::Scope smootherScope(smootherState);
   ScopedNoDenormals scopedDenormals;
 
   using ID = ParameterID::ID;
@@ -248,8 +261,15 @@ void DSPCore::process(
   }
 }
 
+template void DSPCore::process<float>(
+  const size_t length, const float *in0, const float *in1, float *out0, float *out1);
+template void DSPCore::process<double>(
+  const size_t length, const double *in0, const double *in1, double *out0, double *out1);
+
 void DSPCore::noteOn(NoteInfo &info)
 {
+  SmootherCommon<float>::Scope smootherScope(smootherState);
+
   notePitchMultiplier = calcNotePitch(info.pitch);
   updateDelayTime();
 
@@ -258,6 +278,8 @@ void DSPCore::noteOn(NoteInfo &info)
 
 void DSPCore::noteOff(int_fast32_t noteId)
 {
+  SmootherCommon<float>::Scope smootherScope(smootherState);
+
   auto it = std::find_if(noteStack.begin(), noteStack.end(), [&](const NoteInfo &info) {
     return info.id == noteId;
   });
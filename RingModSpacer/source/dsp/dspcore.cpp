@@ -45,6 +45,8 @@ template<typename T> inline T crossPhase(T phase0, T phase1, T ratio)
 
 void DSPCore::setup(double sampleRate)
 {
+  SmootherCommon<double>::Scope smootherScope(smootherState);
+
   this->sampleRate = double(sampleRate);
 
   SmootherCommon<double>::setSampleRate(sampleRate);
@@ -100,6 +102,8 @@ size_t DSPCore::getLatency()
 
 void DSPCore::reset()
 {
+  SmootherCommon<double>::Scope smootherScope(smootherState);
+
   ASSIGN_PARAMETER(reset);
 
   for (auto &x : delay) x.reset();
@@ -110,10 +114,17 @@ void DSPCore::reset()
 
 void DSPCore::startup() {}
 
-void DSPCore::setParameters() { ASSIGN_PARAMETER(push); }
+void DSPCore::setParameters()
+{
+  SmootherCommon<double>::Scope smootherScope(smootherState);
+
+  ASSIGN_PARAMETER(push);
+}
 
 std::array<double, 2> DSPCore::processFrame(const std::array<double, 4> &frame)
 {
+  SmootherCommon<double>::Scope smootherScope(smootherState);
+
   outputGain.process();
   sideMix.process();
   ringSubtractMix.process();
@@ -141,15 +152,17 @@ std::array<double, 2> DSPCore::processFrame(const std::array<double, 4> &frame)
   return {outputGain.process() * sig0, outputGain.process() * sig1};
 }
 
+template<typename Sample>
 void DSPCore::process(
   const size_t length,
-  const float *in0,
-  const float *in1,
-  const float *in2,
-  const float *in3,
-  float *out0,
-  float *out1)
+  const Sample *in0,
+  const Sample *in1,
+  const Sample *in2,
+  const Sample *in3,
+  Sample *out0,
+  Sample *out1)
 {
+  SmootherCommon<double>::Scope smootherScope(smootherState);
   ScopedNoDenormals scopedDenormals;
 
   using ID = ParameterID::ID;
@@ -163,3 +176,20 @@ void DSPCore::process(
     out1[i] = frame[1];
   }
 }
+
+template void DSPCore::process<float>(
+  const size_t length,
+  const float *in0,
+  const float *in1,
+  const float *in2,
+  const float *in3,
+  float *out0,
+  float *out1);
+template void DSPCore::process<double>(
+  const size_t length,
+  const double *in0,
+  const double *in1,
+  const double *in2,
+  const double *in3,
+  double *out0,
+  double *out1);
@@ -16,6 +16,7 @@ public:
   DSPCore() {}
 
   GlobalParameter param;
+  SmootherState<double> smootherState;
   bool isPlaying = false;
 
   void setup(double sampleRate);
@@ -23,14 +24,15 @@ public:
   void startup();
   size_t getLatency();
   void setParameters();
+  template<typename Sample>
   void process(
     const size_t length,
-    const float *in0,
-    const float *in1,
-    const float *in2,
-    const float *in3,
-    float *out0,
-    float *out1);
+    const Sample *in0,
+    const Sample *in1,
+    const Sample *in2,
+    const Sample *in3,
+    Sample *out0,
+    Sample *out1);
 
 private:
   std::array<double, 2> processFrame(const std::array<double, 4> &frame);
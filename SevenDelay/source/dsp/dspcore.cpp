@@ -35,6 +35,8 @@ template<typename T> inline T calcNotePitch(T note)
 
 void DSPCore::setup(double sampleRate)
 {
+  SmootherCommon<double>::Scope smootherScope(smootherState);
+
   SmootherCommon<double>::setSampleRate(double(sampleRate));
 
   for (size_t i = 0; i < delay.size(); ++i)
@@ -53,6 +55,8 @@ void DSPCore::setup(double sampleRate)
 
 void DSPCore::reset()
 {
+  SmootherCommon<double>::Scope smootherScope(smootherState);
+
   midiNotes.clear();
   noteStack.clear();
   notePitchMultiplier = double(1);
@@ -67,12 +71,16 @@ void DSPCore::reset()
 
 void DSPCore::startup()
 {
+  SmootherCommon<double>::Scope smootherScope(smootherState);
+
   delayOut.fill({});
   lfoPhase = param.value[ParameterID::lfoInitialPhase]->getDouble();
 }
 
 void DSPCore::setParameters()
 {
+  SmootherCommon<double>::Scope smootherScope(smootherState);
+
   SmootherCommon<double>::setTime(param.value[ParameterID::smoothness]->getDouble());
 
   // This won't work if sync is on and tempo < 15. Up to 8 sec or 8/16 beat.
@@ -115,9 +123,11 @@ void DSPCore::setParameters()
     Scales::dckillMix.reverseMap(param.value[ParameterID::dckill]->getNormalized())));
 }
 
+template<typename Sample>
 void DSPCore::process(
-  const size_t length, const float *in0, const float *in1, float *out0, float *out1)
+  const size_t length, const Sample *in0, const Sample *in1, Sample *out0, Sample *out1)
 {
+  SmootherCommon<double>::Scope smootherScope(smootherState);
   ScopedNoDenormals scopedDenormals;
 
   SmootherCommon<double>::setBufferSize(double(length));
@@ -177,8 +187,15 @@ void DSPCore::process(
   }
 }
 
+template void DSPCore::process<float>(
+  const size_t length, const float *in0, const float *in1, float *out0, float *out1);
+template void DSPCore::process<double>(
+  const size_t length, const double *in0, const double *in1, double *out0, double *out1);
+
 void DSPCore::noteOn(NoteInfo &info)
 {
+  SmootherCommon<double>::Scope smootherScope(smootherState);
+
   notePitchMultiplier = calcNotePitch(info.pitch);
   updateDelayTime();
 
@@ -187,6 +204,8 @@ void DSPCore::noteOn(NoteInfo &info)
 
 void DSPCore::noteOff(int_fast32_t noteId)
 {
+  SmootherCommon<double>::Scope smootherScope(smootherState);
+
   auto it = std::find_if(noteStack.begin(), noteStack.end(), [&](const NoteInfo &info) {
     return info.id == noteId;
   });
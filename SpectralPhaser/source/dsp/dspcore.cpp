@@ -13,6 +13,8 @@ using Sample = DSPCore::Sample;
 
 void DSPCore::setup(double sampleRate)
 {
+  SmootherCommon<Sample>::Scope smootherScope(smootherState);
+
   this->sampleRate = Sample(sampleRate);
 
   SmootherCommon<Sample>::setSampleRate(sampleRate);
@@ -23,7 +25,11 @@ void DSPCore::setup(double sampleRate)
   startup();
 }
 
-size_t DSPCore::getLatency() { return spcParam.reportLatency ? spcParam.frmSize : 0; }
+size_t DSPCore::getLatency()
+{
+  // Frame processing is spread over a frame when latency is reported.
+  return spcParam.reportLatency ? 2 * spcParam.frmSize : 0;
+}
 
 #define ASSIGN_PARAMETER(METHOD)                                                         \
   using ID = ParameterID::ID;                                                            \
@@ -74,6 +80,8 @@ size_t DSPCore::getLatency() { return spcParam.reportLatency ? spcParam.frmSize
 
 void DSPCore::reset()
 {
+  SmootherCommon<Sample>::Scope smootherScope(smootherState);
+
   ASSIGN_PARAMETER(reset);
 
   lfoTargetFreq = getTempoSyncFrequency();
@@ -85,7 +93,12 @@ void DSPCore::reset()
 
 void DSPCore::startup() {}
 
-void DSPCore::setParameters() { ASSIGN_PARAMETER(push); }
+void DSPCore::setParameters()
+{
+  SmootherCommon<Sample>::Scope smootherScope(smootherState);
+
+  ASSIGN_PARAMETER(push);
+}
 
 // Output range is in [0, 1].
 inline Sample phaseToWave(Sample phase, Sample mod, LfoWaveform waveform)
@@ -180,15 +193,17 @@ DSPCore::processFrame(int frameIndex, Sample in0, Sample in1, Sample side0, Samp
   };
 }
 
+template<typename IOSample>
 void DSPCore::process(
   const size_t length,
-  const float *in0,
-  const float *in1,
-  const float *side0,
-  const float *side1,
-  float *out0,
-  float *out1)
+  const IOSample *in0,
+  const IOSample *in1,
+  const IOSample *side0,
+  const IOSample *side1,
+  IOSample *out0,
+  IOSample *out1)
 {
+  SmootherCommon<Sample>::Scope smootherScope(smootherState);
   ScopedNoDenormals scopedDenormals;
 
   using ID = ParameterID::ID;
@@ -205,6 +220,23 @@ void DSPCore::process(
   }
 }
 
+template void DSPCore::process<float>(
+  const size_t length,
+  const float *in0,
+  const float *in1,
+  const float *side0,
+  const float *side1,
+  float *out0,
+  float *out1);
+template void DSPCore::process<double>(
+  const size_t length,
+  const double *in0,
+  const double *in1,
+  const double *side0,
+  const double *side1,
+  double *out0,
+  double *out1);
+
 Sample DSPCore::getTempoSyncFrequency()
 {
   using ID = ParameterID::ID;
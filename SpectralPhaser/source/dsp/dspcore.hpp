@@ -17,6 +17,7 @@ public:
   using Sample = float;
 
   GlobalParameter param;
+  SmootherState<Sample> smootherState;
   bool isPlaying = false;
   float tempo = 120.0f;
   double beatsElapsed = 0.0f;
@@ -28,14 +29,15 @@ public:
   void startup();
   size_t getLatency();
   void setParameters();
+  template<typename IOSample>
   void process(
     const size_t length,
-    const float *in0,
-    const float *in1,
-    const float *side0,
-    const float *side1,
-    float *out0,
-    float *out1);
+    const IOSample *in0,
+    const IOSample *in1,
+    const IOSample *side0,
+    const IOSample *side1,
+    IOSample *out0,
+    IOSample *out1);
 
 private:
   static constexpr size_t tableSize = size_t(1) << maxFrameSizeLog2;
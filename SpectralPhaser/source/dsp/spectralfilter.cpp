@@ -1,12 +0,0 @@
-// SPDX-License-Identifier: GPL-3.0-only
-// Copyright Takamitsu Endo (ryukau@gmail.com)
-
-#pragma once
-
-#include "spectralfilter.hpp"
-
-namespace SomeDSP {
-
-std::mutex fftwMutex;
-
-} // namespace SomeDSP
@@ -3,113 +3,21 @@
 
 #pragma once
 
-#include "../../../lib/fftw3/fftw3.h"
+#include "../../../common/dsp/fft.hpp"
 #include "../parameter.hpp"
 #include "spectralmask.hpp"
+#include "splitfft.hpp"
 
 #include <algorithm>
 #include <array>
 #include <cmath>
 #include <complex>
+#include <cstdint>
 #include <limits>
-#include <mutex>
 #include <numbers>
-#include <numeric>
 
 namespace SomeDSP {
 
-// `fftwMutex` is used to lock FFTW3 calls except `fftw*_execute`. In other words, FFTW3
-// isn't thread safe except `fftw*_execute` call.
-extern std::mutex fftwMutex;
-
-// Fast Walsh-Hadamard transform. In-place.
-template<typename T> void fwht(int N, T *seq, bool inverse = false)
-{
-  for (int h = 2; h <= N; h *= 2) {
-    int hf = h / 2;
-    for (int i = 0; i < N; i += h) {
-      for (int j = 0; j < hf; ++j) {
-        auto u = seq[i + j];
-        auto v = seq[i + j + hf];
-        seq[i + j] = u + v;
-        seq[i + j + hf] = u - v;
-      }
-    }
-  }
-  if (inverse) {
-    for (int i = 0; i < N; ++i) seq[i] /= N;
-  }
-}
-
-// Fast Walsh-Hadamard transform. Out-of-place.
-template<typename T> void fwht(int N, T *x, T *y, bool inverse = false)
-{
-  for (int h = 2; h <= N; h *= 2) {
-    int hf = h / 2;
-    for (int i = 0; i < N; i += h) {
-      for (int j = 0; j < hf; ++j) {
-        auto u = x[i + j];
-        auto v = x[i + j + hf];
-        y[i + j] = u + v;
-        y[i + j + hf] = u - v;
-      }
-    }
-  }
-  if (inverse) {
-    for (int i = 0; i < N; ++i) x[i] /= N;
-  }
-}
-
-// Out-of-place. No scaling on forward transform.
-template<typename T> void haarTransformForward(int N, T *x, T *y)
-{
-  std::fill(y, y + N, T(0));
-  y[0] = std::accumulate(x, x + N, T(0));
-
-  auto size = N;
-  auto half = size / 2;
-  auto start = 0;
-  for (int row = 1; row < N; ++row) {
-    for (int idx = 0; idx < size; ++idx) {
-      auto w = x[start + idx];
-      y[row] += idx < half ? w : -w;
-    }
-
-    start += size;
-    if (start >= N) {
-      start = 0;
-      size /= 2;
-      half /= 2;
-    }
-  }
-}
-
-// Out-of-place.
-template<typename T> void haarTransformBackward(int N, T *x, T *y)
-{
-  auto scaler = T(1) / T(N);
-
-  std::fill(y, y + N, scaler * x[0]);
-
-  auto size = N;
-  auto half = size / 2;
-  auto start = 0;
-  for (int row = 1; row < N; ++row) {
-    for (int idx = 0; idx < size; ++idx) {
-      auto w = scaler * x[row];
-      y[start + idx] += idx < half ? w : -w;
-    }
-
-    start += size;
-    if (start >= N) {
-      start = 0;
-      size /= 2;
-      half /= 2;
-      scaler *= 2;
-    }
-  }
-}
-
 inline int bitReversal(int n, int k)
 {
   int r = 0;
@@ -133,239 +41,550 @@ template<int maxFrameSizeLog2> struct SideChainMask {
   static constexpr int maxFrameSize = int(1) << maxFrameSizeLog2;
   static constexpr int maxSpectrumSize = maxFrameSize / 2 + 1;
 
-  float *bufW = nullptr;                  // buffer for write.
-  float *bufMask = nullptr;               // buffer for read.
-  std::complex<float> *spcMask = nullptr; // spectrum.
+  // Double buffered. One is written while the other is used by a frame job.
+  std::array<FftwBuffer<float>, 2> buf;
+  int wIdx = 0;
 
-  static constexpr int planIndexOffset = 2; // Starts from 2^2.
-  static constexpr int nPlan = maxFrameSizeLog2 - planIndexOffset + 1;
-  std::array<fftwf_plan, nPlan> forwardPlan;
+  FftwBuffer<float> bufMask{maxFrameSize};                  // buffer for read.
+  FftwBuffer<std::complex<float>> spcMask{maxSpectrumSize}; // spectrum.
 
   SideChainMask()
   {
-    const std::lock_guard<std::mutex> fftwLock(fftwMutex);
-
-    bufW = (float *)fftwf_malloc(sizeof(float) * maxFrameSize);
-    bufMask = (float *)fftwf_malloc(sizeof(float) * maxFrameSize);
-    spcMask = (std::complex<float> *)fftwf_malloc(
-      sizeof(std::complex<float>) * maxSpectrumSize);
-    for (int idx = 0; idx < nPlan; ++idx) {
-      const auto spc_ = reinterpret_cast<fftwf_complex *>(spcMask);
-      const int length = int(1) << (idx + 2);
-      forwardPlan[idx] = fftwf_plan_dft_r2c_1d(length, bufW, spc_, FFTW_ESTIMATE);
-    }
-
+    for (auto &bf : buf) bf.resize(maxFrameSize);
     reset();
   }
 
-  ~SideChainMask()
-  {
-    const std::lock_guard<std::mutex> fftwLock(fftwMutex);
-
-    for (auto &x : forwardPlan) fftwf_destroy_plan(x);
-    if (spcMask) fftwf_free(spcMask);
-    if (bufMask) fftwf_free(bufMask);
-    if (bufW) fftwf_free(bufW);
-  }
-
   void reset(int indexOffset = 0)
   {
-    std::fill(bufW, bufW + maxFrameSize, float(0));
-    std::fill(bufMask, bufMask + maxFrameSize, float(0));
-    std::fill(spcMask, spcMask + maxSpectrumSize, std::complex<float>{0, 0});
+    wIdx = 0;
+    for (auto &bf : buf) std::fill(bf.begin(), bf.end(), float(0));
+    std::fill(bufMask.begin(), bufMask.end(), float(0));
+    std::fill(spcMask.begin(), spcMask.end(), std::complex<float>{0, 0});
   }
 
-  void push(float input, const int bufIndex) { bufW[bufIndex] = input; }
-  void processFft(const int planIndex) { fftwf_execute(forwardPlan[planIndex]); }
-  void processFwht(const int size) { fwht(size, bufW, bufMask, false); }
-  void processHaar(const int size) { haarTransformForward(size, bufW, bufMask); }
+  void push(float input, const int bufIndex) { buf[wIdx][bufIndex] = input; }
+
+  // Called on frame boundary. The written frame becomes the input of frame job.
+  void swap() { wIdx ^= 1; }
+
+  float *frame() { return buf[wIdx ^ 1].data(); }
 };
 
+/**
+A frame job is a list of tasks, and a task is a range of units. A unit is an element, a
+butterfly, or a bin, except that a leaf of `SplitRealFft` or a whole FFT is a unit.
+`Task::unitCost` is the rough cost of a unit in element operations.
+
+When `prm.reportLatency` is 0, the whole job runs on the sample of frame boundary.
+Otherwise, the job is spread over the next frame, and the result is read from the frame
+after that. This adds 1 frame of latency. Each sample runs units until the cost done
+reaches `totalCost * (bufIndex + 1) / frmSize`, so the work of a sample is the average
+plus at most one unit. FFT larger than `leafSize` is split by `SplitRealFft`, and FWHT
+and Haar transform are split into stages.
+
+Rotation of feedback state is merged into the filter task by double buffering the
+state. The part of the state beyond current frame is copied, so that it's kept as is.
+
+3 buffers rotate between following roles.
+- `wIdx`: Input is written.
+- `fIdx`: Input of a frame job. The result is written in place.
+- `rIdx`: Result of a frame job, which is read as output.
+*/
 template<int maxFrameSizeLog2> struct SpectralDelay {
 public:
   static constexpr int maxFrameSize = int(1) << maxFrameSizeLog2;
   static constexpr int maxSpectrumSize = maxFrameSize / 2 + 1;
 
-  int bufIndex = 0;
+  static constexpr int leafSizeLog2 = 7;
+  using SplitFft = SplitRealFft<maxFrameSizeLog2, leafSizeLog2>;
+
+  enum class Kind : uint8_t {
+    fft,
+    fftSplit,
+    ifft,
+    ifftSplit,
+    fwht,
+    haarSum,
+    haarForward,
+    haarFill,
+    haarBackward,
+    sideGain,
+    mask,
+    filter,
+  };
+
+  struct Task {
+    Kind kind = Kind::fft;
+    int arg = 0; // Stage of `SplitFft`, level of FWHT or Haar, or pass of mask.
+    bool isSide = false;
+    int nUnit = 0;
+    int unitCost = 1;
+  };
 
-  float *bufW = nullptr;   // buffer for write.
-  float *bufR = nullptr;   // buffer for read.
-  float *bufTmp = nullptr; // temporary buffer.
-
-  std::complex<float> *spcSrc = nullptr; // source spectrum.
-  std::complex<float> *spcTmp = nullptr; // temporary spectrum.
+  int bufIndex = 0;
+  bool isFrameReady = false;
+  SpectralParameter framePrm;
+
+  // Haar transform with side chain uses the most, which is `3 * frameSizeLog2 + 9`.
+  static constexpr int maxTask = 4 * (maxFrameSizeLog2 + 1);
+  std::array<Task, maxTask> tasks;
+  int nTask = 0;
+  int taskIndex = 0;
+  int unitIndex = 0;
+  int64_t totalCost = 0;
+  int64_t doneCost = 0;
+
+  // Values of filter task, which are fixed for a frame.
+  int spcShift = 0;
+  int rotIdx = 0;
+  float rotation = 0;
+
+  std::array<FftwBuffer<float>, 3> buf;
+  int wIdx = 0;
+  int fIdx = 1;
+  int rIdx = 2;
+
+  // Feedback state of FWHT and Haar. Double buffered.
+  std::array<FftwBuffer<float>, 2> bufState;
+  int stateIdx = 0;
+  int stateSize = 0;
+
+  FftwBuffer<float> bufTmp{maxFrameSize}; // temporary buffer.
+
+  FftwBuffer<std::complex<float>> spcSrc{maxSpectrumSize}; // source spectrum.
+
+  // Feedback state of FFT. Double buffered.
+  std::array<FftwBuffer<std::complex<float>>, 2> spcTmp;
+  int spcIdx = 0;
+  int spcSize = 0;
 
   std::array<float, maxFrameSize> mask{};
+  MaskFiller maskFiller;
 
   static constexpr int planIndexOffset = 2; // Starts from 2^2.
   static constexpr int nPlan = maxFrameSizeLog2 - planIndexOffset + 1;
-  std::array<fftwf_plan, nPlan> forwardPlan;
-  std::array<fftwf_plan, nPlan> inversePlan;
+  std::array<RealForwardFft, nPlan> forwardFft;
+  std::array<RealInverseFft, nPlan> inverseFft;
+  SplitFft splitFft;
 
   SideChainMask<maxFrameSizeLog2> side;
 
   SpectralDelay()
   {
-    const std::lock_guard<std::mutex> fftwLock(fftwMutex);
-
-    bufW = (float *)fftwf_malloc(sizeof(float) * maxFrameSize);
-    bufR = (float *)fftwf_malloc(sizeof(float) * maxFrameSize);
-    bufTmp = (float *)fftwf_malloc(sizeof(float) * maxFrameSize);
-
-    constexpr int spcAllocSize = sizeof(std::complex<float>) * maxSpectrumSize;
-    spcSrc = (std::complex<float> *)fftwf_malloc(spcAllocSize);
-    spcTmp = (std::complex<float> *)fftwf_malloc(spcAllocSize);
-
+    for (auto &bf : buf) bf.resize(maxFrameSize);
+    for (auto &bf : bufState) bf.resize(maxFrameSize);
+    for (auto &sp : spcTmp) sp.resize(maxSpectrumSize);
     for (int idx = 0; idx < nPlan; ++idx) {
-      const auto spc_ = reinterpret_cast<fftwf_complex *>(spcSrc);
-      const int length = int(1) << (idx + 2);
-      forwardPlan[idx] = fftwf_plan_dft_r2c_1d(length, bufW, spc_, FFTW_ESTIMATE);
-      inversePlan[idx] = fftwf_plan_dft_c2r_1d(length, spc_, bufR, FFTW_ESTIMATE);
+      const size_t length = size_t(1) << (idx + 2);
+      forwardFft[idx].init(length, buf[0].data(), spcSrc.data());
+      inverseFft[idx].init(length, spcSrc.data(), buf[0].data());
     }
 
     reset();
   }
 
-  ~SpectralDelay()
-  {
-    const std::lock_guard<std::mutex> fftwLock(fftwMutex);
-
-    for (auto &x : inversePlan) fftwf_destroy_plan(x);
-    for (auto &x : forwardPlan) fftwf_destroy_plan(x);
-
-    if (spcTmp) fftwf_free(spcTmp);
-    if (spcSrc) fftwf_free(spcSrc);
-
-    if (bufTmp) fftwf_free(bufTmp);
-    if (bufR) fftwf_free(bufR);
-    if (bufW) fftwf_free(bufW);
-  }
-
   void reset(int indexOffset = 0)
   {
     bufIndex = indexOffset;
-    std::fill(bufW, bufW + maxFrameSize, float(0));
-    std::fill(bufR, bufR + maxFrameSize, float(0));
-    std::fill(bufTmp, bufTmp + maxFrameSize, float(0));
-    std::fill(spcSrc, spcSrc + maxSpectrumSize, std::complex<float>{0, 0});
-    std::fill(spcTmp, spcTmp + maxSpectrumSize, std::complex<float>{0, 0});
+    isFrameReady = false;
+    nTask = 0;
+    taskIndex = 0;
+    unitIndex = 0;
+    totalCost = 0;
+    doneCost = 0;
+    wIdx = 0;
+    fIdx = 1;
+    rIdx = 2;
+    for (auto &bf : buf) std::fill(bf.begin(), bf.end(), float(0));
+    for (auto &bf : bufState) std::fill(bf.begin(), bf.end(), float(0));
+    stateIdx = 0;
+    stateSize = 0;
+    std::fill(bufTmp.begin(), bufTmp.end(), float(0));
+    std::fill(spcSrc.begin(), spcSrc.end(), std::complex<float>{0, 0});
+    for (auto &sp : spcTmp) std::fill(sp.begin(), sp.end(), std::complex<float>{0, 0});
+    spcIdx = 0;
+    spcSize = 0;
     mask.fill({});
     side.reset();
   }
 
   float process(float input, float sideIn, SpectralParameter &prm)
   {
-    const auto output = bufR[bufIndex];
-    bufW[bufIndex] = input;
+    const auto output = buf[rIdx][bufIndex];
+    buf[wIdx][bufIndex] = input;
     side.push(sideIn, bufIndex);
-    if (++bufIndex < prm.frmSize) return output;
-    bufIndex = 0;
 
-    const auto planIndex = prm.frameSizeLog2 - planIndexOffset;
-    fftwf_execute(forwardPlan[planIndex]);
+    if (taskIndex < nTask) runTasks(totalCost * (bufIndex + 1) / framePrm.frmSize);
 
-    const auto spectrumSize = prm.frmSize / 2 + 1;
+    if (++bufIndex < prm.frmSize) return output;
+    bufIndex = 0;
 
-    if (prm.sideChain) {
-      side.processFft(planIndex);
-      const auto gain = float(1) / std::sqrt(float(prm.frmSize));
-      for (int idx = 0; idx < spectrumSize; ++idx) {
-        spcSrc[idx] *= std::abs(side.spcMask[idx]) * gain;
-      }
+    finishFrame();
+    framePrm = prm;
+    side.swap();
+
+    if (prm.reportLatency) {
+      if (!isFrameReady) std::fill(buf[fIdx].begin(), buf[fIdx].end(), float(0));
+      std::swap(rIdx, fIdx);
+      std::swap(fIdx, wIdx);
+      startFrame();
+      isFrameReady = true;
+    } else {
+      std::swap(wIdx, fIdx);
+      startFrame();
+      finishFrame();
+      std::swap(rIdx, fIdx);
+      isFrameReady = false;
     }
+    return output;
+  }
 
-    fillMask(spectrumSize, mask.data(), prm);
+private:
+  void finishFrame() { runTasks(std::numeric_limits<int64_t>::max()); }
 
-    const int spcShift = prm.spectralShift * spectrumSize;
-    std::rotate(spcTmp, spcTmp + spcShift, spcTmp + spectrumSize);
+  void addTask(Kind kind, int arg, bool isSide, int nUnit, int unitCost = 1)
+  {
+    tasks[nTask++] = {kind, arg, isSide, nUnit, unitCost};
+    totalCost += int64_t(nUnit) * unitCost;
+  }
 
-    for (int idx = 0; idx < spectrumSize; ++idx) {
-      spcTmp[idx] *= prm.feedback;
-      const auto maskValue = mask[idx] > prm.maskThreshold ? mask[idx] : float(0);
-      spcTmp[idx] += spcSrc[idx] / float(prm.frmSize) * maskValue;
-      spcSrc[idx]
-        = spcTmp[idx] * std::polar(std::abs(maskValue), prm.maskRotation * mask[idx]);
+  void addFft(bool isSide)
+  {
+    const auto log2 = framePrm.frameSizeLog2;
+    if (!framePrm.reportLatency || !SplitFft::isSplit(log2)) {
+      addTask(Kind::fft, 0, isSide, 1, framePrm.frmSize * log2 / 2);
+      return;
+    }
+    for (int stage = 0; stage <= SplitFft::nLevel(log2); ++stage) {
+      const auto cost = stage == 0 ? SplitFft::leafCost : 1;
+      addTask(Kind::fftSplit, stage, isSide, SplitFft::forwardUnits(log2, stage), cost);
     }
-
-    fftwf_execute(inversePlan[planIndex]);
-    return output;
   }
 
-  float processFwht(float input, float sideIn, SpectralParameter &prm)
+  void addInverseFft()
   {
-    const auto output = bufW[bufIndex];
-    bufW[bufIndex] = input;
-    side.push(sideIn, bufIndex);
-    if (++bufIndex < prm.frmSize) return output;
-    bufIndex = 0;
+    const auto log2 = framePrm.frameSizeLog2;
+    if (!framePrm.reportLatency || !SplitFft::isSplit(log2)) {
+      addTask(Kind::ifft, 0, false, 1, framePrm.frmSize * log2 / 2);
+      return;
+    }
+    const auto nLevel = SplitFft::nLevel(log2);
+    for (int stage = 0; stage <= nLevel; ++stage) {
+      const auto cost = stage == nLevel ? SplitFft::leafCost : 1;
+      addTask(Kind::ifftSplit, stage, false, SplitFft::inverseUnits(log2, stage), cost);
+    }
+  }
 
-    fwht(prm.frmSize, bufW, false);
+  void addFwht()
+  {
+    for (int level = 0; level < framePrm.frameSizeLog2; ++level) {
+      addTask(Kind::fwht, level, false, framePrm.frmSize / 2);
+    }
+  }
 
-    if (prm.sideChain) {
-      side.processFwht(prm.frmSize);
-      for (int idx = 0; idx < prm.frmSize; ++idx) bufW[idx] *= side.bufMask[idx];
+  void addHaarForward(bool isSide)
+  {
+    addTask(Kind::haarSum, 0, isSide, framePrm.frmSize);
+    for (int level = 0; level < framePrm.frameSizeLog2; ++level) {
+      addTask(Kind::haarForward, level, isSide, framePrm.frmSize);
     }
+  }
 
-    const int spcShift = prm.spectralShift * prm.frmSize;
-    std::rotate(bufR, bufR + spcShift, bufR + prm.frmSize);
+  void addHaarBackward()
+  {
+    addTask(Kind::haarFill, 0, false, framePrm.frmSize);
+    for (int level = 0; level < framePrm.frameSizeLog2; ++level) {
+      addTask(Kind::haarBackward, level, false, framePrm.frmSize);
+    }
+  }
 
-    fillMask(prm.frmSize, mask.data(), prm);
+  // `stateSize` is the size of the state which is kept as is.
+  void addMaskAndFilter(int maskSize, int &stateSize)
+  {
+    maskFiller.start(maskSize, framePrm);
+    for (int pass = 0; pass < maskFiller.nPass(); ++pass) {
+      addTask(Kind::mask, pass, false, maskSize);
+    }
+    stateSize = std::max(stateSize, maskSize);
+    addTask(Kind::filter, 0, false, stateSize);
+  }
 
-    auto rotation = prm.maskRotation / float(2) / std::numbers::pi_v<float>;
+  void startFrame()
+  {
+    auto &prm = framePrm;
+    nTask = 0;
+    taskIndex = 0;
+    unitIndex = 0;
+    totalCost = 0;
+    doneCost = 0;
+
+    rotation = prm.maskRotation / float(2) / std::numbers::pi_v<float>;
     rotation -= std::floor(rotation);
-    int rotIdx = int(prm.frmSize * rotation);
-
-    for (int idx = 0; idx < prm.frmSize; ++idx) {
-      // Using an implementation detail that `prm.frmSize` is always 2^n.
-      const auto permSrc = (idx + rotIdx) & (prm.frmSize - 1);
-      const auto permuted = binaryToGrayCode(bitReversal(permSrc, prm.frameSizeLog2));
-      bufR[idx] *= prm.feedback;
+    rotIdx = int(prm.frmSize * rotation);
 
-      const auto maskValue = mask[idx] > prm.maskThreshold ? mask[idx] : 0;
-      bufR[idx] += bufW[permuted] * maskValue / float(prm.frmSize);
-      bufW[permuted] = bufR[idx] * std::abs(maskValue);
+    switch (prm.transform) {
+      default: { // case TransformType::fft
+        const auto spectrumSize = prm.frmSize / 2 + 1;
+        spcShift = prm.spectralShift * spectrumSize;
+        addFft(false);
+        if (prm.sideChain) {
+          addFft(true);
+          addTask(Kind::sideGain, 0, false, spectrumSize);
+        }
+        addMaskAndFilter(spectrumSize, spcSize);
+        addInverseFft();
+      } break;
+      case TransformType::fwht: {
+        spcShift = prm.spectralShift * prm.frmSize;
+        addFwht();
+        if (prm.sideChain) {
+          // Side chain FWHT reads the input on every level, so only the last level is
+          // left in the output.
+          addTask(Kind::fwht, prm.frameSizeLog2 - 1, true, prm.frmSize / 2);
+          addTask(Kind::sideGain, 0, false, prm.frmSize);
+        }
+        addMaskAndFilter(prm.frmSize, stateSize);
+        addFwht();
+      } break;
+      case TransformType::haar: {
+        spcShift = prm.spectralShift * prm.frmSize;
+        addHaarForward(false);
+        if (prm.sideChain) {
+          addHaarForward(true);
+          addTask(Kind::sideGain, 0, false, prm.frmSize);
+        }
+        addMaskAndFilter(prm.frmSize, stateSize);
+        addHaarBackward();
+      } break;
     }
+  }
 
-    fwht(prm.frmSize, bufW, false);
-    return output;
+  // Runs units until `doneCost` reaches `target`.
+  void runTasks(int64_t target)
+  {
+    while (taskIndex < nTask && doneCost < target) {
+      const auto &task = tasks[taskIndex];
+      const auto budget = (target - doneCost - 1) / task.unitCost + 1;
+      const auto end = int(std::min<int64_t>(task.nUnit, unitIndex + budget));
+      runTask(task, unitIndex, end);
+      doneCost += int64_t(end - unitIndex) * task.unitCost;
+      unitIndex = end;
+      if (unitIndex >= task.nUnit) {
+        ++taskIndex;
+        unitIndex = 0;
+      }
+    }
   }
 
-  float processHaar(float input, float sideIn, SpectralParameter &prm)
+  void runTask(const Task &task, int begin, int end)
   {
-    const auto output = bufW[bufIndex];
-    bufW[bufIndex] = input;
-    side.push(sideIn, bufIndex);
-    if (++bufIndex < prm.frmSize) return output;
-    bufIndex = 0;
+    auto &prm = framePrm;
+    auto frame = buf[fIdx].data();
+    const auto planIndex = prm.frameSizeLog2 - planIndexOffset;
 
-    haarTransformForward(prm.frmSize, bufW, bufTmp);
+    switch (task.kind) {
+      case Kind::fft: {
+        if (task.isSide) {
+          forwardFft[planIndex].execute(side.frame(), side.spcMask.data());
+        } else {
+          forwardFft[planIndex].execute(frame, spcSrc.data());
+        }
+      } break;
+      case Kind::fftSplit: {
+        auto in = task.isSide ? side.frame() : frame;
+        auto out = task.isSide ? side.spcMask.data() : spcSrc.data();
+        splitFft.forward(prm.frameSizeLog2, task.arg, begin, end, in, out);
+      } break;
+      case Kind::ifft: {
+        inverseFft[planIndex].execute(spcSrc.data(), frame);
+      } break;
+      case Kind::ifftSplit: {
+        splitFft.inverse(prm.frameSizeLog2, task.arg, begin, end, spcSrc.data(), frame);
+      } break;
+      case Kind::fwht: {
+        if (task.isSide) {
+          fwhtStage(task.arg, begin, end, side.frame(), side.bufMask.data());
+        } else {
+          fwhtStage(task.arg, begin, end, frame, frame);
+        }
+      } break;
+      case Kind::haarSum: {
+        auto y = task.isSide ? side.bufMask.data() : bufTmp.data();
+        haarSum(begin, end, task.isSide ? side.frame() : frame, y);
+      } break;
+      case Kind::haarForward: {
+        auto y = task.isSide ? side.bufMask.data() : bufTmp.data();
+        haarForward(task.arg, begin, end, task.isSide ? side.frame() : frame, y);
+      } break;
+      case Kind::haarFill: {
+        const auto x0 = bufState[stateIdx][0] / float(prm.frmSize);
+        std::fill(frame + begin, frame + end, x0);
+      } break;
+      case Kind::haarBackward: {
+        haarBackward(task.arg, begin, end, bufState[stateIdx].data(), frame);
+      } break;
+      case Kind::sideGain: {
+        sideGain(begin, end, frame);
+      } break;
+      case Kind::mask: {
+        maskFiller.fill(mask.data(), task.arg, begin, end);
+      } break;
+      case Kind::filter: {
+        filter(begin, end, frame);
+        if (end >= task.nUnit) swapState();
+      } break;
+    }
+  }
 
-    if (prm.sideChain) {
-      side.processHaar(prm.frmSize);
-      for (int idx = 0; idx < prm.frmSize; ++idx) bufTmp[idx] *= side.bufMask[idx];
+  // A level of fast Walsh-Hadamard transform. A unit is a butterfly.
+  void fwhtStage(int level, int begin, int end, const float *x, float *y)
+  {
+    const int hf = int(1) << level;
+    for (int unit = begin; unit < end; ++unit) {
+      const int i = (unit >> level) << (level + 1);
+      const int j = unit & (hf - 1);
+      auto u = x[i + j];
+      auto v = x[i + j + hf];
+      y[i + j] = u + v;
+      y[i + j + hf] = u - v;
     }
+  }
 
-    const int spcShift = prm.spectralShift * prm.frmSize;
-    std::rotate(bufR, bufR + spcShift, bufR + prm.frmSize);
+  // First step of Haar transform. Fills `y` with 0, and sums up `x` to `y[0]`.
+  void haarSum(int begin, int end, const float *x, float *y)
+  {
+    for (int idx = begin; idx < end; ++idx) {
+      if (idx > 0) y[idx] = 0;
+      y[0] = (idx == 0 ? float(0) : y[0]) + x[idx];
+    }
+  }
 
-    auto rotation = prm.maskRotation / float(2) / std::numbers::pi_v<float>;
-    rotation -= std::floor(rotation);
-    int rotIdx = int(prm.frmSize * rotation);
+  // Rows of `level` in forward Haar transform. No scaling. A unit is an element of `x`.
+  void haarForward(int level, int begin, int end, const float *x, float *y)
+  {
+    const int sizeLog2 = framePrm.frameSizeLog2 - level;
+    const int half = int(1) << (sizeLog2 - 1);
+    for (int unit = begin; unit < end; ++unit) {
+      const int idx = unit & ((half << 1) - 1);
+      const auto w = x[unit];
+      y[(int(1) << level) + (unit >> sizeLog2)] += idx < half ? w : -w;
+    }
+  }
 
-    fillMask(prm.frmSize, mask.data(), prm);
-    for (int idx = 0; idx < prm.frmSize; ++idx) {
-      bufR[idx] *= prm.feedback;
+  // Rows of `level` in backward Haar transform. A unit is an element of `y`.
+  void haarBackward(int level, int begin, int end, const float *x, float *y)
+  {
+    const int sizeLog2 = framePrm.frameSizeLog2 - level;
+    const int half = int(1) << (sizeLog2 - 1);
+    const auto scaler = float(int(1) << level) / float(framePrm.frmSize);
+    for (int unit = begin; unit < end; ++unit) {
+      const int idx = unit & ((half << 1) - 1);
+      const auto w = scaler * x[(int(1) << level) + (unit >> sizeLog2)];
+      y[unit] += idx < half ? w : -w;
+    }
+  }
 
-      const auto maskValue = mask[idx] > prm.maskThreshold ? mask[idx] : 0;
-      bufR[idx] *= std::abs(maskValue);
+  void sideGain(int begin, int end, float *frame)
+  {
+    auto &prm = framePrm;
+    switch (prm.transform) {
+      default: { // case TransformType::fft
+        const auto gain = float(1) / std::sqrt(float(prm.frmSize));
+        for (int idx = begin; idx < end; ++idx) {
+          spcSrc[idx] *= std::abs(side.spcMask[idx]) * gain;
+        }
+      } break;
+      case TransformType::fwht: {
+        for (int idx = begin; idx < end; ++idx) frame[idx] *= side.bufMask[idx];
+      } break;
+      case TransformType::haar: {
+        for (int idx = begin; idx < end; ++idx) bufTmp[idx] *= side.bufMask[idx];
+      } break;
+    }
+  }
 
-      const auto src
-        = std::lerp(bufTmp[idx], bufTmp[(idx + rotIdx) & (prm.frmSize - 1)], rotation);
-      bufR[idx] += src * maskValue;
+  void swapState()
+  {
+    switch (framePrm.transform) {
+      default: // case TransformType::fft
+        spcIdx ^= 1;
+        break;
+      case TransformType::fwht:
+      case TransformType::haar:
+        stateIdx ^= 1;
+        break;
     }
+  }
 
-    haarTransformBackward(prm.frmSize, bufR, bufW);
-    return output;
+  void filter(int begin, int end, float *frame)
+  {
+    auto &prm = framePrm;
+    switch (prm.transform) {
+      default: { // case TransformType::fft
+        const auto spectrumSize = prm.frmSize / 2 + 1;
+        auto &src = spcTmp[spcIdx];
+        auto &dst = spcTmp[spcIdx ^ 1];
+        for (int idx = begin; idx < end; ++idx) {
+          if (idx >= spectrumSize) {
+            dst[idx] = src[idx];
+            continue;
+          }
+          int from = idx + spcShift;
+          if (from >= spectrumSize) from -= spectrumSize;
+
+          auto state = src[from] * prm.feedback;
+          const auto maskValue = mask[idx] > prm.maskThreshold ? mask[idx] : float(0);
+          state += spcSrc[idx] / float(prm.frmSize) * maskValue;
+          dst[idx] = state;
+          spcSrc[idx]
+            = state * std::polar(std::abs(maskValue), prm.maskRotation * mask[idx]);
+        }
+      } break;
+      case TransformType::fwht: {
+        auto &src = bufState[stateIdx];
+        auto &dst = bufState[stateIdx ^ 1];
+        for (int idx = begin; idx < end; ++idx) {
+          if (idx >= prm.frmSize) {
+            dst[idx] = src[idx];
+            continue;
+          }
+          int from = idx + spcShift;
+          if (from >= prm.frmSize) from -= prm.frmSize;
+
+          // Using an implementation detail that `prm.frmSize` is always 2^n.
+          const auto permSrc = (idx + rotIdx) & (prm.frmSize - 1);
+          const auto permuted = binaryToGrayCode(bitReversal(permSrc, prm.frameSizeLog2));
+          auto state = src[from] * prm.feedback;
+
+          const auto maskValue = mask[idx] > prm.maskThreshold ? mask[idx] : 0;
+          state += frame[permuted] * maskValue / float(prm.frmSize);
+          dst[idx] = state;
+          frame[permuted] = state * std::abs(maskValue);
+        }
+      } break;
+      case TransformType::haar: {
+        auto &src = bufState[stateIdx];
+        auto &dst = bufState[stateIdx ^ 1];
+        for (int idx = begin; idx < end; ++idx) {
+          if (idx >= prm.frmSize) {
+            dst[idx] = src[idx];
+            continue;
+          }
+          int from = idx + spcShift;
+          if (from >= prm.frmSize) from -= prm.frmSize;
+
+          auto state = src[from] * prm.feedback;
+
+          const auto maskValue = mask[idx] > prm.maskThreshold ? mask[idx] : 0;
+          state *= std::abs(maskValue);
+
+          const auto value = std::lerp(
+            bufTmp[idx], bufTmp[(idx + rotIdx) & (prm.frmSize - 1)], rotation);
+          state += value * maskValue;
+          dst[idx] = state;
+        }
+      } break;
+    }
   }
 };
 
@@ -375,7 +594,8 @@ private:
 
   int prevFrameSizeLog2 = 0;
   int fadeIndex = 0;
-  std::array<float, maxFrameSize> latencyDelay{};
+  int latencyIndex = 0;
+  std::array<float, 2 * maxFrameSize> latencyDelay{};
   std::array<SpectralDelay<maxFrameSizeLog2>, 2> spc;
 
 public:
@@ -383,12 +603,14 @@ public:
   {
     prevFrameSizeLog2 = frameSizeLog2;
     fadeIndex = 0;
+    latencyIndex = 0;
     latencyDelay.fill(0);
 
     const auto length = int(1) << frameSizeLog2;
     for (int i = 0; i < spc.size(); ++i) spc[i].reset((i * length) / spc.size());
   }
 
+  // Latency is 2 frames when `prm.reportLatency` is enabled. See `SpectralDelay`.
   float process(float input, float sideIn, SpectralParameter &prm)
   {
     if (prevFrameSizeLog2 != prm.frameSizeLog2) {
@@ -396,23 +618,13 @@ public:
       spc[0].bufIndex = 0;
       spc[1].bufIndex = prm.frmSize / 2;
       fadeIndex = 0;
+      latencyIndex = 0;
     }
 
-    std::array<float, 2> out{};
-    switch (prm.transform) {
-      default: { // case TransformType::fft
-        out[0] = spc[0].process(input, sideIn, prm);
-        out[1] = spc[1].process(input, sideIn, prm);
-      } break;
-      case TransformType::fwht: {
-        out[0] = spc[0].processFwht(input, sideIn, prm);
-        out[1] = spc[1].processFwht(input, sideIn, prm);
-      } break;
-      case TransformType::haar: {
-        out[0] = spc[0].processHaar(input, sideIn, prm);
-        out[1] = spc[1].processHaar(input, sideIn, prm);
-      } break;
-    }
+    std::array<float, 2> out{
+      spc[0].process(input, sideIn, prm),
+      spc[1].process(input, sideIn, prm),
+    };
 
     constexpr auto twopi = float(2) * std::numbers::pi_v<float>;
 
@@ -420,10 +632,12 @@ public:
     const auto crossFade
       = float(0.5) + float(0.5) * std::cos(twopi * float(fadeIndex) / float(prm.frmSize));
 
-    const auto delayed = latencyDelay[fadeIndex];
-    latencyDelay[fadeIndex] = input;
+    if (latencyIndex >= 2 * prm.frmSize) latencyIndex = 0;
+    const auto delayed = latencyDelay[latencyIndex];
+    latencyDelay[latencyIndex] = input;
 
     ++fadeIndex;
+    ++latencyIndex;
 
     const auto mixed = std::lerp(out[0], out[1], crossFade);
     return prm.reportLatency ? std::lerp(delayed, mixed, prm.dryWetMix)
@@ -30,77 +30,104 @@ struct SpectralParameter {
   float maskRotation = 0;
 };
 
-// Returns a gain for normalization.
-inline void fillMask(int maskSize, float *mask, SpectralParameter &prm)
-{
-  switch (prm.maskWaveform) {
-    default: { // case MaskWaveform::cosine: {
-      constexpr float twopi = float(2) * std::numbers::pi_v<float>;
-      float phase = prm.maskPhase;
-      for (int idx = 0; idx < maskSize; ++idx) {
-        phase -= std::floor(phase);
-        mask[idx] = std::cos(twopi * phase);
-        mask[idx] = std::lerp(float(1), mask[idx], prm.maskMix);
-        phase += prm.maskFreq
-          * std::lerp(float(1), float(idx) / float(maskSize), prm.maskChirp);
-      }
-    } break;
-    case MaskWaveform::square: {
-      float phase = prm.maskPhase;
-      for (int idx = 0; idx < maskSize; ++idx) {
-        phase -= std::floor(phase);
-        mask[idx] = phase < float(0.5) ? float(1) : float(-1);
-        mask[idx] = std::lerp(float(1), mask[idx], prm.maskMix);
-        phase += prm.maskFreq
-          * std::lerp(float(1), float(idx) / float(maskSize), prm.maskChirp);
-      }
-    } break;
-    case MaskWaveform::sawtoothUp: {
-      float phase = prm.maskPhase;
-      for (int idx = 0; idx < maskSize; ++idx) {
-        phase -= std::floor(phase);
-        mask[idx] = float(2) * phase - float(1);
-        mask[idx] = std::lerp(float(1), mask[idx], prm.maskMix);
-        phase += prm.maskFreq
-          * std::lerp(float(1), float(idx) / float(maskSize), prm.maskChirp);
-      }
-    } break;
-    case MaskWaveform::sawtoothDown: {
-      float phase = prm.maskPhase;
-      for (int idx = 0; idx < maskSize; ++idx) {
-        phase -= std::floor(phase);
-        mask[idx] = float(1) - float(2) * phase;
-        mask[idx] = std::lerp(float(1), mask[idx], prm.maskMix);
-        phase += prm.maskFreq
-          * std::lerp(float(1), float(idx) / float(maskSize), prm.maskChirp);
-      }
-    } break;
-    case MaskWaveform::noise: {
-      std::minstd_rand rng{unsigned(2048 * prm.maskFreq)};
-      std::uniform_real_distribution<float> dist{
-        float(1) + float(-2) * prm.maskMix, float(1)};
+/**
+Fills a mask in `nPass()` passes. A pass can be split into ranges of indices, so that a
+mask is filled over several samples. Passes and ranges must be given in order.
+*/
+class MaskFiller {
+private:
+  int maskSize = 0;
+  SpectralParameter prm;
+  float phase = 0;
+  float value = 0;
+  int startIndex = 0;
+  std::minstd_rand rng;
+
+public:
+  void start(int maskSize, const SpectralParameter &prm)
+  {
+    this->maskSize = maskSize;
+    this->prm = prm;
+    phase = prm.maskPhase;
+    value = 0;
+    startIndex = int((prm.maskPhase - std::floor(prm.maskPhase)) * maskSize);
+    rng.seed(unsigned(2048 * prm.maskFreq));
+  }
 
-      int startIndex = int((prm.maskPhase - std::floor(prm.maskPhase)) * maskSize);
-      for (int idx = startIndex; idx < maskSize; ++idx) mask[idx] = dist(rng);
-      for (int idx = 0; idx < startIndex; ++idx) mask[idx] = dist(rng);
+  int nPass() const { return prm.maskWaveform == MaskWaveform::noise ? 3 : 1; }
 
+  void fill(float *mask, int pass, int begin, int end)
+  {
+    switch (prm.maskWaveform) {
+      default: { // case MaskWaveform::cosine: {
+        constexpr float twopi = float(2) * std::numbers::pi_v<float>;
+        for (int idx = begin; idx < end; ++idx) {
+          phase -= std::floor(phase);
+          mask[idx] = std::cos(twopi * phase);
+          advance(mask, idx);
+        }
+      } break;
+      case MaskWaveform::square: {
+        for (int idx = begin; idx < end; ++idx) {
+          phase -= std::floor(phase);
+          mask[idx] = phase < float(0.5) ? float(1) : float(-1);
+          advance(mask, idx);
+        }
+      } break;
+      case MaskWaveform::sawtoothUp: {
+        for (int idx = begin; idx < end; ++idx) {
+          phase -= std::floor(phase);
+          mask[idx] = float(2) * phase - float(1);
+          advance(mask, idx);
+        }
+      } break;
+      case MaskWaveform::sawtoothDown: {
+        for (int idx = begin; idx < end; ++idx) {
+          phase -= std::floor(phase);
+          mask[idx] = float(1) - float(2) * phase;
+          advance(mask, idx);
+        }
+      } break;
+      case MaskWaveform::noise: {
+        fillNoise(mask, pass, begin, end);
+      } break;
+    }
+  }
+
+private:
+  void advance(float *mask, int idx)
+  {
+    mask[idx] = std::lerp(float(1), mask[idx], prm.maskMix);
+    phase += prm.maskFreq
+      * std::lerp(float(1), float(idx) / float(maskSize), prm.maskChirp);
+  }
+
+  // Pass 0 fills white noise from `startIndex`, pass 1 applies backward lowpass, and
+  // pass 2 clamps.
+  void fillNoise(float *mask, int pass, int begin, int end)
+  {
+    if (pass == 0) {
+      std::uniform_real_distribution<float> dist{
+        float(1) + float(-2) * prm.maskMix, float(1)};
+      for (int i = begin; i < end; ++i) {
+        int idx = startIndex + i;
+        if (idx >= maskSize) idx -= maskSize;
+        mask[idx] = dist(rng);
+      }
+    } else if (pass == 1) {
+      if (begin == 0) value = mask[maskSize - 1];
       float kp = float(1) - prm.maskChirp * float(0.999);
-      float value = mask[maskSize - 1];
-      float maxAbs = 0;
-      for (int idx = maskSize - 1; idx >= 0; --idx) {
+      for (int i = begin; i < end; ++i) {
+        const int idx = maskSize - 1 - i;
         value += kp * (mask[idx] - value);
         mask[idx] = value;
-        if (maxAbs < std::abs(value)) maxAbs = value;
       }
-      // if (maxAbs >= std::numeric_limits<float>::epsilon()) {
-      //   for (int idx = 0; idx < maskSize; ++idx) mask[idx] /= maxAbs;
-      // } else {
-      for (int idx = 0; idx < maskSize; ++idx) {
+    } else {
+      for (int idx = begin; idx < end; ++idx) {
         mask[idx] = std::clamp(mask[idx], float(-1), float(1));
       }
-      // }
-    } break;
+    }
   }
-}
+};
 
 } // namespace SomeDSP
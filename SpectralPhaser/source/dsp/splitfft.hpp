@@ -0,0 +1,186 @@
+// Copyright Takamitsu Endo (ryukau@gmail.com).
+// SPDX-License-Identifier: GPL-3.0-only
+
+#pragma once
+
+#include "../../../common/dsp/fft.hpp"
+
+#include <array>
+#include <cmath>
+#include <complex>
+#include <numbers>
+#include <vector>
+
+namespace SomeDSP {
+
+/**
+Real FFT split into stages of small units, so that a large transform can be spread over
+many samples. Results are the same as unscaled `RealForwardFft` and `RealInverseFft` up to
+rounding.
+
+A transform of size `2^sizeLog2` is decimated in time down to `2^nLevel(sizeLog2)` leaves
+of `leafSize`, and leaves are computed by FFTW. Stages of forward transform are:
+
+- Stage 0: FFT of leaves. A unit is a leaf.
+- Stage `i` in `[1, nLevel]`: Combines pairs of spectra into spectra of double length.
+  A unit is a bin of a combined spectrum.
+
+Inverse transform runs the same stages in reverse order. Stage `i` in `[0, nLevel)` splits
+spectra into pairs, where a unit is a pair of bins, and stage `nLevel` is the leaves.
+
+Stages must be run in order, and all units of a stage must be run before the next stage.
+Units of a stage can be given in any number of ranges.
+*/
+template<int maxSizeLog2, int leafSizeLog2> class SplitRealFft {
+  static_assert(leafSizeLog2 >= 4 && leafSizeLog2 < maxSizeLog2);
+
+public:
+  static constexpr int leafSize = int(1) << leafSizeLog2;
+
+  // Cost of a leaf relative to a bin. It's roughly the number of butterflies.
+  static constexpr int leafCost = leafSize * leafSizeLog2 / 2 + leafSize;
+
+private:
+  static constexpr int maxSize = int(1) << maxSizeLog2;
+  static constexpr int maxLevel = maxSizeLog2 - leafSizeLog2;
+  static constexpr int padding = 8; // Keeps alignment of slots for FFTW plans.
+
+  FftwBuffer<float> leaf{leafSize};
+  std::array<FftwBuffer<std::complex<float>>, 2> spectra; // [depth % 2][slot][stride].
+  RealForwardFft forwardFft;
+  RealInverseFft inverseFft;
+
+  // `exp(-2 pi i k / maxSize)` for k in `[0, maxSize / 2]`. Shared by all instances.
+  static const std::vector<std::complex<float>> &twiddle()
+  {
+    static const std::vector<std::complex<float>> table = [] {
+      std::vector<std::complex<float>> tw(maxSize / 2 + 1);
+      for (size_t k = 0; k < tw.size(); ++k) {
+        tw[k] = std::complex<float>(
+          std::polar(double(1), -double(2) * std::numbers::pi * k / double(maxSize)));
+      }
+      return tw;
+    }();
+    return table;
+  }
+
+  // Spectrum of `2^(sizeLog2 - depth)` samples. Slot `s` holds the subsequence which
+  // starts at sample `s` with the step of `2^depth`.
+  std::complex<float> *slot(int sizeLog2, int depth, int index)
+  {
+    const int stride = (int(1) << (sizeLog2 - depth - 1)) + padding;
+    return spectra[depth & 1].data() + index * stride;
+  }
+
+public:
+  SplitRealFft()
+  {
+    twiddle();
+    for (auto &sp : spectra) sp.resize(maxSize / 2 + padding * (int(1) << maxLevel));
+    forwardFft.init(leafSize, leaf.data(), spectra[0].data());
+    inverseFft.init(leafSize, spectra[0].data(), leaf.data());
+  }
+
+  static bool isSplit(int sizeLog2) { return sizeLog2 > leafSizeLog2; }
+  static int nLevel(int sizeLog2) { return sizeLog2 - leafSizeLog2; }
+
+  static int forwardUnits(int sizeLog2, int stage)
+  {
+    if (stage == 0) return int(1) << nLevel(sizeLog2);
+    const int depth = nLevel(sizeLog2) - stage;
+    return (int(1) << depth) * ((int(1) << (sizeLog2 - depth - 1)) + 1);
+  }
+
+  static int inverseUnits(int sizeLog2, int stage)
+  {
+    if (stage == nLevel(sizeLog2)) return int(1) << stage;
+    return (int(1) << stage) * ((int(1) << (sizeLog2 - stage - 2)) + 1);
+  }
+
+  // `in` has `2^sizeLog2` samples, and `out` has `2^(sizeLog2 - 1) + 1` bins.
+  void forward(
+    int sizeLog2,
+    int stage,
+    int begin,
+    int end,
+    const float *in,
+    std::complex<float> *out)
+  {
+    const int level = nLevel(sizeLog2);
+    if (stage == 0) {
+      for (int s = begin; s < end; ++s) {
+        for (int i = 0; i < leafSize; ++i) leaf[i] = in[s + (i << level)];
+        forwardFft.execute(leaf.data(), slot(sizeLog2, level, s));
+      }
+      return;
+    }
+
+    // X[k] = E[k] + W^k O[k]. Upper half of E and O is the conjugate of lower half.
+    const auto &tw = twiddle();
+    const int depth = level - stage;
+    const int nParent = int(1) << depth;
+    const int half = int(1) << (sizeLog2 - depth - 1);
+    const int twStep = int(1) << (maxSizeLog2 - sizeLog2 + depth);
+    int parent = begin / (half + 1);
+    int k = begin % (half + 1);
+    for (int u = begin; u < end; ++u) {
+      auto even = slot(sizeLog2, depth + 1, parent);
+      auto odd = slot(sizeLog2, depth + 1, parent + nParent);
+      auto dest = depth == 0 ? out : slot(sizeLog2, depth, parent);
+      const bool isLower = 2 * k <= half;
+      const auto e = isLower ? even[k] : std::conj(even[half - k]);
+      const auto o = isLower ? odd[k] : std::conj(odd[half - k]);
+      dest[k] = e + tw[k * twStep] * o;
+
+      if (++k > half) {
+        k = 0;
+        ++parent;
+      }
+    }
+  }
+
+  // `in` has `2^(sizeLog2 - 1) + 1` bins. Imaginary parts of DC and Nyquist are ignored
+  // as FFTW does. `out` has `2^sizeLog2` samples.
+  void inverse(
+    int sizeLog2, int stage, int begin, int end, std::complex<float> *in, float *out)
+  {
+    const int level = nLevel(sizeLog2);
+    if (stage == level) {
+      for (int s = begin; s < end; ++s) {
+        inverseFft.execute(slot(sizeLog2, level, s), leaf.data());
+        for (int i = 0; i < leafSize; ++i) out[s + (i << level)] = leaf[i];
+      }
+      return;
+    }
+
+    // E[k] = X[k] + X[k + n/2], and O[k] = (X[k] - X[k + n/2]) W^-k.
+    const auto &tw = twiddle();
+    const int depth = stage;
+    const int nParent = int(1) << depth;
+    const int half = int(1) << (sizeLog2 - depth - 1);
+    const int quarter = half / 2;
+    const int twStep = int(1) << (maxSizeLog2 - sizeLog2 + depth);
+    int parent = begin / (quarter + 1);
+    int k = begin % (quarter + 1);
+    for (int u = begin; u < end; ++u) {
+      auto src = depth == 0 ? in : slot(sizeLog2, depth, parent);
+      auto even = slot(sizeLog2, depth + 1, parent);
+      auto odd = slot(sizeLog2, depth + 1, parent + nParent);
+      auto a = src[k];
+      auto b = std::conj(src[half - k]);
+      if (depth == 0 && k == 0) {
+        a.imag(0);
+        b.imag(0);
+      }
+      even[k] = a + b;
+      odd[k] = (a - b) * std::conj(tw[k * twStep]);
+
+      if (++k > quarter) {
+        k = 0;
+        ++parent;
+      }
+    }
+  }
+};
+
+} // namespace SomeDSP
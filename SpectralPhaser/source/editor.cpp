@@ -56,7 +56,7 @@ void Editor::valueChanged(CControl *pControl)
   }
 
   if (id == ID::frameSize) {
-    if (int(getPlainValue(ID::reportLatency)) == 1) return;
+    if (int(getPlainValue(ID::reportLatency)) == 0) return;
     controller->getComponentHandler()->restartComponent(kLatencyChanged);
     return;
   }
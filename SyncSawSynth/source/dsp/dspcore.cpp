@@ -260,9 +260,11 @@ DSPCore::DSPCore() { midiNotes.reserve(128); }
 
 void DSPCore::setup(double sampleRate)
 {
+  SmootherCommon<float>::Scope smootherScope(smootherState);
+
   this->sampleRate = float(sampleRate);
 
-  midiNotes.resize(0);
+  midiNotes.clear();
 
   SmootherCommon<float>::setSampleRate(this->sampleRate);
   SmootherCommon<float>::setTime(0.2f);
@@ -335,6 +337,8 @@ void DSPCore::free() {}
 
 void DSPCore::reset()
 {
+  SmootherCommon<float>::Scope smootherScope(smootherState);
+
   noise.reset(0);
 
   ASSIGN_PARAMETER(reset);
@@ -353,12 +357,16 @@ void DSPCore::reset()
 
 void DSPCore::startup()
 {
+  SmootherCommon<float>::Scope smootherScope(smootherState);
+
   lfoPhase = 0.0f;
   lfoValue = 0.0f;
 }
 
 void DSPCore::setParameters()
 {
+  SmootherCommon<float>::Scope smootherScope(smootherState);
+
   ASSIGN_PARAMETER(push);
 
   switch (param.value[ParameterID::nVoice]->getInt()) {
@@ -391,6 +399,7 @@ void DSPCore::setParameters()
 
 void DSPCore::process(const size_t length, float *out0, float *out1)
 {
+  SmootherCommon<float>::Scope smootherScope(smootherState);
   ScopedNoDenormals scopedDenormals;
 
   SmootherCommon<float>::setBufferSize(float(length));
@@ -417,70 +426,107 @@ void DSPCore::process(const size_t length, float *out0, float *out1)
   noteInfo.osc1PTROrder = param.value[ParameterID::osc1PTROrder]->getInt();
   noteInfo.osc2SyncType = param.value[ParameterID::osc2SyncType]->getInt();
   noteInfo.osc2PTROrder = param.value[ParameterID::osc2PTROrder]->getInt();
-  for (size_t i = 0; i < length; ++i) {
-    processMidiNote(i);
-
-    noteInfo.osc1Gain = interpOsc1Gain.process();
-    noteInfo.osc1Pitch = interpOsc1Pitch.process();
-    noteInfo.osc1Sync = interpOsc1Sync.process();
-    noteInfo.osc2Gain = interpOsc2Gain.process();
-    noteInfo.osc2Pitch = interpOsc2Pitch.process();
-    noteInfo.osc2Sync = interpOsc2Sync.process();
-    noteInfo.fmOsc1ToSync1 = interpFMOsc1ToSync1.process();
-    noteInfo.fmOsc1ToFreq2 = interpFMOsc1ToFreq2.process();
-    noteInfo.fmOsc2ToSync1 = interpFMOsc2ToSync1.process();
-    noteInfo.modEnvelopeToFreq1 = interpModEnvelopeToFreq1.process();
-    noteInfo.modEnvelopeToSync1 = interpModEnvelopeToSync1.process();
-    noteInfo.modEnvelopeToFreq2 = interpModEnvelopeToFreq2.process();
-    noteInfo.modEnvelopeToSync2 = interpModEnvelopeToSync2.process();
-
-    lfoPhase += 2.0f * float(pi) * interpModLFOFrequency.process() / sampleRate;
-    if (lfoPhase >= float(pi)) lfoPhase -= float(pi);
-    lfoValue = sinf(lfoPhase);
-    // lfoValue = (lfoValue + 1.0f) * 0.5f;
-    const float noiseSig = clamp(noise.process(), -1.0f, 1.0f) / 16.0f;
-    noteInfo.modLFO = clamp(
-      lfoValue + interpModLFONoiseMix.process() * (noiseSig - lfoValue), -1.0f, 1.0f);
-
-    noteInfo.modLFOToFreq1 = interpModLFOToFreq1.process();
-    noteInfo.modLFOToSync1 = interpModLFOToSync1.process();
-    noteInfo.modLFOToFreq2 = interpModLFOToFreq2.process();
-    noteInfo.modLFOToSync2 = interpModLFOToSync2.process();
-    noteInfo.gainEnvelopeCurve = interpGainEnvelopeCurve.process();
-    noteInfo.filterCutoff = interpFilterCutoff.process();
-    noteInfo.filterResonance = interpFilterResonance.process();
-    noteInfo.filterFeedback = interpFilterFeedback.process();
-    noteInfo.filterSaturation = interpFilterSaturation.process();
-    noteInfo.filterCutoffAmount = interpFilterCutoffAmount.process();
-    noteInfo.filterResonanceAmount = interpFilterResonanceAmount.process();
-    noteInfo.filterKeyToCutoff = interpFilterKeyToCutoff.process();
-    noteInfo.filterKeyToFeedback = interpFilterKeyToFeedback.process();
-
-    float sample = 0.0f;
-    for (auto &note : notes) {
-      if (note[0]->state == NoteState::rest) continue;
-      sample += note[0]->process(noteInfo);
-      if (unison) {
-        if (note[1]->state == NoteState::rest) continue;
-        sample += note[1]->process(noteInfo);
+  for (size_t blockStart = 0; blockStart < length; blockStart += smootherBlockSize) {
+    const size_t blockLength = std::min(smootherBlockSize, length - blockStart);
+    interpOsc1Gain.processBlock(lane.osc1Gain.data(), blockLength);
+    interpOsc1Pitch.processBlock(lane.osc1Pitch.data(), blockLength);
+    interpOsc1Sync.processBlock(lane.osc1Sync.data(), blockLength);
+    interpOsc2Gain.processBlock(lane.osc2Gain.data(), blockLength);
+    interpOsc2Pitch.processBlock(lane.osc2Pitch.data(), blockLength);
+    interpOsc2Sync.processBlock(lane.osc2Sync.data(), blockLength);
+    interpFMOsc1ToSync1.processBlock(lane.fmOsc1ToSync1.data(), blockLength);
+    interpFMOsc1ToFreq2.processBlock(lane.fmOsc1ToFreq2.data(), blockLength);
+    interpFMOsc2ToSync1.processBlock(lane.fmOsc2ToSync1.data(), blockLength);
+    interpModEnvelopeToFreq1.processBlock(lane.modEnvelopeToFreq1.data(), blockLength);
+    interpModEnvelopeToSync1.processBlock(lane.modEnvelopeToSync1.data(), blockLength);
+    interpModEnvelopeToFreq2.processBlock(lane.modEnvelopeToFreq2.data(), blockLength);
+    interpModEnvelopeToSync2.processBlock(lane.modEnvelopeToSync2.data(), blockLength);
+    interpModLFOFrequency.processBlock(lane.modLFOFrequency.data(), blockLength);
+    interpModLFONoiseMix.processBlock(lane.modLFONoiseMix.data(), blockLength);
+    interpModLFOToFreq1.processBlock(lane.modLFOToFreq1.data(), blockLength);
+    interpModLFOToSync1.processBlock(lane.modLFOToSync1.data(), blockLength);
+    interpModLFOToFreq2.processBlock(lane.modLFOToFreq2.data(), blockLength);
+    interpModLFOToSync2.processBlock(lane.modLFOToSync2.data(), blockLength);
+    interpGainEnvelopeCurve.processBlock(lane.gainEnvelopeCurve.data(), blockLength);
+    interpFilterCutoff.processBlock(lane.filterCutoff.data(), blockLength);
+    interpFilterResonance.processBlock(lane.filterResonance.data(), blockLength);
+    interpFilterFeedback.processBlock(lane.filterFeedback.data(), blockLength);
+    interpFilterSaturation.processBlock(lane.filterSaturation.data(), blockLength);
+    interpFilterCutoffAmount.processBlock(lane.filterCutoffAmount.data(), blockLength);
+    interpFilterResonanceAmount.processBlock(
+      lane.filterResonanceAmount.data(), blockLength);
+    interpFilterKeyToCutoff.processBlock(lane.filterKeyToCutoff.data(), blockLength);
+    interpFilterKeyToFeedback.processBlock(lane.filterKeyToFeedback.data(), blockLength);
+    interpMasterGain.processBlock(lane.masterGain.data(), blockLength);
+
+    for (size_t j = 0; j < blockLength; ++j) {
+      const size_t i = blockStart + j;
+      processMidiNote(i);
+
+      noteInfo.osc1Gain = lane.osc1Gain[j];
+      noteInfo.osc1Pitch = lane.osc1Pitch[j];
+      noteInfo.osc1Sync = lane.osc1Sync[j];
+      noteInfo.osc2Gain = lane.osc2Gain[j];
+      noteInfo.osc2Pitch = lane.osc2Pitch[j];
+      noteInfo.osc2Sync = lane.osc2Sync[j];
+      noteInfo.fmOsc1ToSync1 = lane.fmOsc1ToSync1[j];
+      noteInfo.fmOsc1ToFreq2 = lane.fmOsc1ToFreq2[j];
+      noteInfo.fmOsc2ToSync1 = lane.fmOsc2ToSync1[j];
+      noteInfo.modEnvelopeToFreq1 = lane.modEnvelopeToFreq1[j];
+      noteInfo.modEnvelopeToSync1 = lane.modEnvelopeToSync1[j];
+      noteInfo.modEnvelopeToFreq2 = lane.modEnvelopeToFreq2[j];
+      noteInfo.modEnvelopeToSync2 = lane.modEnvelopeToSync2[j];
+
+      lfoPhase += 2.0f * float(pi) * lane.modLFOFrequency[j] / sampleRate;
+      if (lfoPhase >= float(pi)) lfoPhase -= float(pi);
+      lfoValue = sinf(lfoPhase);
+      // lfoValue = (lfoValue + 1.0f) * 0.5f;
+      const float noiseSig = clamp(noise.process(), -1.0f, 1.0f) / 16.0f;
+      noteInfo.modLFO = clamp(
+        lfoValue + lane.modLFONoiseMix[j] * (noiseSig - lfoValue), -1.0f, 1.0f);
+
+      noteInfo.modLFOToFreq1 = lane.modLFOToFreq1[j];
+      noteInfo.modLFOToSync1 = lane.modLFOToSync1[j];
+      noteInfo.modLFOToFreq2 = lane.modLFOToFreq2[j];
+      noteInfo.modLFOToSync2 = lane.modLFOToSync2[j];
+      noteInfo.gainEnvelopeCurve = lane.gainEnvelopeCurve[j];
+      noteInfo.filterCutoff = lane.filterCutoff[j];
+      noteInfo.filterResonance = lane.filterResonance[j];
+      noteInfo.filterFeedback = lane.filterFeedback[j];
+      noteInfo.filterSaturation = lane.filterSaturation[j];
+      noteInfo.filterCutoffAmount = lane.filterCutoffAmount[j];
+      noteInfo.filterResonanceAmount = lane.filterResonanceAmount[j];
+      noteInfo.filterKeyToCutoff = lane.filterKeyToCutoff[j];
+      noteInfo.filterKeyToFeedback = lane.filterKeyToFeedback[j];
+
+      float sample = 0.0f;
+      for (auto &note : notes) {
+        if (note[0]->state == NoteState::rest) continue;
+        sample += note[0]->process(noteInfo);
+        if (unison) {
+          if (note[1]->state == NoteState::rest) continue;
+          sample += note[1]->process(noteInfo);
+        }
       }
-    }
 
-    if (isTransitioning) {
-      sample += transitionBuffer[trIndex];
-      transitionBuffer[trIndex] = 0.0f;
-      trIndex = (trIndex + 1) % transitionBuffer.size();
-      if (trIndex == trStop) isTransitioning = false;
-    }
+      if (isTransitioning) {
+        sample += transitionBuffer[trIndex];
+        transitionBuffer[trIndex] = 0.0f;
+        trIndex = (trIndex + 1) % transitionBuffer.size();
+        if (trIndex == trStop) isTransitioning = false;
+      }
 
-    const float masterGain = interpMasterGain.process();
-    out0[i] = masterGain * sample;
-    out1[i] = masterGain * sample;
+      const float masterGain = lane.masterGain[j];
+      out0[i] = masterGain * sample;
+      out1[i] = masterGain * sample;
+    }
   }
 }
 
 void DSPCore::noteOn(int32_t noteId, int16_t pitch, float tuning, float velocity)
 {
+  SmootherCommon<float>::Scope smootherScope(smootherState);
+
   size_t i = 0;
   size_t mostSilent = 0;
   float gain = 1.0f;
@@ -565,6 +611,8 @@ void DSPCore::noteOn(int32_t noteId, int16_t pitch, float tuning, float velocity
 
 void DSPCore::noteOff(int32_t noteId)
 {
+  SmootherCommon<float>::Scope smootherScope(smootherState);
+
   // size_t i = 0;
   // for (; i < notes.size(); ++i) {
   //   if (notes[i][0]->id == noteId) break;
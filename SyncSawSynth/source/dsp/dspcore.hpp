@@ -4,6 +4,7 @@
 #pragma once
 
 #include "../../../common/dsp/constants.hpp"
+#include "../../../common/dsp/notequeue.hpp"
 #include "../../../common/dsp/smoother.hpp"
 #include "../parameter.hpp"
 #include "envelope.hpp"
@@ -109,6 +110,7 @@ public:
 
   static const size_t maxVoice = 32;
   GlobalParameter param;
+  SmootherState<float> smootherState;
 
   void setup(double sampleRate);
   void free();    // Release memory.
@@ -128,7 +130,7 @@ public:
     float velocity;
   };
 
-  std::vector<MidiNote> midiNotes;
+  NoteQueue<MidiNote> midiNotes;
 
   void pushMidiNote(
     bool isNoteOn,
@@ -145,22 +147,17 @@ public:
     note.pitch = pitch;
     note.tuning = tuning;
     note.velocity = velocity;
-    midiNotes.push_back(note);
+    if (!midiNotes.push(note) && !note.isNoteOn) noteOff(note.id);
   }
 
   void processMidiNote(size_t frame)
   {
-    while (true) {
-      auto it = std::find_if(midiNotes.begin(), midiNotes.end(), [&](const MidiNote &nt) {
-        return nt.frame == frame;
-      });
-      if (it == std::end(midiNotes)) return;
-      if (it->isNoteOn)
-        noteOn(it->id, it->pitch, it->tuning, it->velocity);
+    midiNotes.pop(frame, [&](MidiNote &nt) {
+      if (nt.isNoteOn)
+        noteOn(nt.id, nt.pitch, nt.tuning, nt.velocity);
       else
-        noteOff(it->id);
-      midiNotes.erase(it);
-    }
+        noteOff(nt.id);
+    });
   }
 
 private:
@@ -202,6 +199,41 @@ private:
   ExpSmoother<float> interpFilterKeyToCutoff;
   ExpSmoother<float> interpFilterKeyToFeedback;
 
+  // Outputs of `ExpSmoother::processBlock`. `process` advances smoothers
+  // `smootherBlockSize` samples at once, and reads the values from here.
+  static constexpr size_t smootherBlockSize = 64;
+  struct SmoothedLanes {
+    std::array<float, smootherBlockSize> osc1Gain;
+    std::array<float, smootherBlockSize> osc1Pitch;
+    std::array<float, smootherBlockSize> osc1Sync;
+    std::array<float, smootherBlockSize> osc2Gain;
+    std::array<float, smootherBlockSize> osc2Pitch;
+    std::array<float, smootherBlockSize> osc2Sync;
+    std::array<float, smootherBlockSize> fmOsc1ToSync1;
+    std::array<float, smootherBlockSize> fmOsc1ToFreq2;
+    std::array<float, smootherBlockSize> fmOsc2ToSync1;
+    std::array<float, smootherBlockSize> modEnvelopeToFreq1;
+    std::array<float, smootherBlockSize> modEnvelopeToSync1;
+    std::array<float, smootherBlockSize> modEnvelopeToFreq2;
+    std::array<float, smootherBlockSize> modEnvelopeToSync2;
+    std::array<float, smootherBlockSize> modLFOFrequency;
+    std::array<float, smootherBlockSize> modLFONoiseMix;
+    std::array<float, smootherBlockSize> modLFOToFreq1;
+    std::array<float, smootherBlockSize> modLFOToSync1;
+    std::array<float, smootherBlockSize> modLFOToFreq2;
+    std::array<float, smootherBlockSize> modLFOToSync2;
+    std::array<float, smootherBlockSize> gainEnvelopeCurve;
+    std::array<float, smootherBlockSize> filterCutoff;
+    std::array<float, smootherBlockSize> filterResonance;
+    std::array<float, smootherBlockSize> filterFeedback;
+    std::array<float, smootherBlockSize> filterSaturation;
+    std::array<float, smootherBlockSize> filterCutoffAmount;
+    std::array<float, smootherBlockSize> filterResonanceAmount;
+    std::array<float, smootherBlockSize> filterKeyToCutoff;
+    std::array<float, smootherBlockSize> filterKeyToFeedback;
+    std::array<float, smootherBlockSize> masterGain;
+  } lane;
+
   size_t nVoice = 32;
   std::array<std::array<std::unique_ptr<Note<float>>, 2>, maxVoice> notes;
 
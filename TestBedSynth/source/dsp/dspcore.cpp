@@ -172,6 +172,8 @@ std::array<float, 2> Note::process(float sampleRate, NoteProcessInfo &info)
 
 void DSPCore::setup(double sampleRate)
 {
+  SmootherCommon<float>::Scope smootherScope(smootherState);
+
   this->sampleRate = float(sampleRate);
 
   transitionBuffer.resize(1 + size_t(this->sampleRate * 0.002), {0.0f, 0.0f});
@@ -201,6 +203,8 @@ DSPCore::DSPCore()
 
 void DSPCore::reset()
 {
+  SmootherCommon<float>::Scope smootherScope(smootherState);
+
   using ID = ParameterID::ID;
   auto &pv = param.value;
 
@@ -225,6 +229,8 @@ void DSPCore::startup() {}
 
 void DSPCore::setParameters()
 {
+  SmootherCommon<float>::Scope smootherScope(smootherState);
+
   using ID = ParameterID::ID;
   auto &pv = param.value;
 
@@ -269,6 +275,8 @@ void DSPCore::processSample(std::array<float, 2> &frame)
 
 void DSPCore::process(const size_t length, float *out0, float *out1)
 {
+  SmootherCommon<float>::Scope smootherScope(smootherState);
+
   using ID = ParameterID::ID;
   auto &pv = param.value;
 
@@ -309,6 +317,8 @@ void DSPCore::process(const size_t length, float *out0, float *out1)
 void DSPCore::noteOn(
   int_fast32_t noteId, int_fast16_t pitch, float tuning, float velocity)
 {
+  SmootherCommon<float>::Scope smootherScope(smootherState);
+
   using ID = ParameterID::ID;
   auto &pv = param.value;
 
@@ -349,6 +359,8 @@ void DSPCore::noteOn(
 
 void DSPCore::noteOff(int_fast32_t noteId)
 {
+  SmootherCommon<float>::Scope smootherScope(smootherState);
+
   for (size_t i = 0; i < notes.size(); ++i)
     if (notes[i].id == noteId) notes[i].noteOff(upRate);
 }
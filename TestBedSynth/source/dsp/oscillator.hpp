@@ -4,22 +4,17 @@
 #pragma once
 
 #include "../../../common/dsp/constants.hpp"
+#include "../../../common/dsp/fft.hpp"
 #include "../../../common/dsp/smoother.hpp"
-#include "../../../lib/fftw3/fftw3.h"
 #include "modulationenum.hpp"
 
 #include <algorithm>
 #include <array>
 #include <complex>
-#include <mutex>
 #include <numeric>
 
 namespace SomeDSP {
 
-// `fftwMutex` is used to lock FFTW3 calls except `fftw*_execute`. In other words, FFTW3
-// isn't thread safe except `fftw*_execute` call.
-extern std::mutex fftwMutex;
-
 // Range of t is in [0, 1]. Interpoltes between y1 and y2.
 // y0 is current, y3 is earlier sample.
 template<typename T> inline T lagrange3Interp(T y0, T y1, T y2, T y3, T t)
@@ -75,22 +70,7 @@ inline float mixModulation(
 }
 
 template<size_t tableSize> struct WaveForm {
-  float *table = nullptr;
-
-  WaveForm()
-  {
-    const std::lock_guard<std::mutex> fftwLock(fftwMutex);
-
-    table = (float *)fftwf_malloc(sizeof(float) * tableSize);
-    std::fill(table, table + tableSize, 0.0f);
-  }
-
-  ~WaveForm()
-  {
-    const std::lock_guard<std::mutex> fftwLock(fftwMutex);
-
-    if (table) fftwf_free(table);
-  }
+  FftwBuffer<float> table{tableSize};
 
   inline float phaseSkewFunc(float x) { return x * x * x * x * x * x * x * x; }
 
@@ -153,31 +133,15 @@ template<size_t tableSize> struct Spectrum {
   static constexpr size_t spectrumSize = tableSize / 2 + 1;
   static constexpr float bendRange = 1.7320508075688772f; // sqrt(3).
 
-  std::complex<float> *src = nullptr; // source.
-  std::complex<float> *dst = nullptr; // destination.
-
-  Spectrum()
-  {
-    const std::lock_guard<std::mutex> fftwLock(fftwMutex);
-
-    src = (std::complex<float> *)fftwf_malloc(sizeof(std::complex<float>) * spectrumSize);
-    dst = (std::complex<float> *)fftwf_malloc(sizeof(std::complex<float>) * spectrumSize);
-  }
-
-  ~Spectrum()
-  {
-    const std::lock_guard<std::mutex> fftwLock(fftwMutex);
-
-    if (src) fftwf_free(src);
-    if (dst) fftwf_free(dst);
-  }
+  FftwBuffer<std::complex<float>> src{spectrumSize}; // source.
+  FftwBuffer<std::complex<float>> dst{spectrumSize}; // destination.
 
   void prepare(
     float noteHz,
     const std::array<float, ModID::MODID_ENUM_LENGTH> &mod,
     WavetableParameter &param)
   {
-    std::fill(dst, dst + spectrumSize, std::complex<float>{0, 0});
+    std::fill(dst.begin(), dst.end(), std::complex<float>{0, 0});
 
     // Spectral modulation.
     auto modSpectralSpread = mixModulation(mod, param.modSpectralSpread);
@@ -223,10 +187,10 @@ struct VariableWaveTableOscillator {
   WaveForm<tableSize> waveform;
   Spectrum<tableSize> spectrum;
 
-  fftwf_plan forwardPlan;
-  std::array<fftwf_plan, 2> inversePlan;
+  RealForwardFft forwardFft;
+  RealInverseFft inverseFft;
 
-  std::array<float *, 2> table;
+  std::array<FftwBuffer<float>, 2> table;
   size_t backIndex = 1;
 
   float phase = 0.0f;
@@ -237,29 +201,11 @@ struct VariableWaveTableOscillator {
 
   VariableWaveTableOscillator()
   {
-    const std::lock_guard<std::mutex> fftwLock(fftwMutex);
-
-    forwardPlan = fftwf_plan_dft_r2c_1d(
-      tableSize, waveform.table, reinterpret_cast<fftwf_complex *>(spectrum.src),
-      FFTW_ESTIMATE);
-
-    for (size_t idx = 0; idx < table.size(); ++idx) {
-      table[idx] = (float *)fftwf_malloc(sizeof(float) * paddedSize);
-      std::fill(table[idx], table[idx] + paddedSize, 0.0f);
-
-      inversePlan[idx] = fftwf_plan_dft_c2r_1d(
-        tableSize, reinterpret_cast<fftwf_complex *>(spectrum.dst), table[idx] + 1,
-        FFTW_ESTIMATE);
-    }
-  }
-
-  ~VariableWaveTableOscillator()
-  {
-    const std::lock_guard<std::mutex> fftwLock(fftwMutex);
+    for (auto &tbl : table) tbl.resize(paddedSize);
 
-    for (auto &pln : inversePlan) fftwf_destroy_plan(pln);
-    for (auto &tbl : table) fftwf_free(tbl);
-    fftwf_destroy_plan(forwardPlan);
+    // Output of inverse FFT is offset by 1 for padding. Both tables share the same plan.
+    forwardFft.init(tableSize, waveform.table.data(), spectrum.src.data());
+    inverseFft.init(tableSize, spectrum.dst.data(), table[0].data() + 1);
   }
 
   void reset()
@@ -295,9 +241,9 @@ struct VariableWaveTableOscillator {
     WavetableParameter &param)
   {
     waveform.draw(mod, wavetable, param);
-    fftwf_execute(forwardPlan);
+    forwardFft.execute(waveform.table.data(), spectrum.src.data());
     spectrum.prepare(noteHz, mod, param);
-    fftwf_execute(inversePlan[tableIndex]);
+    inverseFft.execute(spectrum.dst.data(), table[tableIndex].data() + 1);
 
     table[tableIndex][0] = table[tableIndex][tableSize];
     table[tableIndex][paddedSize - 2] = table[tableIndex][1];
@@ -338,9 +338,11 @@ DSPCore::DSPCore() { midiNotes.reserve(128); }
 
 void DSPCore::setup(double sampleRate)
 {
+  SmootherCommon<float>::Scope smootherScope(smootherState);
+
   this->sampleRate = float(sampleRate);
 
-  midiNotes.resize(0);
+  midiNotes.clear();
 
   SmootherCommon<float>::setSampleRate(this->sampleRate);
   SmootherCommon<float>::setTime(0.01f);
@@ -358,6 +360,8 @@ void DSPCore::free() {}
 
 void DSPCore::reset()
 {
+  SmootherCommon<float>::Scope smootherScope(smootherState);
+
   tpz1.reset(param);
   interpMasterGain.reset(param.value[ParameterID::gain]->getFloat());
   startup();
@@ -367,6 +371,8 @@ void DSPCore::startup() { tpz1.startup(); }
 
 void DSPCore::setParameters(double tempo)
 {
+  SmootherCommon<float>::Scope smootherScope(smootherState);
+
   SmootherCommon<float>::setTime(param.value[ParameterID::smoothness]->getFloat());
 
   interpMasterGain.push(velocity * param.value[ParameterID::gain]->getFloat());
@@ -376,6 +382,7 @@ void DSPCore::setParameters(double tempo)
 
 void DSPCore::process(const size_t length, float *out0, float *out1)
 {
+  SmootherCommon<float>::Scope smootherScope(smootherState);
   ScopedNoDenormals scopedDenormals;
 
   SmootherCommon<float>::setBufferSize(float(length));
@@ -393,6 +400,8 @@ void DSPCore::process(const size_t length, float *out0, float *out1)
 
 void DSPCore::noteOn(int32_t noteId, int16_t pitch, float tuning, float velocity)
 {
+  SmootherCommon<float>::Scope smootherScope(smootherState);
+
   NoteInfo info;
   info.id = noteId;
   info.frequency = midiNoteToFrequency(pitch, tuning);
@@ -406,6 +415,8 @@ void DSPCore::noteOn(int32_t noteId, int16_t pitch, float tuning, float velocity
 
 void DSPCore::noteOff(int32_t noteId)
 {
+  SmootherCommon<float>::Scope smootherScope(smootherState);
+
   auto it = std::find_if(noteStack.begin(), noteStack.end(), [&](const NoteInfo &info) {
     return info.id == noteId;
   });
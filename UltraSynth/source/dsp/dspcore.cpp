@@ -25,6 +25,8 @@ inline double calcPitch(double semitone, double equalTemperament = 12.0)
 
 void DSPCore::setup(double sampleRate)
 {
+  SmootherCommon<double>::Scope smootherScope(smootherState);
+
   noteStack.reserve(1024);
   noteStack.resize(0);
 
@@ -102,6 +104,8 @@ void DSPCore::setup(double sampleRate)
 
 void DSPCore::reset()
 {
+  SmootherCommon<double>::Scope smootherScope(smootherState);
+
   noteNumber = 69.0;
   velocity = 0;
 
@@ -125,13 +129,20 @@ void DSPCore::reset()
 
 void DSPCore::startup()
 {
+  SmootherCommon<double>::Scope smootherScope(smootherState);
+
   lfoPhase.offset = 0;
   synchronizer.reset(sampleRate, tempo, getTempoSyncInterval());
 
   resetBuffer();
 }
 
-void DSPCore::setParameters() { ASSIGN_PARAMETER(push); }
+void DSPCore::setParameters()
+{
+  SmootherCommon<double>::Scope smootherScope(smootherState);
+
+  ASSIGN_PARAMETER(push);
+}
 
 template<typename Sample> inline Sample processOsc(Sample phase, Sample shape, Sample mix)
 {
@@ -142,6 +153,7 @@ template<typename Sample> inline Sample processOsc(Sample phase, Sample shape, S
 
 void DSPCore::process(const size_t length, float *out0, float *out1)
 {
+  SmootherCommon<double>::Scope smootherScope(smootherState);
   ScopedNoDenormals scopedDenormals;
 
   using ID = ParameterID::ID;
@@ -258,6 +270,8 @@ void DSPCore::process(const size_t length, float *out0, float *out1)
 
 void DSPCore::noteOn(NoteInfo &info)
 {
+  SmootherCommon<double>::Scope smootherScope(smootherState);
+
   using ID = ParameterID::ID;
   auto &pv = param.value;
 
@@ -288,6 +302,8 @@ void DSPCore::noteOn(NoteInfo &info)
 
 void DSPCore::noteOff(int_fast32_t noteId)
 {
+  SmootherCommon<double>::Scope smootherScope(smootherState);
+
   auto it = std::find_if(noteStack.begin(), noteStack.end(), [&](const NoteInfo &info) {
     return info.id == noteId;
   });
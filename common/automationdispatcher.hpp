@@ -0,0 +1,215 @@
+// SPDX-License-Identifier: GPL-3.0-only
+// Copyright Takamitsu Endo (ryukau@gmail.com)
+
+#pragma once
+
+#include "pluginterfaces/vst/ivstaudioprocessor.h"
+#include "pluginterfaces/vst/ivstevents.h"
+#include "pluginterfaces/vst/ivstparameterchanges.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace Steinberg::Synth {
+
+/**
+Sample accurate automation by splitting a host block into sub-blocks.
+
+All points of `IParamValueQueue` and all events in `IEventList` are merged into a stream
+sorted by sample offset. `dispatch` then applies the points and calls `process` for each
+range between two change points. Events are passed to `handleEvent` in the sub-block that
+contains them, and their `sampleOffset` is rewritten to be relative to the sub-block.
+
+`minSubBlockLength` caps the number of sub-blocks for dense automation. A change point
+closer than `minSubBlockLength` to the start of current sub-block is delayed to the end of
+the sub-block. 1 is fully sample accurate.
+
+Storage is allocated in `setup`, and `receive` never allocates. Capacity of points is
+`maxSamplesPerBlock` for each parameter, up to `maxPointCapacity`. When a block has more
+points than that, earlier points of a queue are dropped, and the last point of each queue
+is always kept. Events beyond the capacity are dropped.
+
+Usage in `PlugProcessor::setupProcessing`:
+
+```
+automation.setup(setup.maxSamplesPerBlock, dsp.param.value.size());
+```
+
+Usage in `PlugProcessor::process`:
+
+```
+automation.receive(data, dsp.param);
+// Early return path must call `automation.flush(dsp.param)`.
+automation.dispatch(
+  data.numSamples, dsp.param, [&](const Vst::Event &event) { handleEvent(event); },
+  [&](int32 offset, int32 length) {
+    dsp.setParameters();
+    dsp.process(size_t(length), out0 + offset, out1 + offset);
+  });
+```
+*/
+class AutomationDispatcher {
+private:
+  struct Point {
+    int32 offset = 0;
+    int32 order = 0;
+    Vst::ParamID id = 0;
+    Vst::ParamValue value = 0;
+  };
+
+  struct Event {
+    int32 order = 0;
+    Vst::Event event{};
+  };
+
+  std::vector<Point> points;
+  std::vector<Event> events;
+  size_t nPoint = 0;
+  size_t nEvent = 0;
+  size_t pointIndex = 0;
+
+  template<typename Parameter> inline void apply(Parameter &param, const Point &point)
+  {
+    param.value[point.id]->setFromNormalized(point.value);
+  }
+
+public:
+  static constexpr size_t maxPointCapacity = size_t(1) << 20;
+
+  int32 minSubBlockLength = 1;
+
+  AutomationDispatcher(size_t pointCapacity = 4096, size_t eventCapacity = 1024)
+  {
+    points.resize(pointCapacity);
+    events.resize(eventCapacity);
+  }
+
+  // Not real-time safe. Call from `setupProcessing`.
+  void setup(int32 maxSamplesPerBlock, size_t nParameter)
+  {
+    const size_t maxSamples = size_t(std::max(int32(1), maxSamplesPerBlock));
+    const size_t nPointRequired = maxSamples * std::max(size_t(1), nParameter);
+    points.resize(std::max(nParameter, std::min(nPointRequired, maxPointCapacity)));
+    events.resize(std::max(size_t(1024), 2 * maxSamples)); // Note-on and off per sample.
+    nPoint = 0;
+    nEvent = 0;
+    pointIndex = 0;
+  }
+
+  /**
+  Collects parameter changes and events in `data`. Points at the start of the block are
+  applied immediately, so `startup()` and other code running before `dispatch` can see
+  them.
+  */
+  template<typename Parameter> void receive(Vst::ProcessData &data, Parameter &param)
+  {
+    nPoint = 0;
+    nEvent = 0;
+    pointIndex = 0;
+
+    int32 order = 0;
+    if (data.inputParameterChanges) {
+      int32 parameterCount = data.inputParameterChanges->getParameterCount();
+      for (int32 index = 0; index < parameterCount; ++index) {
+        auto queue = data.inputParameterChanges->getParameterData(index);
+        if (!queue) continue;
+        const auto id = queue->getParameterId();
+        if (id >= param.value.size()) continue;
+
+        // Leaves a slot for the last point of each remaining queue.
+        const size_t nQueueLeft = size_t(parameterCount - index - 1);
+        const size_t room = points.size() - nPoint;
+        if (room == 0) break;
+        const size_t budget = room > nQueueLeft ? room - nQueueLeft : 1;
+        const int32 pointCount = queue->getPointCount();
+        const int32 first = std::max(int32(0), pointCount - int32(budget));
+
+        for (int32 pt = first; pt < pointCount; ++pt) {
+          Point &point = points[nPoint];
+          if (queue->getPoint(pt, point.offset, point.value) != kResultTrue) continue;
+          point.order = order++;
+          point.id = id;
+          ++nPoint;
+        }
+      }
+    }
+    auto pointOrder = [](const Point &a, const Point &b) {
+      return a.offset == b.offset ? a.order < b.order : a.offset < b.offset;
+    };
+    std::sort(points.begin(), points.begin() + nPoint, pointOrder);
+
+    if (data.inputEvents) {
+      order = 0;
+      const int32 eventCount = data.inputEvents->getEventCount();
+      for (int32 index = 0; index < eventCount && nEvent < events.size(); ++index) {
+        Event &ev = events[nEvent];
+        if (data.inputEvents->getEvent(index, ev.event) != kResultOk) continue;
+        ev.order = order++;
+        ++nEvent;
+      }
+      auto eventOrder = [](const Event &a, const Event &b) {
+        return a.event.sampleOffset == b.event.sampleOffset
+          ? a.order < b.order
+          : a.event.sampleOffset < b.event.sampleOffset;
+      };
+      std::sort(events.begin(), events.begin() + nEvent, eventOrder);
+    }
+
+    for (; pointIndex < nPoint && points[pointIndex].offset <= 0; ++pointIndex)
+      apply(param, points[pointIndex]);
+  }
+
+  // True if no parameter change or event arrived in current block.
+  bool isIdle() const { return nPoint == 0 && nEvent == 0; }
+
+  // Applies remaining points without processing. Used when the host doesn't request audio.
+  template<typename Parameter> void flush(Parameter &param)
+  {
+    for (; pointIndex < nPoint; ++pointIndex) apply(param, points[pointIndex]);
+  }
+
+  /**
+  `handleEvent(const Vst::Event &)` is called before `process(int32 offset, int32 length)`
+  of the sub-block. Events past the end of the block are passed to the last sub-block.
+  */
+  template<typename Parameter, typename EventFunc, typename ProcessFunc>
+  void dispatch(
+    int32 numSamples, Parameter &param, EventFunc handleEvent, ProcessFunc process)
+  {
+    const int32 minLength = std::max(int32(1), minSubBlockLength);
+
+    size_t eventIndex = 0;
+    int32 start = 0;
+    while (start < numSamples) {
+      for (; pointIndex < nPoint && points[pointIndex].offset <= start; ++pointIndex)
+        apply(param, points[pointIndex]);
+
+      int32 end = numSamples;
+      if (pointIndex < nPoint) {
+        end = std::min(numSamples, std::max(points[pointIndex].offset, start + minLength));
+      }
+      const int32 length = end - start;
+
+      for (; eventIndex < nEvent; ++eventIndex) {
+        auto event = events[eventIndex].event;
+        if (end < numSamples && event.sampleOffset >= end) break;
+        event.sampleOffset = std::clamp(event.sampleOffset - start, int32(0), length - 1);
+        handleEvent(event);
+      }
+
+      process(start, length);
+      start = end;
+    }
+
+    flush(param);
+  }
+
+  // For plugins without event input.
+  template<typename Parameter, typename ProcessFunc>
+  void dispatch(int32 numSamples, Parameter &param, ProcessFunc process)
+  {
+    dispatch(numSamples, param, [](const Vst::Event &) {}, process);
+  }
+};
+
+} // namespace Steinberg::Synth
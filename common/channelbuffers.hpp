@@ -0,0 +1,39 @@
+// SPDX-License-Identifier: GPL-3.0-only
+// Copyright Takamitsu Endo (ryukau@gmail.com)
+
+#pragma once
+
+#include "pluginterfaces/vst/ivstaudioprocessor.h"
+
+#include <type_traits>
+
+namespace Steinberg::Synth {
+
+/**
+Returns `channelBuffers32` or `channelBuffers64` of `bus` depending on `Sample`.
+
+Used to write `PlugProcessor::process` once as a template on `Vst::Sample32` and
+`Vst::Sample64`, and dispatch on `ProcessData::symbolicSampleSize`.
+*/
+template<typename Sample> inline Sample **channelBuffers(Vst::AudioBusBuffers &bus)
+{
+  static_assert(
+    std::is_same_v<Sample, Vst::Sample32> || std::is_same_v<Sample, Vst::Sample64>,
+    "Sample must be Vst::Sample32 or Vst::Sample64.");
+
+  if constexpr (std::is_same_v<Sample, Vst::Sample64>) {
+    return bus.channelBuffers64;
+  } else {
+    return bus.channelBuffers32;
+  }
+}
+
+// For `PlugProcessor::canProcessSampleSize`.
+inline tresult canProcess32Or64(int32 symbolicSampleSize)
+{
+  return symbolicSampleSize == Vst::kSample32 || symbolicSampleSize == Vst::kSample64
+    ? kResultTrue
+    : kResultFalse;
+}
+
+} // namespace Steinberg::Synth
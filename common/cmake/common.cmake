@@ -21,6 +21,21 @@ function(add_fftw3)
   set_property(TARGET fftw3 PROPERTY IMPORTED_LOCATION ${fftw3_path})
 endfunction()
 
+# `benchdsp_*` reuses `test/testdsp.cpp` and the DSP library built for `testdsp_*`.
+# `BENCH_DSP` makes the `Tester` alias in `test/testdsp.cpp` select a benchmark.
+function(build_bench plugin_name dsp_library)
+  set(target "benchdsp_${plugin_name}")
+
+  add_executable(${target} test/testdsp.cpp)
+  target_compile_definitions(${target} PRIVATE
+    BENCH_DSP
+    UHHYOU_PLUGIN_NAME="${plugin_name}")
+  target_link_libraries(${target} PRIVATE
+    SndFile::sndfile
+    ${dsp_library}
+    fftw3)
+endfunction()
+
 function(add_common_resources target)
   # Custom font.
   smtg_target_add_plugin_resource(${target}
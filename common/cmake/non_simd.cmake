@@ -26,6 +26,8 @@ function(build_test additional_sources)
     SndFile::sndfile
     ${src}
     fftw3)
+
+  build_bench(${PLUGIN_NAME} ${src})
 endfunction()
 
 function(build_vst3 plug_sources)
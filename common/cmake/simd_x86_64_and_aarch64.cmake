@@ -25,15 +25,73 @@ function(build_test)
     SndFile::sndfile
     ${src}
     fftw3)
+
+  build_bench(${PLUGIN_NAME} ${src})
+endfunction()
+
+# On Linux x86_64, `source/dsp/dspcore.cpp` is compiled once for each instruction set, and
+# `PlugProcessor` picks one with `instrset_detect()` at construction.
+#
+# A variant has its own `VCL_NAMESPACE` and `SomeDSP` namespace, but it also instantiates
+# code outside of them, like `GlobalParameter` and the standard library. These inline
+# definitions would be merged with the baseline copies by the linker, and wider
+# instructions could leak into the baseline path. To avoid it, a variant is compiled with
+# `-fvisibility=hidden`, then relinked with `ld -r --force-group-allocation` to dissolve
+# COMDAT groups, and `objcopy --localize-hidden` turns all of its hidden symbols into
+# local ones. Only `createDSPCore_*` marked by `UHHYOU_DSPCORE_EXPORT` stays global.
+function(add_simd_dspcore target)
+  set(flags_AVX -mavx)
+  set(flags_AVX2 -mavx2 -mfma)
+  set(flags_AVX512 -mavx512f -mavx512cd -mavx512bw -mavx512dq -mavx512vl -mfma)
+
+  foreach(instrset AVX AVX2 AVX512)
+    set(dspcore "${target}_dspcore_${instrset}")
+    add_library(${dspcore} OBJECT source/dsp/dspcore.cpp)
+    set_target_properties(${dspcore} PROPERTIES POSITION_INDEPENDENT_CODE ON)
+    target_compile_definitions(${dspcore} PRIVATE
+      UHHYOU_INSTRSET_${instrset}
+      VCL_NAMESPACE=vcl_${instrset}
+      SomeDSP=SomeDSP_${instrset})
+    target_compile_options(${dspcore} PRIVATE
+      ${flags_${instrset}}
+      -fvisibility=hidden
+      -fvisibility-inlines-hidden)
+    target_include_directories(${dspcore} PRIVATE ../common)
+    target_link_libraries(${dspcore} PRIVATE sdk)
+
+    set(relinked "${CMAKE_CURRENT_BINARY_DIR}/${dspcore}.relinked.o")
+    set(localized "${CMAKE_CURRENT_BINARY_DIR}/${dspcore}.o")
+    add_custom_command(
+      OUTPUT ${localized}
+      COMMAND ${CMAKE_LINKER} -r --force-group-allocation
+        $<TARGET_OBJECTS:${dspcore}> -o ${relinked}
+      COMMAND ${CMAKE_OBJCOPY} --localize-hidden ${relinked} ${localized}
+      DEPENDS ${dspcore} $<TARGET_OBJECTS:${dspcore}>
+      COMMAND_EXPAND_LISTS
+      VERBATIM)
+    set_source_files_properties(${localized} PROPERTIES
+      EXTERNAL_OBJECT TRUE
+      GENERATED TRUE)
+    target_sources(${target} PRIVATE ${localized})
+  endforeach()
+
+  target_sources(${target} PRIVATE ../lib/vcl/instrset_detect.cpp)
+  target_compile_definitions(${target} PRIVATE UHHYOU_SIMD_RUNTIME_DISPATCH)
 endfunction()
 
 function(build_vst3 plug_sources)
   get_plugin_name(PLUGIN_NAME)
   set(target ${PLUGIN_NAME})
 
-  smtg_add_vst3plugin(${target}
-    source/dsp/dspcore.cpp
-    ${plug_sources})
+  # Runtime dispatch requires GNU `ld -r` and `objcopy`. Other platforms keep one build.
+  if(CMAKE_SYSTEM_NAME STREQUAL "Linux" AND CMAKE_SYSTEM_PROCESSOR MATCHES "x86_64|AMD64")
+    smtg_add_vst3plugin(${target} ${plug_sources})
+    add_simd_dspcore(${target})
+  else()
+    smtg_add_vst3plugin(${target}
+      source/dsp/dspcore.cpp
+      ${plug_sources})
+  endif()
 
   if(MSVC)
     # # Too many warnings are emitted from VST 3 SDK.
@@ -0,0 +1,186 @@
+// SPDX-License-Identifier: GPL-3.0-only
+// Copyright Takamitsu Endo (ryukau@gmail.com)
+
+#pragma once
+
+#include "spscqueue.hpp"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+
+namespace SomeDSP {
+
+/**
+Builds `Product` from `Request` on a worker thread, and hands it over to audio thread.
+
+`Product::build(const Request &)` is called on worker thread, and it may allocate.
+Products are built into `nSlot` slots allocated up front, and the slots are reused.
+Nothing is allocated or freed on audio thread.
+
+Audio thread calls `request` to ask for a new product, and calls `acquire` at a block
+boundary to switch to the latest finished one. The product used before `acquire` is kept
+as `getPrevious()` until `releasePrevious` is called, so it can be crossfaded. 3 slots are
+enough for current, previous, and the one under construction.
+
+`reset` builds synchronously on the calling thread, and (re)starts the worker. It must not
+be called while audio thread is processing.
+*/
+template<typename Request, typename Product, size_t nSlot = 3> class BackgroundBuilder {
+private:
+  static_assert(nSlot >= 3 && nSlot <= 8, "nSlot must be in [3, 8].");
+
+  // Bit 0-7 is a mask of slots used by audio thread. Bit 8-15 is the index of a finished
+  // slot plus 1, or 0 when nothing is ready. Packed in a word to update both atomically.
+  static constexpr uint32_t busyMask = 0xff;
+  static constexpr uint32_t readyShift = 8;
+
+  std::array<Product, nSlot> slots;
+  std::atomic<uint32_t> state{0};
+
+  SPSCQueue<Request, 4> requests;
+  std::atomic<uint32_t> wakeCounter{0};
+  std::atomic<bool> isRunning{false};
+  std::thread worker;
+
+  // Only touched by audio thread.
+  Request pending{};
+  bool isPending = false;
+  int current = -1;
+  int previous = -1;
+
+  static uint32_t bit(int index) { return index < 0 ? 0 : uint32_t(1) << index; }
+
+  static int findFreeSlot(uint32_t st)
+  {
+    const uint32_t ready = st >> readyShift;
+    for (size_t idx = 0; idx < nSlot; ++idx) {
+      if ((st & bit(int(idx))) == 0 && ready != idx + 1) return int(idx);
+    }
+    return -1;
+  }
+
+  void wake()
+  {
+    wakeCounter.fetch_add(1, std::memory_order_release);
+    wakeCounter.notify_one();
+  }
+
+  void flushRequest()
+  {
+    if (!isPending || !requests.push(pending)) return;
+    isPending = false;
+    wake();
+  }
+
+  void run()
+  {
+    Request rq{};
+    while (isRunning.load(std::memory_order_acquire)) {
+      const auto seen = wakeCounter.load(std::memory_order_acquire);
+
+      bool hasRequest = false;
+      while (requests.pop(rq)) hasRequest = true;
+      if (!hasRequest) {
+        wakeCounter.wait(seen, std::memory_order_acquire);
+        continue;
+      }
+
+      // All slots are taken while audio thread is crossfading and a product is waiting.
+      int slot = findFreeSlot(state.load(std::memory_order_acquire));
+      while (slot < 0 && isRunning.load(std::memory_order_acquire)) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        slot = findFreeSlot(state.load(std::memory_order_acquire));
+      }
+      if (slot < 0) break;
+
+      slots[slot].build(rq);
+
+      // A product that was not acquired yet is overwritten, and its slot becomes free.
+      auto st = state.load(std::memory_order_relaxed);
+      while (!state.compare_exchange_weak(
+        st, (st & busyMask) | (uint32_t(slot + 1) << readyShift),
+        std::memory_order_acq_rel, std::memory_order_relaxed))
+      {
+      }
+    }
+  }
+
+  void stop()
+  {
+    if (!worker.joinable()) return;
+    isRunning.store(false, std::memory_order_release);
+    wake();
+    worker.join();
+  }
+
+public:
+  BackgroundBuilder() = default;
+  BackgroundBuilder(const BackgroundBuilder &) = delete;
+  BackgroundBuilder &operator=(const BackgroundBuilder &) = delete;
+
+  ~BackgroundBuilder() { stop(); }
+
+  void reset(const Request &request)
+  {
+    stop();
+
+    Request discard{};
+    while (requests.pop(discard)) continue;
+    isPending = false;
+
+    slots[0].build(request);
+    current = 0;
+    previous = -1;
+    state.store(bit(current), std::memory_order_release);
+
+    isRunning.store(true, std::memory_order_release);
+    worker = std::thread(&BackgroundBuilder::run, this);
+  }
+
+  // Audio thread. The latest request wins when requests come faster than builds.
+  void request(const Request &request)
+  {
+    pending = request;
+    isPending = true;
+    flushRequest();
+  }
+
+  /**
+  Audio thread. Returns true when a finished product becomes current. Nothing happens
+  while the previous product is still held.
+  */
+  bool acquire()
+  {
+    flushRequest();
+    if (previous >= 0) return false;
+
+    auto st = state.load(std::memory_order_acquire);
+    int ready;
+    do {
+      ready = int(st >> readyShift) - 1;
+      if (ready < 0) return false;
+    } while (!state.compare_exchange_weak(
+      st, bit(ready) | bit(current), std::memory_order_acq_rel,
+      std::memory_order_acquire));
+
+    previous = current;
+    current = ready;
+    return true;
+  }
+
+  // Audio thread. Returns the slot of previous product to worker thread.
+  void releasePrevious()
+  {
+    if (previous < 0) return;
+    state.fetch_and(~bit(previous), std::memory_order_acq_rel);
+    previous = -1;
+  }
+
+  const Product &get() const { return slots[current]; }
+  const Product *getPrevious() const { return previous < 0 ? nullptr : &slots[previous]; }
+};
+
+} // namespace SomeDSP
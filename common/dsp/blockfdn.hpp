@@ -0,0 +1,113 @@
+// SPDX-License-Identifier: GPL-3.0-only
+// Copyright Takamitsu Endo (ryukau@gmail.com)
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+
+namespace SomeDSP {
+
+/**
+`y[k] = M * x[k]` for `nFrame` frames. `column[j][i]` is the element of `M` at i-th row
+and j-th column.
+
+Column major order makes the inner loop contiguous, and a column is reused for `tile`
+frames while it's on registers. Summation order is the same as naive matrix-vector
+product, so the result is also the same.
+*/
+template<typename Sample, size_t length>
+void multiplyColumnMajor(
+  const std::array<std::array<Sample, length>, length> &column,
+  const std::array<Sample, length> *x,
+  std::array<Sample, length> *y,
+  size_t nFrame)
+{
+  constexpr size_t tile = 4;
+
+  for (size_t start = 0; start < nFrame; start += tile) {
+    const size_t nTile = std::min(tile, nFrame - start);
+
+    // Local accumulator. Writing to `y` directly prevents vectorization, because `y` may
+    // alias `column`.
+    std::array<std::array<Sample, length>, tile> sum{};
+    for (size_t j = 0; j < length; ++j) {
+      const auto &cl = column[j];
+      for (size_t k = 0; k < nTile; ++k) {
+        const auto xj = x[start + k][j];
+        auto &sm = sum[k];
+        for (size_t i = 0; i < length; ++i) sm[i] += cl[i] * xj;
+      }
+    }
+    std::copy(sum.begin(), sum.begin() + nTile, y + start);
+  }
+}
+
+/**
+Frame buffer for block processing of feedback delay network (FDN).
+
+A sample of FDN is written as following:
+
+```
+m[n] = M * y[n - 1]      // Feedback matrix.
+x[n] = f(m[n], input[n]) // Input, feedback gain, stereo cross and so on.
+y[n] = g(D(x[n]))        // Delays and per lane filters.
+```
+
+When all the delay times are longer than `B` samples, delays in next `B` frames only read
+`x` which is already written. So `y` of `B` frames can be computed before any `x`, and
+the feedback matrix is multiplied to `B` frames at once. A block goes as following:
+
+1. Call `blockSize()`. If it returns 0, process a frame in per sample path with `last()`
+   as `y[n - 1]` and `mixed(0)` as `m[n]`. Skip the rest.
+2. Read delays and apply filters for `B` frames. Write results to `output(k)`.
+3. Call `multiply()`. `mixed(k)` becomes `M * y[k - 1]`, where `y[-1]` is `last()`.
+4. Compute `x` from `mixed(k)`, and write `x` of `B` frames to delays.
+5. Call `finish(B)`.
+
+`Matrix` must have `process(const Frame *x, Frame *y, size_t nFrame)`.
+*/
+template<typename Sample, size_t length, size_t maxBlockSize = 64> class BlockFdnBuffer {
+public:
+  using Frame = std::array<Sample, length>;
+
+private:
+  std::array<Frame, maxBlockSize + 1> y{}; // `y[0]` is the last frame of previous block.
+  std::array<Frame, maxBlockSize> m{};
+
+public:
+  /**
+  `minDelayTime` is the minimum of all delay times at the start of block, in samples.
+  `slewRate` is the maximum change of a delay time per sample.
+
+  At k-th frame, a delay time is at least `minDelayTime - (k + 1) * slewRate`, and its
+  integer part must be greater than `k`. 1 sample is subtracted as a margin for rounding.
+  */
+  static size_t blockSize(Sample minDelayTime, Sample slewRate, size_t maxFrames)
+  {
+    auto frames
+      = (minDelayTime - Sample(1)) / (Sample(1) + std::max(slewRate, Sample(0)));
+    if (!(frames >= Sample(1))) return 0; // Also catches NaN.
+    return std::min(size_t(std::min(frames, Sample(maxBlockSize))), maxFrames);
+  }
+
+  void reset()
+  {
+    y.fill({});
+    m.fill({});
+  }
+
+  Frame &last() { return y[0]; }
+  Frame &output(size_t frame) { return y[frame + 1]; }
+  Frame &mixed(size_t frame) { return m[frame]; }
+
+  template<typename Matrix> void multiply(Matrix &matrix, size_t nFrame)
+  {
+    matrix.process(y.data(), m.data(), nFrame);
+  }
+
+  void finish(size_t nFrame) { y[0] = y[nFrame]; }
+};
+
+} // namespace SomeDSP
@@ -0,0 +1,54 @@
+// SPDX-License-Identifier: GPL-3.0-only
+// Copyright Takamitsu Endo (ryukau@gmail.com)
+
+#pragma once
+
+#include "../../lib/ghc/fs_std.hpp"
+
+#include <cstdlib>
+#include <string>
+#include <system_error>
+
+namespace SomeDSP {
+
+/**
+Returns `UhhyouPlugins/<relative>` in user cache directory.
+
+- Windows: `%LocalAppData%`
+- macOS: `$HOME/Library/Caches`
+- Others: `$XDG_CACHE_HOME` or `$HOME/.cache`
+
+Caches are opt-in. Empty path is returned when the directory doesn't exist.
+*/
+inline fs::path getUserCacheDirectory(const fs::path &relative)
+{
+  fs::path cacheHome;
+#ifdef _WIN32
+  const char *localAppData = std::getenv("LocalAppData");
+  if (localAppData != nullptr) cacheHome = fs::path(localAppData);
+#elif __APPLE__
+  const char *home = std::getenv("HOME");
+  if (home != nullptr) cacheHome = fs::path(home) / "Library/Caches";
+#else
+  const char *cacheDir = std::getenv("XDG_CACHE_HOME");
+  const char *home = std::getenv("HOME");
+  if (cacheDir != nullptr) {
+    cacheHome = fs::path(cacheDir);
+  } else if (home != nullptr) {
+    cacheHome = fs::path(home) / ".cache";
+  }
+#endif
+  if (cacheHome.empty()) return fs::path();
+
+  auto directory = cacheHome / "UhhyouPlugins" / relative;
+  std::error_code ec;
+  return fs::is_directory(directory, ec) ? directory : fs::path();
+}
+
+// Directory of `TableDiskCache`.
+inline fs::path getTableCacheDirectory(const std::string &pluginName)
+{
+  return getUserCacheDirectory(fs::path(pluginName) / "table");
+}
+
+} // namespace SomeDSP
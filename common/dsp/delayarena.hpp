@@ -0,0 +1,65 @@
+// SPDX-License-Identifier: GPL-3.0-only
+// Copyright Takamitsu Endo (ryukau@gmail.com)
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace SomeDSP {
+
+/**
+One block of memory shared by many delay buffers.
+
+`layout(fn)` calls `fn(arena)` twice. In the first call, `allocate()` only counts the size
+and returns `nullptr`. Then the block is allocated, and the second call hands out the
+pointers in the same order. So `fn` must request the same sizes in both calls, and a
+delay must not touch its buffer in `fn`. Requesting in processing order places the
+buffers in the order they are accessed.
+
+Each buffer starts at 64 bytes boundary. Pointers are invalidated by next `layout()`, and
+an owner of the arena must not be copied or moved after `layout()`.
+*/
+template<typename Sample> class DelayArena {
+private:
+  static constexpr size_t alignment = 64; // In bytes.
+  static constexpr size_t alignSize = alignment / sizeof(Sample);
+
+  std::vector<Sample> memory;
+  Sample *base = nullptr;
+  size_t used = 0;
+
+public:
+  template<typename Fn> void layout(Fn fn)
+  {
+    base = nullptr;
+    used = 0;
+    fn(*this);
+
+    const size_t size = used;
+    memory.resize(size + alignSize);
+
+    void *ptr = memory.data();
+    size_t space = memory.size() * sizeof(Sample);
+    std::align(alignment, size * sizeof(Sample), ptr, space);
+    base = static_cast<Sample *>(ptr);
+
+    used = 0;
+    fn(*this);
+
+    reset();
+  }
+
+  Sample *allocate(size_t size)
+  {
+    Sample *ptr = base == nullptr ? nullptr : base + used;
+    used += (size + alignSize - 1) / alignSize * alignSize;
+    return ptr;
+  }
+
+  void reset() { std::fill(memory.begin(), memory.end(), Sample(0)); }
+};
+
+} // namespace SomeDSP
@@ -0,0 +1,207 @@
+// SPDX-License-Identifier: GPL-3.0-only
+// Copyright Takamitsu Endo (ryukau@gmail.com)
+
+#pragma once
+
+#include "../../lib/fftw3/fftw3.h"
+#include "cachedirectory.hpp"
+
+#include <algorithm>
+#include <complex>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <iterator>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace SomeDSP {
+
+/**
+Process-wide cache of FFTW3 plans.
+
+FFTW3 isn't thread safe except `fftwf_execute*`. All the other FFTW3 calls go through this
+class, so that plugin instances share one lock.
+
+A plan is keyed by transform kind, size, and alignment of arrays. Plans are made with
+`FFTW_ESTIMATE`, which doesn't touch the arrays. They are executed by new-array interface
+`fftwf_execute_dft_*`, so a plan is shared by all arrays of the same alignment. Plans are
+kept until the module is unloaded.
+
+Wisdom is imported from `UhhyouPlugins/fftw/wisdom` in user cache directory before the
+first plan, if the file exists. It can be made by `fftwf-wisdom` bundled with FFTW3.
+Wisdom is never exported, because `FFTW_ESTIMATE` plans don't add anything to it.
+*/
+class FftwPlanCache {
+public:
+  enum class Kind : uint8_t { realForward, realInverse };
+
+private:
+  struct Key {
+    Kind kind = Kind::realForward;
+    int size = 0;
+    int inAlignment = 0;
+    int outAlignment = 0;
+    bool isInPlace = false;
+
+    bool operator==(const Key &) const = default;
+  };
+
+  std::mutex mutex;
+  std::vector<std::pair<Key, fftwf_plan>> plans;
+
+  FftwPlanCache()
+  {
+    auto directory = getUserCacheDirectory("fftw");
+    if (!directory.empty()) importWisdom(directory / "wisdom");
+  }
+
+  ~FftwPlanCache()
+  {
+    for (auto &entry : plans) fftwf_destroy_plan(entry.second);
+  }
+
+public:
+  FftwPlanCache(const FftwPlanCache &) = delete;
+  FftwPlanCache &operator=(const FftwPlanCache &) = delete;
+
+  static FftwPlanCache &get()
+  {
+    static FftwPlanCache cache;
+    return cache;
+  }
+
+  // `in` and `out` are only used to take alignment.
+  fftwf_plan plan(Kind kind, size_t size, void *in, void *out)
+  {
+    const Key key{
+      kind, int(size), fftwf_alignment_of(static_cast<float *>(in)),
+      fftwf_alignment_of(static_cast<float *>(out)), in == out};
+
+    const std::lock_guard<std::mutex> fftwLock(mutex);
+
+    for (const auto &entry : plans) {
+      if (entry.first == key) return entry.second;
+    }
+
+    fftwf_plan newPlan = kind == Kind::realForward
+      ? fftwf_plan_dft_r2c_1d(
+        key.size, static_cast<float *>(in), static_cast<fftwf_complex *>(out),
+        FFTW_ESTIMATE)
+      : fftwf_plan_dft_c2r_1d(
+        key.size, static_cast<fftwf_complex *>(in), static_cast<float *>(out),
+        FFTW_ESTIMATE);
+    plans.emplace_back(key, newPlan);
+    return newPlan;
+  }
+
+  void *allocate(size_t bytes)
+  {
+    const std::lock_guard<std::mutex> fftwLock(mutex);
+    return fftwf_malloc(bytes);
+  }
+
+  void release(void *ptr)
+  {
+    if (ptr == nullptr) return;
+    const std::lock_guard<std::mutex> fftwLock(mutex);
+    fftwf_free(ptr);
+  }
+
+  bool importWisdom(const fs::path &path)
+  {
+    fs::ifstream ifs(path, std::ios::binary);
+    if (!ifs) return false;
+    std::string wisdom{std::istreambuf_iterator<char>(ifs), {}};
+
+    const std::lock_guard<std::mutex> fftwLock(mutex);
+    return fftwf_import_wisdom_from_string(wisdom.c_str()) != 0;
+  }
+};
+
+/**
+Array allocated by `fftwf_malloc`, which satisfies alignment of SIMD plans. Zero filled
+on `resize`.
+*/
+template<typename T> class FftwBuffer {
+private:
+  T *ptr = nullptr;
+  size_t length = 0;
+
+public:
+  FftwBuffer() = default;
+  explicit FftwBuffer(size_t size) { resize(size); }
+
+  FftwBuffer(const FftwBuffer &) = delete;
+  FftwBuffer &operator=(const FftwBuffer &) = delete;
+
+  ~FftwBuffer() { FftwPlanCache::get().release(ptr); }
+
+  void resize(size_t size)
+  {
+    if (size != length) {
+      auto &cache = FftwPlanCache::get();
+      cache.release(ptr);
+      ptr = static_cast<T *>(cache.allocate(sizeof(T) * size));
+      length = size;
+    }
+    std::fill(ptr, ptr + length, T{});
+  }
+
+  size_t size() const { return length; }
+  T *data() { return ptr; }
+  const T *data() const { return ptr; }
+  T *begin() { return ptr; }
+  T *end() { return ptr + length; }
+  const T *begin() const { return ptr; }
+  const T *end() const { return ptr + length; }
+  T &operator[](size_t index) { return ptr[index]; }
+  const T &operator[](size_t index) const { return ptr[index]; }
+};
+
+/**
+Real to complex FFT without scaling. Output has `size / 2 + 1` bins.
+
+Arrays given to `execute` must have the same alignment as the ones given to `init`.
+Buffers from `FftwBuffer` always satisfy this.
+*/
+class RealForwardFft {
+private:
+  fftwf_plan plan = nullptr;
+
+public:
+  void init(size_t size, float *in, std::complex<float> *out)
+  {
+    plan = FftwPlanCache::get().plan(FftwPlanCache::Kind::realForward, size, in, out);
+  }
+
+  void execute(float *in, std::complex<float> *out) const
+  {
+    fftwf_execute_dft_r2c(plan, in, reinterpret_cast<fftwf_complex *>(out));
+  }
+};
+
+/**
+Complex to real inverse FFT without scaling. `in` is overwritten.
+
+Arrays given to `execute` must have the same alignment as the ones given to `init`.
+*/
+class RealInverseFft {
+private:
+  fftwf_plan plan = nullptr;
+
+public:
+  void init(size_t size, std::complex<float> *in, float *out)
+  {
+    plan = FftwPlanCache::get().plan(FftwPlanCache::Kind::realInverse, size, in, out);
+  }
+
+  void execute(std::complex<float> *in, float *out) const
+  {
+    fftwf_execute_dft_c2r(plan, reinterpret_cast<fftwf_complex *>(in), out);
+  }
+};
+
+} // namespace SomeDSP
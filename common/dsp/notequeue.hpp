@@ -0,0 +1,98 @@
+// SPDX-License-Identifier: GPL-3.0-only
+// Copyright Takamitsu Endo (ryukau@gmail.com)
+
+#pragma once
+
+#include <algorithm>
+#include <vector>
+
+namespace SomeDSP {
+
+/**
+Note event queue sorted by `Note::frame`.
+
+Notes are sorted at `push`. Insertion is O(1) when notes arrive in order, which is the
+usual case for `IEventList`. Notes on the same frame keep the order of arrival. `pop` only
+checks the front, so calling it on every sample is cheap.
+
+Capacity is fixed by `reserve`. No allocation happens on audio thread. When the queue is
+full, note-off is never dropped. `push` evicts the last pending note-on to make room for a
+note-off. When no note-on is pending, `push` returns false, and the caller must apply the
+note-off at the current frame. An incoming note-on is dropped. `overflowCount` counts all
+of them.
+
+`Note` must have `bool isNoteOn` and `frame`.
+*/
+template<typename Note> class NoteQueue {
+private:
+  std::vector<Note> buffer;
+  size_t head = 0;
+  size_t tail = 0;
+  size_t nOverflow = 0;
+
+  // Removes the last pending note-on. Returns false when there's none.
+  bool evictNoteOn()
+  {
+    for (size_t index = tail; index > head; --index) {
+      if (!buffer[index - 1].isNoteOn) continue;
+      auto it = buffer.begin();
+      std::move(it + index, it + tail, it + index - 1);
+      --tail;
+      return true;
+    }
+    return false;
+  }
+
+public:
+  NoteQueue(size_t capacity = 1024) { buffer.resize(capacity); }
+
+  // Same as `std::vector::reserve`, this never shrinks the capacity.
+  void reserve(size_t capacity)
+  {
+    if (capacity > buffer.size()) buffer.resize(capacity);
+  }
+
+  bool empty() const { return head >= tail; }
+  size_t size() const { return tail - head; }
+
+  // Number of notes dropped, evicted, or returned to the caller since construction.
+  size_t overflowCount() const { return nOverflow; }
+
+  void clear()
+  {
+    head = 0;
+    tail = 0;
+  }
+
+  // Returns false when `note` isn't queued. See the class comment for overflow.
+  bool push(const Note &note)
+  {
+    if (head >= tail) clear();
+    if (tail >= buffer.size()) {
+      if (head > 0) {
+        std::move(buffer.begin() + head, buffer.begin() + tail, buffer.begin());
+        tail -= head;
+        head = 0;
+      } else {
+        ++nOverflow;
+        if (note.isNoteOn || !evictNoteOn()) return false;
+      }
+    }
+
+    size_t index = tail++;
+    while (index > head && note.frame < buffer[index - 1].frame) {
+      buffer[index] = buffer[index - 1];
+      --index;
+    }
+    buffer[index] = note;
+    return true;
+  }
+
+  // Calls `func(Note &)` on notes at or before `frame`, and removes them from queue.
+  template<typename Func> inline void pop(size_t frame, Func func)
+  {
+    while (head < tail && buffer[head].frame <= frame) func(buffer[head++]);
+  }
+};
+
+} // namespace SomeDSP
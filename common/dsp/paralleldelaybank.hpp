@@ -0,0 +1,129 @@
+// SPDX-License-Identifier: GPL-3.0-only
+// Copyright Takamitsu Endo (ryukau@gmail.com)
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace SomeDSP {
+
+/**
+`length` lanes of linear interpolated delay, in one buffer.
+
+Lanes are interleaved as `buffer[position * length + lane]`. A write of all lanes is a
+contiguous store, and a read is a gather at `position * length + lane`. Capacity of a lane
+is power of 2, so positions wrap by a mask. The buffer starts at 64 bytes boundary.
+
+Kernels are split into a loop of index computation, and a loop of gather and
+interpolation. Both are free of branches, so compiler can vectorize them, and use gather
+instructions when available.
+
+Delay time is clamped into `[0, getMaxTime()]`. `process` writes the input before
+reading, so that time 0 returns the input. `read` is for block processing, and it requires
+the integer part of all the delay times to be greater than `offset`.
+*/
+template<typename Sample, size_t length> class ParallelDelayBank {
+public:
+  using Frame = std::array<Sample, length>;
+
+private:
+  static constexpr size_t alignment = 64; // In bytes.
+
+  std::vector<Sample> arena;
+  size_t start = 0; // Index of the first aligned element in `arena`.
+  uint32_t mask = 0;
+  uint32_t wptr = 0;
+  Sample maxTime = 0;
+
+  std::array<int32_t, length> index0{};
+  std::array<int32_t, length> index1{};
+  Frame fraction{};
+
+  void computeIndex(size_t offset, const Frame &timeInSample)
+  {
+    const auto base = int32_t(wptr + offset);
+    const auto msk = int32_t(mask);
+    for (size_t idx = 0; idx < length; ++idx) {
+      Sample clamped = std::clamp(timeInSample[idx], Sample(0), maxTime);
+      int32_t timeInt = int32_t(clamped);
+      fraction[idx] = clamped - Sample(timeInt);
+
+      index0[idx] = ((base - timeInt) & msk) * int32_t(length) + int32_t(idx);
+      index1[idx] = ((base - timeInt - 1) & msk) * int32_t(length) + int32_t(idx);
+    }
+  }
+
+  void gather(Frame &output)
+  {
+    // Local result avoids aliasing between `output` and members, which blocks gathers.
+    const Sample *buf = arena.data() + start;
+    Frame result;
+    for (size_t idx = 0; idx < length; ++idx) {
+      auto x0 = buf[index0[idx]];
+      auto x1 = buf[index1[idx]];
+      result[idx] = x0 + fraction[idx] * (x1 - x0);
+    }
+    output = result;
+  }
+
+public:
+  /**
+  `maxTimeSamples` is the maximum delay time in samples. Capacity of a lane becomes the
+  next power of 2 of `maxTimeSamples + 2`.
+  */
+  void setup(Sample maxTimeSamples)
+  {
+    maxTime = std::max(Sample(0), maxTimeSamples);
+
+    size_t capacity = 2;
+    while (capacity < size_t(maxTime) + 2) capacity *= 2;
+    mask = uint32_t(capacity - 1);
+
+    const size_t size = capacity * length;
+    arena.resize(size + alignment / sizeof(Sample));
+
+    void *ptr = arena.data();
+    size_t space = arena.size() * sizeof(Sample);
+    std::align(alignment, size * sizeof(Sample), ptr, space);
+    start = size_t(static_cast<Sample *>(ptr) - arena.data());
+
+    reset();
+  }
+
+  void reset()
+  {
+    std::fill(arena.begin(), arena.end(), Sample(0));
+    wptr = 0;
+  }
+
+  Sample getMaxTime() const { return maxTime; }
+
+  void write(const Frame &input)
+  {
+    Sample *buf = arena.data() + start + size_t(wptr) * length;
+    std::copy(input.begin(), input.end(), buf);
+    wptr = (wptr + 1) & mask;
+  }
+
+  // Overwrites `input` by output.
+  void process(Frame &input, const Frame &timeInSample)
+  {
+    computeIndex(0, timeInSample);
+    write(input);
+    gather(input);
+  }
+
+  // For block processing. Reads as if `offset` more frames are written.
+  void read(size_t offset, const Frame &timeInSample, Frame &output)
+  {
+    computeIndex(offset, timeInSample);
+    gather(output);
+  }
+};
+
+} // namespace SomeDSP
@@ -92,32 +92,58 @@ public:
   }
 };
 
+// Shared state of ExpSmoother, ParallelExpSmoother, LinearSmoother and RotarySmoother.
+template<typename Sample> struct SmootherState {
+  Sample sampleRate = Sample(44100);
+  Sample timeInSamples = Sample(0);
+  Sample kp = Sample(1);
+  Sample bufferSize = Sample(44100);
+};
+
+/**
+Smoothers read `SmootherState` bound to the current thread. Each DSPCore owns its own
+`SmootherState`, and binds it with `SmootherCommon::Scope` at the beginning of public
+methods. Therefore, instances running at different sampling rates or on different threads
+don't overwrite the state of each other.
+
+`defaultState` is used when nothing is bound.
+*/
 template<typename Sample> class SmootherCommon {
 public:
+  class Scope {
+  private:
+    SmootherState<Sample> *previous;
+
+  public:
+    Scope(SmootherState<Sample> &state) : previous(current) { current = &state; }
+    ~Scope() { current = previous; }
+
+    Scope(const Scope &) = delete;
+    Scope &operator=(const Scope &) = delete;
+  };
+
+  static inline SmootherState<Sample> &state() { return *current; }
+
   static void setSampleRate(Sample _sampleRate, Sample time = 0.04)
   {
-    sampleRate = _sampleRate;
+    current->sampleRate = _sampleRate;
     setTime(time);
   }
 
   static void setTime(Sample seconds)
   {
-    timeInSamples = seconds * sampleRate;
-    kp = Sample(EMAFilter<double>::cutoffToP(
-      sampleRate, std::clamp<double>(1.0 / seconds, 0.0, sampleRate / 2.0)));
+    auto &st = *current;
+    st.timeInSamples = seconds * st.sampleRate;
+    st.kp = Sample(EMAFilter<double>::cutoffToP(
+      st.sampleRate, std::clamp<double>(1.0 / seconds, 0.0, st.sampleRate / 2.0)));
   }
-  static void setBufferSize(Sample _bufferSize) { bufferSize = _bufferSize; }
 
-  static Sample sampleRate;
-  static Sample timeInSamples;
-  static Sample kp;
-  static Sample bufferSize;
-};
+  static void setBufferSize(Sample _bufferSize) { current->bufferSize = _bufferSize; }
 
-template<typename Sample> Sample SmootherCommon<Sample>::sampleRate = 44100.0;
-template<typename Sample> Sample SmootherCommon<Sample>::timeInSamples = 0.0;
-template<typename Sample> Sample SmootherCommon<Sample>::kp = 1.0;
-template<typename Sample> Sample SmootherCommon<Sample>::bufferSize = 44100.0;
+private:
+  static inline SmootherState<Sample> defaultState{};
+  static inline thread_local SmootherState<Sample> *current = &defaultState;
+};
 
 template<typename Sample> class ExpSmoother {
 public:
@@ -137,7 +163,56 @@ public:
   // Intended to be used after `push`.
   void catchUp() { value = target; }
 
-  Sample process() { return value += SmootherCommon<Sample>::kp * (target - value); }
+  Sample process()
+  {
+    return value += SmootherCommon<Sample>::state().kp * (target - value);
+  }
+
+  // Returns true when `value` is close enough to `target`, and snaps `value` to `target`.
+  bool isSettled()
+  {
+    const auto threshold = settleThreshold * std::max(Sample(1), std::fabs(target));
+    if (std::fabs(target - value) > threshold) return false;
+    value = target;
+    return true;
+  }
+
+  /**
+  Writes the next `length` outputs of `process()` to `dest`. Returns false if `value` is
+  already settled, and in that case `dest` is filled with `target`.
+
+  Output is computed in closed form, `target + (value - target) * (1 - kp)^n`. The powers
+  of `1 - kp` are prepared for `nLane` samples, so the inner loop has no dependency
+  between samples and can be vectorized.
+  */
+  bool processBlock(Sample *dest, size_t length)
+  {
+    if (isSettled()) {
+      std::fill(dest, dest + length, target);
+      return false;
+    }
+    if (length == 0) return true;
+
+    const auto decay = Sample(1) - SmootherCommon<Sample>::state().kp;
+    std::array<Sample, nLane> gain;
+    gain[0] = decay;
+    for (size_t j = 1; j < nLane; ++j) gain[j] = gain[j - 1] * decay;
+
+    auto diff = value - target;
+    size_t i = 0;
+    for (; i + nLane <= length; i += nLane) {
+      for (size_t j = 0; j < nLane; ++j) dest[i + j] = target + diff * gain[j];
+      diff *= gain[nLane - 1];
+    }
+    for (size_t j = 0; i + j < length; ++j) dest[i + j] = target + diff * gain[j];
+
+    value = dest[length - 1];
+    return true;
+  }
+
+private:
+  static constexpr size_t nLane = 16;
+  static constexpr Sample settleThreshold = Sample(1e-5);
 };
 
 template<typename Sample> class ExpSmootherLocal {
@@ -177,9 +252,8 @@ public:
 
   void process()
   {
-    for (size_t i = 0; i < length; ++i) {
-      value[i] += SmootherCommon<Sample>::kp * (target[i] - value[i]);
-    }
+    const auto kp = SmootherCommon<Sample>::state().kp;
+    for (size_t i = 0; i < length; ++i) value[i] += kp * (target[i] - value[i]);
   }
 };
 
@@ -209,11 +283,12 @@ public:
   void push(Sample newTarget)
   {
     target = newTarget;
-    if (Common::timeInSamples < Common::bufferSize) {
+    const auto &st = Common::state();
+    if (st.timeInSamples < st.bufferSize) {
       value = target;
       ramp = 0;
     } else {
-      ramp = (target - value) / Common::timeInSamples;
+      ramp = (target - value) / st.timeInSamples;
     }
   }
 
@@ -248,7 +323,7 @@ public:
   void push(Sample newTarget)
   {
     target = newTarget;
-    if (timeInSamples < Common::bufferSize) {
+    if (timeInSamples < Common::state().bufferSize) {
       value = target;
       ramp = 0;
     } else {
@@ -284,7 +359,8 @@ public:
   void push(Sample newTarget)
   {
     target = newTarget;
-    if (Common::timeInSamples < Common::bufferSize) {
+    const auto timeInSamples = Common::state().timeInSamples;
+    if (timeInSamples < Common::state().bufferSize) {
       value = target;
       return;
     }
@@ -294,17 +370,17 @@ public:
     if (dist1 < 0) {
       auto dist2 = target + max - value;
       if (std::fabs(dist1) > dist2) {
-        ramp = std::max(dist2 / Common::timeInSamples, max * eps);
+        ramp = std::max(dist2 / timeInSamples, max * eps);
         return;
       }
     } else {
       auto dist2 = target - max - value;
       if (dist1 > std::fabs(dist2)) {
-        ramp = std::min(dist2 / Common::timeInSamples, -max * eps);
+        ramp = std::min(dist2 / timeInSamples, -max * eps);
         return;
       }
     }
-    ramp = dist1 / Common::timeInSamples;
+    ramp = dist1 / timeInSamples;
   }
 
   Sample process()
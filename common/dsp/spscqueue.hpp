@@ -0,0 +1,66 @@
+// SPDX-License-Identifier: GPL-3.0-only
+// Copyright Takamitsu Endo (ryukau@gmail.com)
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+namespace SomeDSP {
+
+/**
+Lock-free single-producer single-consumer ring buffer.
+
+`push` is only called from the producer thread, and `pop` is only called from the consumer
+thread. Neither of them blocks or allocates. `push` drops the item when the queue is full,
+so a stalled consumer never slows down the producer, which is usually audio thread.
+
+`capacity` must be a power of 2. One slot is left empty to tell full from empty.
+*/
+template<typename T, size_t capacity> class SPSCQueue {
+private:
+  static_assert(
+    capacity >= 2 && (capacity & (capacity - 1)) == 0, "capacity must be power of 2.");
+
+  static constexpr size_t mask = capacity - 1;
+
+  // Separate cache lines to avoid false sharing between producer and consumer.
+  alignas(64) std::atomic<size_t> head{0}; // Written by consumer.
+  alignas(64) std::atomic<size_t> tail{0}; // Written by producer.
+  alignas(64) std::array<T, capacity> buffer{};
+
+public:
+  SPSCQueue() = default;
+  SPSCQueue(const SPSCQueue &) = delete;
+  SPSCQueue &operator=(const SPSCQueue &) = delete;
+
+  bool push(const T &item)
+  {
+    const auto wptr = tail.load(std::memory_order_relaxed);
+    const auto next = (wptr + 1) & mask;
+    if (next == head.load(std::memory_order_acquire)) return false;
+    buffer[wptr] = item;
+    tail.store(next, std::memory_order_release);
+    return true;
+  }
+
+  bool pop(T &item)
+  {
+    const auto rptr = head.load(std::memory_order_relaxed);
+    if (rptr == tail.load(std::memory_order_acquire)) return false;
+    item = buffer[rptr];
+    head.store((rptr + 1) & mask, std::memory_order_release);
+    return true;
+  }
+
+  // Consumer side. Discards all items.
+  void clear() { head.store(tail.load(std::memory_order_acquire)); }
+
+  bool empty() const
+  {
+    return head.load(std::memory_order_acquire) == tail.load(std::memory_order_acquire);
+  }
+};
+
+} // namespace SomeDSP
@@ -0,0 +1,419 @@
+// SPDX-License-Identifier: GPL-3.0-only
+// Copyright Takamitsu Endo (ryukau@gmail.com)
+
+#pragma once
+
+#include "cachedirectory.hpp"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#ifdef _WIN32
+  #ifndef NOMINMAX
+    #define NOMINMAX
+  #endif
+  #ifndef WIN32_LEAN_AND_MEAN
+    #define WIN32_LEAN_AND_MEAN
+  #endif
+  #include <windows.h>
+#else
+  #include <fcntl.h>
+  #include <sys/mman.h>
+  #include <sys/stat.h>
+  #include <unistd.h>
+#endif
+
+namespace SomeDSP {
+
+/**
+Float array of a wavetable. It either owns the memory, or views a part of memory which is
+kept alive by `mapping`. The viewed memory is a memory mapped file, or an arena shared by
+all tables of a set.
+
+Non-const accessors are only valid after `resize` or `view` with writable memory.
+Renderers always call one of them before writing.
+*/
+class TableBuffer {
+private:
+  std::vector<float> storage;
+  std::shared_ptr<const void> mapping;
+  const float *ptr = nullptr;
+  float *writable = nullptr;
+  size_t length = 0;
+
+public:
+  TableBuffer() = default;
+  TableBuffer(const TableBuffer &) = delete;
+  TableBuffer &operator=(const TableBuffer &) = delete;
+
+  void resize(size_t size)
+  {
+    mapping = nullptr;
+    storage.resize(size);
+    ptr = writable = storage.data();
+    length = size;
+  }
+
+  void map(std::shared_ptr<const void> owner, const float *data, size_t size)
+  {
+    std::vector<float>().swap(storage);
+    mapping = std::move(owner);
+    ptr = data;
+    writable = nullptr;
+    length = size;
+  }
+
+  void view(std::shared_ptr<const void> owner, float *data, size_t size)
+  {
+    map(std::move(owner), data, size);
+    writable = data;
+  }
+
+  bool empty() const { return length == 0; }
+  size_t size() const { return length; }
+
+  const float *data() const { return ptr; }
+  float *data() { return writable; }
+
+  const float &operator[](size_t index) const { return ptr[index]; }
+  float &operator[](size_t index) { return writable[index]; }
+};
+
+/**
+Serialized parameters of tables, used to key tables on disk. Values are added one by one,
+so the bytes don't depend on padding bytes of a struct. `hash` is FNV-1a of the bytes,
+and it names the file. The bytes themselves are stored in the file and compared on load.
+*/
+class TableKey {
+private:
+  std::vector<unsigned char> bytes;
+
+public:
+  template<typename T> TableKey &add(const T &x)
+  {
+    static_assert(std::is_arithmetic_v<T>, "T must be arithmetic.");
+    const auto size = bytes.size();
+    bytes.resize(size + sizeof(T));
+    std::memcpy(bytes.data() + size, &x, sizeof(T));
+    return *this;
+  }
+
+  template<typename T, size_t size> TableKey &add(const std::array<T, size> &x)
+  {
+    for (const auto &element : x) add(element);
+    return *this;
+  }
+
+  uint64_t hash() const
+  {
+    uint64_t value = 0xcbf29ce484222325;
+    for (const auto &byte : bytes) {
+      value ^= byte;
+      value *= 0x100000001b3;
+    }
+    return value;
+  }
+
+  const unsigned char *data() const { return bytes.data(); }
+  size_t size() const { return bytes.size(); }
+};
+
+// Read-only memory map of a whole file. Pages are shared between processes.
+class MappedFile {
+private:
+  const std::byte *address = nullptr;
+  size_t length = 0;
+
+  MappedFile(const std::byte *address, size_t length) : address(address), length(length)
+  {
+  }
+
+public:
+  MappedFile(const MappedFile &) = delete;
+  MappedFile &operator=(const MappedFile &) = delete;
+
+  ~MappedFile()
+  {
+#ifdef _WIN32
+    UnmapViewOfFile(address);
+#else
+    munmap(const_cast<std::byte *>(address), length);
+#endif
+  }
+
+  // Returns nullptr on failure.
+  static std::shared_ptr<const MappedFile> open(const fs::path &path)
+  {
+#ifdef _WIN32
+    HANDLE file = CreateFileW(
+      path.wstring().c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr,
+      OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) return nullptr;
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart <= 0) {
+      CloseHandle(file);
+      return nullptr;
+    }
+
+    // The view keeps the mapping and the file open after the handles are closed.
+    HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    CloseHandle(file);
+    if (mapping == nullptr) return nullptr;
+    void *view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(mapping);
+    if (view == nullptr) return nullptr;
+
+    return std::shared_ptr<const MappedFile>(
+      new MappedFile(static_cast<const std::byte *>(view), size_t(fileSize.QuadPart)));
+#else
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return nullptr;
+
+    struct stat status;
+    if (fstat(fd, &status) != 0 || status.st_size <= 0) {
+      ::close(fd);
+      return nullptr;
+    }
+
+    // The mapping stays valid after the file is closed.
+    const size_t fileSize = size_t(status.st_size);
+    void *view = mmap(nullptr, fileSize, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (view == MAP_FAILED) return nullptr;
+
+    return std::shared_ptr<const MappedFile>(
+      new MappedFile(static_cast<const std::byte *>(view), fileSize));
+#endif
+  }
+
+  const std::byte *data() const { return address; }
+  size_t size() const { return length; }
+};
+
+/**
+Stores finished table sets as files, and loads them by memory map.
+
+`Table` has `TableBuffer table` and `float tableBaseFreq`. A file is named by the hash of
+`TableKey`. File layout is following. Integers are in native byte order, so a file from a
+machine with different endian fails to load.
+
+```
+Header                  : 32 bytes.
+Bytes of `TableKey`     : Padded to 8 bytes.
+Entry[nTable]           : 24 bytes each.
+Float arrays of tables  : Each array starts at 64 bytes aligned offset.
+```
+
+A file is only accepted when the bytes of `TableKey` and the length of every table are
+exactly the same as the ones given to `load`. So a file of hash collision, or a file
+written by a build with different table length, is never mapped.
+
+`version` must be incremented when the layout or the table synthesis changes. Files of
+other version are overwritten. At most `maxFile` files are kept, and the least recently
+used ones are removed.
+*/
+template<typename Table, size_t nTable> class TableDiskCache {
+public:
+  using TableSet = std::array<std::shared_ptr<const Table>, nTable>;
+
+  using Lengths = std::array<uint64_t, nTable>; // Number of floats of each table.
+
+  static constexpr uint32_t version = 2;
+  static constexpr size_t maxFile = 16;
+
+private:
+  struct Header {
+    char magic[8];
+    uint32_t version;
+    uint32_t tableCount;
+    uint64_t hash;
+    uint64_t keySize; // In bytes.
+  };
+
+  struct Entry {
+    uint64_t offset;
+    uint64_t length; // Number of floats.
+    float tableBaseFreq;
+    uint32_t reserved;
+  };
+
+  static_assert(sizeof(Header) == 32 && sizeof(Entry) == 24);
+
+  static constexpr char magic[8] = {'U', 'h', 'h', 'y', 'o', 'u', 'T', 'b'};
+  static constexpr uint64_t alignment = 64;
+  static constexpr char extension[] = ".table";
+
+  fs::path directory;
+
+  static uint64_t alignUp(uint64_t offset, uint64_t align = alignment)
+  {
+    return (offset + align - 1) / align * align;
+  }
+
+  static uint64_t getEntryOffset(uint64_t keySize)
+  {
+    return sizeof(Header) + alignUp(keySize, 8);
+  }
+
+  fs::path getPath(const TableKey &key) const
+  {
+    char name[17];
+    std::snprintf(name, sizeof(name), "%016llx", (unsigned long long)key.hash());
+    return directory / (std::string(name) + extension);
+  }
+
+  // Removes least recently used files.
+  void prune() const
+  {
+    std::error_code ec;
+    std::vector<std::pair<fs::file_time_type, fs::path>> files;
+    for (const auto &entry : fs::directory_iterator(directory, ec)) {
+      if (entry.path().extension() != extension) continue;
+      files.emplace_back(fs::last_write_time(entry.path(), ec), entry.path());
+    }
+    if (files.size() <= maxFile) return;
+
+    std::sort(files.begin(), files.end());
+    for (size_t idx = 0; idx < files.size() - maxFile; ++idx) {
+      fs::remove(files[idx].second, ec);
+    }
+  }
+
+public:
+  // Empty path disables the cache.
+  void setDirectory(const fs::path &directory) { this->directory = directory; }
+  bool isEnabled() const { return !directory.empty(); }
+
+  /**
+  Returns nullptr when the file doesn't exist, is broken, or is made for other key or
+  table lengths. `lengths` is the number of floats that the reader of each table expects.
+  */
+  std::shared_ptr<const TableSet> load(const TableKey &key, const Lengths &lengths) const
+  {
+    const auto path = getPath(key);
+    auto file = MappedFile::open(path);
+    if (!file) return nullptr;
+
+    const auto fileSize = uint64_t(file->size());
+    const auto entryOffset = getEntryOffset(key.size());
+    if (fileSize < entryOffset + nTable * sizeof(Entry)) return nullptr;
+
+    Header header;
+    std::memcpy(&header, file->data(), sizeof(Header));
+    if (
+      std::memcmp(header.magic, magic, sizeof(magic)) != 0 || header.version != version
+      || header.tableCount != nTable || header.hash != key.hash()
+      || header.keySize != key.size()
+      || std::memcmp(file->data() + sizeof(Header), key.data(), key.size()) != 0)
+    {
+      return nullptr;
+    }
+
+    std::array<Entry, nTable> entries;
+    std::memcpy(entries.data(), file->data() + entryOffset, nTable * sizeof(Entry));
+    for (size_t idx = 0; idx < nTable; ++idx) {
+      const auto &entry = entries[idx];
+      if (
+        entry.length != lengths[idx] || entry.offset % alignment != 0
+        || entry.offset > fileSize
+        || entry.length > (fileSize - entry.offset) / sizeof(float))
+      {
+        return nullptr;
+      }
+    }
+
+    auto set = std::make_shared<TableSet>();
+    for (size_t idx = 0; idx < nTable; ++idx) {
+      auto table = std::make_shared<Table>();
+      table->tableBaseFreq = entries[idx].tableBaseFreq;
+      table->table.map(
+        file, reinterpret_cast<const float *>(file->data() + entries[idx].offset),
+        size_t(entries[idx].length));
+      (*set)[idx] = std::move(table);
+    }
+
+    // Touches each page here, so that audio thread doesn't wait for disk on first access.
+    volatile unsigned char sink = 0;
+    for (size_t i = 0; i < file->size(); i += 4096) {
+      sink = sink + static_cast<unsigned char>(file->data()[i]);
+    }
+
+    std::error_code ec;
+    fs::last_write_time(path, fs::file_time_type::clock::now(), ec);
+    return set;
+  }
+
+  // Writes to a temporary file, then renames it. Failures are ignored.
+  void store(const TableKey &key, const TableSet &set) const
+  {
+    const auto path = getPath(key);
+    auto tmpPath = path;
+    tmpPath += ".tmp"
+      + std::to_string(std::hash<std::thread::id>{}(std::this_thread::get_id()));
+
+    Header header;
+    std::memcpy(header.magic, magic, sizeof(magic));
+    header.version = version;
+    header.tableCount = uint32_t(nTable);
+    header.hash = key.hash();
+    header.keySize = key.size();
+
+    const auto entryOffset = getEntryOffset(key.size());
+    std::array<Entry, nTable> entries;
+    uint64_t offset = alignUp(entryOffset + nTable * sizeof(Entry));
+    for (size_t idx = 0; idx < nTable; ++idx) {
+      entries[idx].offset = offset;
+      entries[idx].length = set[idx]->table.size();
+      entries[idx].tableBaseFreq = set[idx]->tableBaseFreq;
+      entries[idx].reserved = 0;
+      offset = alignUp(offset + entries[idx].length * sizeof(float));
+    }
+
+    std::error_code ec;
+    {
+      fs::ofstream ofs(tmpPath, std::ios::binary);
+      const std::array<char, alignment> zeros{};
+      ofs.write(reinterpret_cast<const char *>(&header), sizeof(Header));
+      ofs.write(reinterpret_cast<const char *>(key.data()), std::streamsize(key.size()));
+      ofs.write(zeros.data(), std::streamsize(entryOffset - sizeof(Header) - key.size()));
+      ofs.write(reinterpret_cast<const char *>(entries.data()), nTable * sizeof(Entry));
+
+      uint64_t position = entryOffset + nTable * sizeof(Entry);
+      for (size_t idx = 0; idx < nTable; ++idx) {
+        ofs.write(zeros.data(), std::streamsize(entries[idx].offset - position));
+        const auto bytes = entries[idx].length * sizeof(float);
+        ofs.write(
+          reinterpret_cast<const char *>(set[idx]->table.data()), std::streamsize(bytes));
+        position = entries[idx].offset + bytes;
+      }
+
+      if (!ofs.good()) {
+        ofs.close();
+        fs::remove(tmpPath, ec);
+        return;
+      }
+    }
+
+    fs::rename(tmpPath, path, ec);
+    if (ec) fs::remove(tmpPath, ec);
+
+    prune();
+  }
+};
+
+} // namespace SomeDSP
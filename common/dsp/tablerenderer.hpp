@@ -0,0 +1,448 @@
+// SPDX-License-Identifier: GPL-3.0-only
+// Copyright Takamitsu Endo (ryukau@gmail.com)
+
+#pragma once
+
+#include "spscqueue.hpp"
+#include "tablediskcache.hpp"
+#include "workerpool.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace SomeDSP {
+
+/**
+Renders `nTable` tables on worker threads, and publishes each table to audio thread as
+soon as it is finished. Used for PADsynth tables, which are rendered per MIDI note.
+
+`Renderer` provides following:
+
+- `Renderer::Request`: Parameters of tables. Must be copyable and comparable by `==`.
+  `TableKey Request::key() const` serializes all parameters for disk cache.
+- `Renderer::Table`: A table. It has `TableBuffer table` and `float tableBaseFreq`.
+- `Renderer::Scratch`: Buffers used by one worker during a job. Must be default
+  constructible.
+- `void prepare(const Request &, Scratch &)`: Called once for each request before
+  rendering. Other workers are idle during the call.
+- `void render(size_t index, Table &, Scratch &) const`: Renders `index`-th table. Called
+  concurrently from all workers, each with its own `Scratch`.
+- `static size_t tableLength(const Request &, size_t index)`: Number of floats of
+  `index`-th table. A file on disk is rejected unless all tables have this length.
+
+The tables are independent once `prepare` is done, so they are spread over up to
+`nWorker` workers. One of them is the thread of this instance that receives requests, and
+the rest are helpers borrowed from process-wide `WorkerPool`. Each worker makes its
+`Scratch` at the start of a job and frees it at the end, so idle instances hold no
+scratch.
+
+A finished table is immutable, and owned by `std::shared_ptr`. A replaced table is
+released only after audio thread has left the block in which it might have read the
+table. Audio thread calls `lock` at the start of a block and `unlock` at the end, and
+worker waits while the block that was running at the swap is not finished. Audio thread
+only sees raw pointers, so nothing is freed on audio thread.
+
+Finished table sets are shared between all `TableRenderer` of the same type in a process.
+When a request is same as a set held by other instance, the set is used without
+rendering. A set is evicted when the last instance releases it.
+
+Optionally, table sets are also stored on disk by `TableDiskCache`, and memory mapped on
+load. Storing is done by the worker after the tables are published.
+
+`reset` renders on the calling thread and helpers, and (re)starts the worker. It must not
+be called while audio thread is processing.
+*/
+template<typename Renderer, size_t nTable> class TableRenderer {
+public:
+  using Request = typename Renderer::Request;
+  using Table = typename Renderer::Table;
+  using Scratch = typename Renderer::Scratch;
+  using DiskCache = TableDiskCache<Table, nTable>;
+  using TableSet = typename DiskCache::TableSet;
+
+private:
+  /**
+  Process-wide table sets. Only a few settings are alive at once, so entries are searched
+  linearly by `Request::operator==`. Expired entries are removed on each access.
+  */
+  class Cache {
+  private:
+    std::mutex mutex;
+    std::vector<std::pair<Request, std::weak_ptr<const TableSet>>> entries;
+
+    void evict()
+    {
+      std::erase_if(entries, [](const auto &entry) { return entry.second.expired(); });
+    }
+
+  public:
+    std::shared_ptr<const TableSet> find(const Request &request)
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      evict();
+      for (const auto &entry : entries) {
+        if (entry.first == request) return entry.second.lock();
+      }
+      return nullptr;
+    }
+
+    // Returns the set already in cache when there is one. Otherwise `set` is added.
+    std::shared_ptr<const TableSet>
+    insert(const Request &request, std::shared_ptr<const TableSet> set)
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      evict();
+      for (const auto &entry : entries) {
+        if (!(entry.first == request)) continue;
+        auto cached = entry.second.lock();
+        if (cached) return cached;
+      }
+      entries.emplace_back(request, set);
+      return set;
+    }
+  };
+
+  static Cache &cache()
+  {
+    static Cache instance;
+    return instance;
+  }
+
+  Renderer renderer;
+  DiskCache diskCache;
+  std::array<std::atomic<const Table *>, nTable> published{};
+
+  // Incremented on `lock` and `unlock`. Odd value means audio thread is in a block.
+  std::atomic<uint32_t> epoch{0};
+  std::atomic<uint32_t> nFinished{0};
+  std::atomic<uint32_t> nCompletedRequest{0};
+
+  SPSCQueue<Request, 4> requests;
+  std::atomic<uint32_t> wakeCounter{0};
+  std::atomic<bool> isRunning{false};
+  std::thread worker;
+
+  // A job is to render all tables. Helpers run `work` as tasks of `helperJob`.
+  struct HelperJob : public WorkerPool::Job {
+    TableRenderer *owner = nullptr;
+
+    void run() override
+    {
+      if (!owner->hasWork()) return;
+      Scratch scratch;
+      owner->work(scratch, nullptr);
+    }
+  };
+
+  size_t nHelper = 0; // Max number of helpers.
+  std::shared_ptr<WorkerPool> pool;
+  HelperJob helperJob;
+  std::atomic<size_t> nextIndex{nTable};
+  std::atomic<bool> isCancelled{false};
+
+  // Only touched by workers, or by `reset` while worker is stopped. During a job, each
+  // element of `owned` is only touched by the worker rendering the index.
+  TableSet owned;
+  std::shared_ptr<const TableSet> current; // Keeps the cache entry alive.
+  std::shared_ptr<const TableSet> unsaved; // Waiting to be stored on disk.
+  TableKey unsavedKey;
+  Request rendered{};
+  bool isRendered = false;
+  uint32_t nAcceptedRequest = 0;
+
+  // Only touched by audio thread.
+  std::array<const Table *, nTable> snapshot{};
+  Request latest{};
+  Request pending{};
+  bool isPending = false;
+  uint32_t nSentRequest = 0;
+
+  void wake()
+  {
+    wakeCounter.fetch_add(1, std::memory_order_release);
+    wakeCounter.notify_one();
+  }
+
+  void flushRequest()
+  {
+    if (!isPending || !requests.push(pending)) return;
+    isPending = false;
+    ++nSentRequest;
+    wake();
+  }
+
+  // Pops all requests. Only the newest one is kept in `rq`.
+  bool fetch(Request &rq)
+  {
+    bool hasRequest = false;
+    while (requests.pop(rq)) {
+      hasRequest = true;
+      ++nAcceptedRequest;
+    }
+    return hasRequest;
+  }
+
+  // Waits for the block that might be reading a table replaced before this call.
+  void synchronize()
+  {
+    const auto current = epoch.load(std::memory_order_seq_cst);
+    if ((current & 1) == 0) return;
+    while (
+      epoch.load(std::memory_order_acquire) == current
+      && isRunning.load(std::memory_order_acquire))
+    {
+      std::this_thread::sleep_for(std::chrono::microseconds(200));
+    }
+  }
+
+  /**
+  Renders tables of current job until all indices are taken. Called from all workers.
+
+  `newer` is only given on worker 0 while the worker is running. The job is cancelled when
+  a newer request arrives, and the request is stored in `newer`.
+  */
+  void work(Scratch &scratch, Request *newer)
+  {
+    while (!isCancelled.load(std::memory_order_acquire)) {
+      if (
+        newer != nullptr
+        && (!isRunning.load(std::memory_order_acquire) || fetch(*newer)))
+      {
+        isCancelled.store(true, std::memory_order_release);
+        break;
+      }
+
+      const auto idx = nextIndex.fetch_add(1, std::memory_order_relaxed);
+      if (idx >= nTable) break;
+
+      auto table = std::make_shared<Table>();
+      renderer.render(idx, *table, scratch);
+      published[idx].exchange(table.get(), std::memory_order_seq_cst);
+      synchronize();
+      owned[idx] = std::move(table);
+      nFinished.fetch_add(1, std::memory_order_release);
+    }
+  }
+
+  bool hasWork() const
+  {
+    return !isCancelled.load(std::memory_order_acquire)
+      && nextIndex.load(std::memory_order_relaxed) < nTable;
+  }
+
+  /**
+  Renders all tables with this thread and helpers. Returns false when the job is
+  cancelled. Helpers that haven't started when this thread runs out of tables are removed
+  from the pool, and running ones are waited.
+  */
+  bool renderAll(Scratch &scratch, Request *newer)
+  {
+    nextIndex.store(0, std::memory_order_relaxed);
+    isCancelled.store(false, std::memory_order_relaxed);
+    if (pool) pool->post(helperJob, uint32_t(nHelper));
+
+    work(scratch, newer);
+
+    if (pool) pool->cancel(helperJob);
+    return !isCancelled.load(std::memory_order_acquire);
+  }
+
+  // Publishes all tables in `set`, and releases the replaced ones.
+  void adopt(std::shared_ptr<const TableSet> set)
+  {
+    for (size_t idx = 0; idx < nTable; ++idx) {
+      published[idx].exchange((*set)[idx].get(), std::memory_order_seq_cst);
+    }
+    synchronize();
+    owned = *set;
+    current = std::move(set);
+  }
+
+  /**
+  Takes tables for `rq` from cache, or renders them. Returns false when cancelled by a
+  newer request, which is stored in `rq`. Cancellation only happens when `isAsync`.
+  */
+  bool load(Request &rq, bool isAsync)
+  {
+    current = nullptr;
+    nFinished.store(0, std::memory_order_release);
+
+    auto cached = cache().find(rq);
+    if (!cached && diskCache.isEnabled()) {
+      typename DiskCache::Lengths lengths;
+      for (size_t idx = 0; idx < nTable; ++idx) {
+        lengths[idx] = Renderer::tableLength(rq, idx);
+      }
+      cached = diskCache.load(rq.key(), lengths);
+      if (cached) cached = cache().insert(rq, std::move(cached));
+    }
+    if (!cached) {
+      Scratch scratch;
+      renderer.prepare(rq, scratch);
+      if (!renderAll(scratch, isAsync ? &rq : nullptr)) return false;
+
+      // Other instance may have finished the same request while rendering.
+      auto set = std::make_shared<const TableSet>(owned);
+      cached = cache().insert(rq, set);
+      if (cached == set) {
+        if (diskCache.isEnabled()) {
+          unsaved = set;
+          unsavedKey = rq.key();
+        }
+        current = std::move(set);
+        return true;
+      }
+    }
+
+    adopt(std::move(cached));
+    nFinished.store(uint32_t(nTable), std::memory_order_release);
+    return true;
+  }
+
+  // Returns false when nothing is stored.
+  bool store()
+  {
+    if (!unsaved) return false;
+    diskCache.store(unsavedKey, *unsaved);
+    unsaved = nullptr;
+    return true;
+  }
+
+  void run()
+  {
+    Request rq{};
+    bool hasRequest = false;
+    while (isRunning.load(std::memory_order_acquire)) {
+      const auto seen = wakeCounter.load(std::memory_order_acquire);
+
+      if (!hasRequest && !fetch(rq)) {
+        if (store()) continue;
+        wakeCounter.wait(seen, std::memory_order_acquire);
+        continue;
+      }
+      hasRequest = false;
+
+      isRendered = false;
+      if (!load(rq, true)) {
+        hasRequest = true;
+        continue;
+      }
+
+      rendered = rq;
+      isRendered = true;
+      nCompletedRequest.store(nAcceptedRequest, std::memory_order_release);
+    }
+  }
+
+  void stop()
+  {
+    if (!worker.joinable()) return;
+    isRunning.store(false, std::memory_order_release);
+    wake();
+    worker.join();
+  }
+
+public:
+  TableRenderer(size_t nWorker = 1) : nHelper(nWorker > 1 ? nWorker - 1 : 0)
+  {
+    helperJob.owner = this;
+    for (size_t idx = 0; idx < nTable; ++idx) {
+      owned[idx] = std::make_shared<const Table>();
+      published[idx].store(owned[idx].get(), std::memory_order_relaxed);
+      snapshot[idx] = owned[idx].get();
+    }
+  }
+
+  TableRenderer(const TableRenderer &) = delete;
+  TableRenderer &operator=(const TableRenderer &) = delete;
+
+  ~TableRenderer() { stop(); }
+
+  // Must be called before `reset`. Empty path disables disk cache.
+  void setDiskCacheDirectory(const fs::path &directory)
+  {
+    diskCache.setDirectory(directory);
+  }
+
+  // Tables are not rendered again when `request` is same as the last finished one.
+  void reset(const Request &request)
+  {
+    stop();
+    if (nHelper > 0 && !pool) {
+      pool = WorkerPool::acquire();
+      nHelper = std::min(nHelper, pool->getThreadCount());
+    }
+
+    Request discard{};
+    while (requests.pop(discard)) continue;
+    isPending = false;
+    nSentRequest = 0;
+    nAcceptedRequest = 0;
+    nCompletedRequest.store(0, std::memory_order_release);
+
+    if (!isRendered || !(rendered == request)) {
+      Request rq = request;
+      load(rq, false);
+      rendered = request;
+      isRendered = true;
+    }
+    latest = request;
+    nFinished.store(uint32_t(nTable), std::memory_order_release);
+    for (size_t idx = 0; idx < nTable; ++idx) {
+      snapshot[idx] = published[idx].load(std::memory_order_relaxed);
+    }
+
+    isRunning.store(true, std::memory_order_release);
+    worker = std::thread(&TableRenderer::run, this);
+  }
+
+  // Audio thread. Same request as the last one is ignored.
+  void request(const Request &request)
+  {
+    if (!(latest == request)) {
+      latest = request;
+      pending = request;
+      isPending = true;
+    }
+    flushRequest();
+  }
+
+  // Audio thread. Called at the start of a block, before `get`.
+  void lock()
+  {
+    epoch.fetch_add(1, std::memory_order_seq_cst);
+    for (size_t idx = 0; idx < nTable; ++idx) {
+      snapshot[idx] = published[idx].load(std::memory_order_seq_cst);
+    }
+    flushRequest();
+  }
+
+  // Audio thread. Called at the end of a block. Tables must not be read after this call.
+  void unlock() { epoch.fetch_add(1, std::memory_order_release); }
+
+  const Table &get(size_t index) const { return *snapshot[index]; }
+
+  // Audio thread. True while tables for the latest request are not finished.
+  bool isRendering() const
+  {
+    return isPending
+      || nCompletedRequest.load(std::memory_order_acquire) != nSentRequest;
+  }
+
+  // Audio thread. Ratio of finished tables for the latest request, in [0, 1].
+  float getProgress() const
+  {
+    if (!isRendering()) return float(1);
+    const auto finished = nFinished.load(std::memory_order_acquire);
+    return finished >= nTable ? float(0) : float(finished) / float(nTable);
+  }
+};
+
+} // namespace SomeDSP
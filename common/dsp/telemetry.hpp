@@ -0,0 +1,95 @@
+// SPDX-License-Identifier: GPL-3.0-only
+// Copyright Takamitsu Endo (ryukau@gmail.com)
+
+#pragma once
+
+#include "spscqueue.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <memory>
+
+namespace SomeDSP {
+
+struct TelemetryFrame {
+  static constexpr size_t nWaveform = 64;
+
+  std::array<float, 2> peak{};
+  std::array<float, 2> rms{};
+  float gainReduction = 1; // Minimum gain in amplitude. 1 means no reduction.
+
+  // Sample with largest magnitude in each of `nWaveform` segments of the frame.
+  std::array<float, nWaveform> waveform{};
+};
+
+using TelemetryQueue = SPSCQueue<TelemetryFrame, 64>;
+
+/**
+Decimates audio into `TelemetryFrame` at `framesPerSecond`, and pushes them into `queue`.
+`queue` is shared with the editor, so it may outlive the meter.
+
+`process` is called for each sample on audio thread. It only does a few comparisons and
+additions per sample, and a `queue.push` per frame.
+*/
+class TelemetryMeter {
+private:
+  TelemetryFrame current;
+  std::array<double, 2> sumSquare{};
+  size_t frameLength = 735;
+  size_t segmentLength = 12;
+  size_t counter = 0;
+  size_t segment = 0;
+  size_t segmentCounter = 0;
+
+public:
+  const std::shared_ptr<TelemetryQueue> queue = std::make_shared<TelemetryQueue>();
+
+  void setup(double sampleRate, double framesPerSecond = 60)
+  {
+    segmentLength = std::max(
+      size_t(1),
+      size_t(sampleRate / (framesPerSecond * double(TelemetryFrame::nWaveform))));
+    frameLength = segmentLength * TelemetryFrame::nWaveform;
+    reset();
+  }
+
+  void reset()
+  {
+    current = TelemetryFrame{};
+    sumSquare.fill(0);
+    counter = 0;
+    segment = 0;
+    segmentCounter = 0;
+  }
+
+  void process(float ch0, float ch1, float gain = 1)
+  {
+    const float abs0 = std::fabs(ch0);
+    const float abs1 = std::fabs(ch1);
+    current.peak[0] = std::max(current.peak[0], abs0);
+    current.peak[1] = std::max(current.peak[1], abs1);
+    sumSquare[0] += double(ch0) * double(ch0);
+    sumSquare[1] += double(ch1) * double(ch1);
+    current.gainReduction = std::min(current.gainReduction, gain);
+
+    const float mid = float(0.5) * (ch0 + ch1);
+    auto &wave = current.waveform[segment];
+    if (std::fabs(mid) > std::fabs(wave)) wave = mid;
+
+    if (++segmentCounter >= segmentLength) {
+      segmentCounter = 0;
+      if (segment + 1 < TelemetryFrame::nWaveform) ++segment;
+    }
+
+    if (++counter < frameLength) return;
+
+    for (size_t ch = 0; ch < sumSquare.size(); ++ch)
+      current.rms[ch] = float(std::sqrt(sumSquare[ch] / double(counter)));
+    queue->push(current);
+    reset();
+  }
+};
+
+} // namespace SomeDSP
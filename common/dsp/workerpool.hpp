@@ -0,0 +1,213 @@
+// SPDX-License-Identifier: GPL-3.0-only
+// Copyright Takamitsu Endo (ryukau@gmail.com)
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace SomeDSP {
+
+/**
+Worker threads shared by all plugin instances in a process.
+
+`acquire` returns the pool, and starts it on first call. The number of threads is fixed
+to the number of cores except one for audio thread, and at least 1. The pool is stopped
+when the last owner releases it, so threads are never joined while the module is
+unloaded.
+
+A `Job` is posted with a number of tasks, and each task calls `Job::run` once on one of
+the threads. Tasks of the same job may run concurrently. Queued jobs are taken in round
+robin, one task at a time. `cancel` removes queued tasks of a job, and waits until
+running ones return. A job must be cancelled before it's destroyed.
+
+`tryPost` doesn't block nor allocate, so it can be called from audio thread. It fails when
+other thread holds the queue, or the queue is full. A job posted by `tryPost` must be
+done by the caller when it's not picked up by the deadline.
+*/
+class WorkerPool {
+public:
+  class Job {
+  private:
+    friend class WorkerPool;
+
+    // `nQueued` is protected by `WorkerPool::mutex`.
+    uint32_t nQueued = 0;
+    std::atomic<uint32_t> nRunning{0};
+
+  public:
+    virtual ~Job() = default;
+    virtual void run() = 0;
+  };
+
+private:
+  static constexpr size_t capacity = 256; // Max number of queued jobs.
+
+  std::mutex mutex;
+  std::array<Job *, capacity> queue{};
+  size_t head = 0;
+  size_t size = 0;
+
+  std::atomic<uint32_t> wakeCounter{0};
+  std::atomic<uint32_t> doneCounter{0}; // Job may be freed after `nRunning` reaches 0.
+  std::atomic<bool> isRunning{true};
+  std::vector<std::thread> threads;
+
+  static size_t nThread()
+  {
+    static const size_t count = [] {
+      const size_t nCore = std::thread::hardware_concurrency(); // 0 when unknown.
+      return nCore > 1 ? nCore - 1 : size_t(1);
+    }();
+    return count;
+  }
+
+  // Must be called while `mutex` is held.
+  bool push(Job &job, uint32_t nTask)
+  {
+    if (job.nQueued == 0) {
+      if (size >= capacity) return false;
+      queue[(head + size) % capacity] = &job;
+      ++size;
+    }
+    job.nQueued += nTask;
+    return true;
+  }
+
+  // Must be called while `mutex` is held. A job with tasks left goes back to the end.
+  Job *pop()
+  {
+    if (size == 0) return nullptr;
+    auto job = queue[head];
+    head = (head + 1) % capacity;
+    --size;
+    if (--job->nQueued > 0) {
+      queue[(head + size) % capacity] = job;
+      ++size;
+    }
+    job->nRunning.fetch_add(1, std::memory_order_relaxed);
+    return job;
+  }
+
+  void wake(uint32_t nTask)
+  {
+    wakeCounter.fetch_add(1, std::memory_order_release);
+    if (nTask > 1) {
+      wakeCounter.notify_all();
+    } else {
+      wakeCounter.notify_one();
+    }
+  }
+
+  void runThread()
+  {
+    while (true) {
+      const auto seen = wakeCounter.load(std::memory_order_acquire);
+
+      Job *job = nullptr;
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        job = pop();
+      }
+      if (job == nullptr) {
+        if (!isRunning.load(std::memory_order_acquire)) return;
+        wakeCounter.wait(seen, std::memory_order_acquire);
+        continue;
+      }
+
+      job->run();
+      job->nRunning.fetch_sub(1, std::memory_order_seq_cst);
+      doneCounter.fetch_add(1, std::memory_order_seq_cst);
+      doneCounter.notify_all();
+    }
+  }
+
+public:
+  WorkerPool()
+  {
+    for (size_t idx = 0; idx < nThread(); ++idx) {
+      threads.emplace_back(&WorkerPool::runThread, this);
+    }
+  }
+
+  WorkerPool(const WorkerPool &) = delete;
+  WorkerPool &operator=(const WorkerPool &) = delete;
+
+  ~WorkerPool()
+  {
+    isRunning.store(false, std::memory_order_release);
+    wake(uint32_t(threads.size()));
+    for (auto &thread : threads) thread.join();
+  }
+
+  static std::shared_ptr<WorkerPool> acquire()
+  {
+    static std::mutex acquireMutex;
+    static std::weak_ptr<WorkerPool> shared;
+
+    std::lock_guard<std::mutex> lock(acquireMutex);
+    auto pool = shared.lock();
+    if (!pool) {
+      pool = std::make_shared<WorkerPool>();
+      shared = pool;
+    }
+    return pool;
+  }
+
+  size_t getThreadCount() const { return threads.size(); }
+
+  // Returns false when the queue is full.
+  bool post(Job &job, uint32_t nTask = 1)
+  {
+    if (nTask == 0) return true;
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      if (!push(job, nTask)) return false;
+    }
+    wake(nTask);
+    return true;
+  }
+
+  // Audio thread. Returns false without waiting when the queue is busy or full.
+  bool tryPost(Job &job, uint32_t nTask = 1)
+  {
+    if (nTask == 0) return true;
+    {
+      std::unique_lock<std::mutex> lock(mutex, std::try_to_lock);
+      if (!lock.owns_lock() || !push(job, nTask)) return false;
+    }
+    wake(nTask);
+    return true;
+  }
+
+  // Removes queued tasks of `job`, and waits until its running tasks return.
+  void cancel(Job &job)
+  {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      if (job.nQueued > 0) {
+        size_t kept = 0;
+        for (size_t idx = 0; idx < size; ++idx) {
+          auto queued = queue[(head + idx) % capacity];
+          if (queued != &job) queue[(head + kept++) % capacity] = queued;
+        }
+        size = kept;
+        job.nQueued = 0;
+      }
+    }
+
+    while (true) {
+      const auto seen = doneCounter.load(std::memory_order_seq_cst);
+      if (job.nRunning.load(std::memory_order_seq_cst) == 0) return;
+      doneCounter.wait(seen, std::memory_order_seq_cst);
+    }
+  }
+};
+
+} // namespace SomeDSP
@@ -8,6 +8,7 @@
 #include "public.sdk/source/vst/vstguieditor.h"
 #include "vstgui/lib/platform/iplatformframecallback.h"
 
+#include "../dsp/telemetry.hpp"
 #include "../parameterInterface.hpp"
 #include "arraycontrol.hpp"
 #include "style.hpp"
@@ -75,6 +76,7 @@ public:
 
   void PLUGIN_API close() override
   {
+    if (telemetry != nullptr) telemetry->clear();
     if (frame != nullptr) {
       frame->unregisterMouseObserver(this);
       frame->forget();
@@ -113,6 +115,30 @@ public:
     }
   }
 
+  /**
+  Called from controller when processor hands over or withdraws the queue. Frames are
+  polled on the idle timer set by `setIdleRate`, and passed to `onTelemetry` on GUI thread.
+  */
+  void setTelemetry(std::shared_ptr<SomeDSP::TelemetryQueue> queue)
+  {
+    telemetry = std::move(queue);
+    if (telemetry != nullptr) telemetry->clear();
+  }
+
+  CMessageResult notify(CBaseObject *sender, const char *message) override
+  {
+    auto result = VSTGUIEditor::notify(sender, message);
+    if (message != CVSTGUITimer::kMsgTimer || telemetry == nullptr || frame == nullptr)
+      return result;
+
+    SomeDSP::TelemetryFrame telemetryFrame;
+    while (telemetry->pop(telemetryFrame)) onTelemetry(telemetryFrame);
+    return result;
+  }
+
+  // Override to update meters or scopes. Frames arrive in the order of processing.
+  virtual void onTelemetry(const SomeDSP::TelemetryFrame &telemetryFrame) {}
+
   virtual void onMouseEntered(CView *view, CFrame *frame) override {}
   virtual void onMouseExited(CView *view, CFrame *frame) override {}
 
@@ -755,6 +781,7 @@ protected:
   virtual bool prepareUI() = 0;
 
   std::unique_ptr<ParameterInterface> param;
+  std::shared_ptr<SomeDSP::TelemetryQueue> telemetry;
 
   std::unordered_map<Vst::ParamID, SharedPointer<CControl>> controlMap;
   std::unordered_map<Vst::ParamID, SharedPointer<ArrayControl>> arrayControlMap;
@@ -0,0 +1,135 @@
+// SPDX-License-Identifier: GPL-3.0-only
+// Copyright Takamitsu Endo (ryukau@gmail.com)
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Steinberg {
+
+/**
+Structure of arrays copy of `GlobalParameter::value`.
+
+`ValueInterface` attached by `attach()` writes its raw and normalized value here on every
+change, and marks the index as dirty. The scale mapping is done in the typed setter of
+`UIntValue` or `DoubleValue<Scale>`, so reading from DSP is a plain array access without
+virtual call.
+
+Values may be written from UI thread by `setState()` while DSP is running. A writer stores
+the value first, then publishes the dirty bit with release order. DSP calls `fetchDirty()`
+at the start of `setParameters()`, which takes a snapshot of the bits and clears them in
+one atomic exchange per word. `isDirty()` only reads the snapshot, so a bit set during
+`setParameters()` is kept for the next call instead of being lost.
+*/
+class ParameterStore {
+private:
+  static constexpr size_t wordBits = 64;
+
+  std::vector<std::atomic<double>> raw;
+  std::vector<std::atomic<double>> normalized;
+  std::vector<std::atomic<uint64_t>> pending; // Set by writers, taken by `fetchDirty()`.
+  std::vector<uint64_t> dirty;                // Snapshot. Only accessed from DSP.
+
+  inline uint64_t wordMask(size_t word) const
+  {
+    const size_t rest = raw.size() % wordBits;
+    if (word + 1 < dirty.size() || rest == 0) return ~uint64_t(0);
+    return (uint64_t(1) << rest) - 1;
+  }
+
+public:
+  ParameterStore() = default;
+
+  // `ValueInterface` holds a pointer to the store.
+  ParameterStore(const ParameterStore &) = delete;
+  ParameterStore &operator=(const ParameterStore &) = delete;
+
+  template<typename Values> void attach(Values &values)
+  {
+    const size_t nWord = (values.size() + wordBits - 1) / wordBits;
+    raw = std::vector<std::atomic<double>>(values.size());
+    normalized = std::vector<std::atomic<double>>(values.size());
+    pending = std::vector<std::atomic<uint64_t>>(nWord);
+    dirty.assign(nWord, 0);
+    for (size_t index = 0; index < values.size(); ++index)
+      values[index]->attach(*this, index);
+    markAllDirty();
+  }
+
+  inline size_t size() const { return raw.size(); }
+
+  inline void set(size_t index, double rawValue, double normalizedValue)
+  {
+    normalized[index].store(normalizedValue, std::memory_order_relaxed);
+    if (raw[index].load(std::memory_order_relaxed) == rawValue) return;
+    raw[index].store(rawValue, std::memory_order_relaxed);
+    pending[index / wordBits].fetch_or(
+      uint64_t(1) << (index % wordBits), std::memory_order_release);
+  }
+
+  inline double getDouble(size_t index) const
+  {
+    return raw[index].load(std::memory_order_relaxed);
+  }
+  inline float getFloat(size_t index) const { return float(getDouble(index)); }
+  inline uint32_t getInt(size_t index) const { return uint32_t(getDouble(index)); }
+
+  inline double getNormalized(size_t index) const
+  {
+    return normalized[index].load(std::memory_order_relaxed);
+  }
+
+  // Takes the changes since last call. Call from DSP at the start of `setParameters()`.
+  void fetchDirty()
+  {
+    for (size_t word = 0; word < dirty.size(); ++word)
+      dirty[word] = pending[word].exchange(0, std::memory_order_acquire);
+  }
+
+  inline bool isDirty(size_t index) const
+  {
+    return dirty[index / wordBits] & (uint64_t(1) << (index % wordBits));
+  }
+
+  // Returns true if any of parameters in [first, last) is changed.
+  bool isDirty(size_t first, size_t last) const
+  {
+    for (size_t index = first; index < last;) {
+      const size_t word = index / wordBits;
+      const size_t bit = index % wordBits;
+      if (bit == 0 && index + wordBits <= last) {
+        if (dirty[word]) return true;
+        index += wordBits;
+      } else {
+        if (isDirty(index)) return true;
+        ++index;
+      }
+    }
+    return false;
+  }
+
+  bool isAnyDirty() const
+  {
+    for (const auto &word : dirty)
+      if (word) return true;
+    return false;
+  }
+
+  /**
+  Marks all parameters as changed, in both of the snapshot and the next `fetchDirty()`.
+  For `reset()` of DSP, which may set some states only in `setParameters()`.
+  */
+  void markAllDirty()
+  {
+    for (size_t word = 0; word < dirty.size(); ++word) {
+      const auto mask = wordMask(word);
+      pending[word].fetch_or(mask, std::memory_order_release);
+      dirty[word] = mask;
+    }
+  }
+};
+
+} // namespace Steinberg
@@ -17,6 +17,8 @@
 #include "public.sdk/source/vst/vsteditcontroller.h"
 #include "public.sdk/source/vst/vstparameters.h"
 
+#include "telemetrylink.hpp"
+
 #include <algorithm>
 #include <vector>
 
@@ -28,6 +30,7 @@ class PlugController : public Vst::EditController,
                        public Vst::INoteExpressionController {
 public:
   std::vector<EditorType *> editor;
+  std::shared_ptr<SomeDSP::TelemetryQueue> telemetry;
 
   virtual ~PlugController()
   {
@@ -45,6 +48,7 @@ public:
   void editorDestroyed(Vst::EditorView *editorView) SMTG_OVERRIDE;
   tresult PLUGIN_API setParamNormalized(Vst::ParamID id, Vst::ParamValue normalized)
     SMTG_OVERRIDE;
+  tresult PLUGIN_API notify(Vst::IMessage *message) SMTG_OVERRIDE;
 
   tresult PLUGIN_API getMidiControllerAssignment(
     int32 busIndex, int16 channel, Vst::CtrlNumber midiControllerNumber, Vst::ParamID &id)
@@ -109,6 +113,7 @@ PlugController<EditorType, ParameterType>::createView(const char *name)
   if (name && strcmp(name, "editor") == 0) {
     auto plugEditor = new EditorType(this);
     plugEditor->remember();
+    plugEditor->setTelemetry(telemetry);
     editor.push_back(plugEditor);
     return plugEditor;
   }
@@ -138,4 +143,13 @@ tresult PLUGIN_API PlugController<EditorType, ParameterType>::setParamNormalized
   return kResultFalse;
 }
 
+template<typename EditorType, typename ParameterType>
+tresult PLUGIN_API
+PlugController<EditorType, ParameterType>::notify(Vst::IMessage *message)
+{
+  if (!TelemetryLink::receive(message, telemetry)) return EditController::notify(message);
+  for (auto &edi : editor) edi->setTelemetry(telemetry);
+  return kResultOk;
+}
+
 } // namespace Steinberg::Synth
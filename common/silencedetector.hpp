@@ -0,0 +1,153 @@
+// SPDX-License-Identifier: GPL-3.0-only
+// Copyright Takamitsu Endo (ryukau@gmail.com)
+
+#pragma once
+
+#include "pluginterfaces/vst/ivstaudioprocessor.h"
+
+#include "channelbuffers.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace Steinberg::Synth {
+
+/**
+Skips `DSPCore::process` while the plugin is silent.
+
+The plugin falls asleep when both input and output stay below `threshold` for
+`holdSamples`. `holdSamples` must be longer than the longest delay in the plugin, because
+a feedback loop can keep a signal in its buffer while the output is silent. While asleep,
+outputs are filled with 0 and `silenceFlags` are set. Any event, parameter change or
+non-silent input wakes the plugin up in the same block.
+
+DSP is not reset on sleep. Internal states are already decayed below `threshold`, and
+oscillators or envelopes continue from where they stopped.
+
+Usage in `PlugProcessor`:
+
+```
+// setActive(true)
+silence.setup(processSetup.sampleRate, holdSeconds);
+
+// process
+if (silence.skip<Sample>(data, automation.isIdle())) return;
+automation.dispatch(...);
+silence.update<Sample>(data);
+```
+*/
+class SilenceDetector {
+private:
+  uint64 holdSamples = 44100;
+  uint64 silentSamples = 0;
+  bool isInputSilent = true;
+
+  template<typename Sample>
+  static uint64 silentChannels(Vst::AudioBusBuffers &bus, int32 numSamples)
+  {
+    Sample **buffers = channelBuffers<Sample>(bus);
+    if (buffers == nullptr) return 0;
+
+    uint64 flags = 0;
+    for (int32 ch = 0; ch < bus.numChannels && ch < 64; ++ch) {
+      const uint64 bit = uint64(1) << ch;
+      if (bus.silenceFlags & bit) {
+        flags |= bit;
+        continue;
+      }
+      const Sample *buf = buffers[ch];
+      int32 i = 0;
+      for (; i < numSamples; ++i) {
+        if (std::fabs(buf[i]) > Sample(threshold)) break;
+      }
+      if (i >= numSamples) flags |= bit;
+    }
+    return flags;
+  }
+
+  static uint64 allChannels(int32 numChannels)
+  {
+    return numChannels >= 64 ? ~uint64(0) : (uint64(1) << numChannels) - 1;
+  }
+
+public:
+  static constexpr double threshold = 1e-6; // -120 dB.
+  static constexpr double defaultHoldSeconds = 2.0;
+
+  void setup(double sampleRate, double holdSeconds = defaultHoldSeconds)
+  {
+    holdSamples = uint64(std::max(0.0, sampleRate * holdSeconds));
+    reset();
+  }
+
+  void reset()
+  {
+    silentSamples = 0;
+    isInputSilent = true;
+  }
+
+  bool isSleeping() const { return silentSamples >= holdSamples; }
+
+  /**
+  The end of the tail is detected from output, so the tail is reported as infinite. Hosts
+  keep calling `process`, and skip downstream processing by `silenceFlags`.
+  */
+  uint32 getTailSamples() const { return Vst::kInfiniteTail; }
+
+  /**
+  Called before processing. Returns true when the block can be skipped. Outputs are
+  already filled with 0 in that case.
+
+  `isIdle` is false when any event or parameter change arrived in the block.
+  */
+  template<typename Sample> bool skip(Vst::ProcessData &data, bool isIdle)
+  {
+    isInputSilent = true;
+    for (int32 bus = 0; bus < data.numInputs; ++bus) {
+      auto &input = data.inputs[bus];
+      if (silentChannels<Sample>(input, data.numSamples) != allChannels(input.numChannels))
+      {
+        isInputSilent = false;
+        break;
+      }
+    }
+
+    if (!isIdle || !isInputSilent) {
+      silentSamples = 0;
+      return false;
+    }
+    if (!isSleeping()) return false;
+
+    for (int32 bus = 0; bus < data.numOutputs; ++bus) {
+      auto &output = data.outputs[bus];
+      Sample **buffers = channelBuffers<Sample>(output);
+      if (buffers == nullptr) continue;
+      for (int32 ch = 0; ch < output.numChannels; ++ch) {
+        std::memset(buffers[ch], 0, data.numSamples * sizeof(Sample));
+      }
+      output.silenceFlags = allChannels(output.numChannels);
+    }
+    return true;
+  }
+
+  // Called after processing. Counts the samples where both input and output are silent.
+  template<typename Sample> void update(Vst::ProcessData &data)
+  {
+    bool isOutputSilent = true;
+    for (int32 bus = 0; bus < data.numOutputs; ++bus) {
+      auto &output = data.outputs[bus];
+      output.silenceFlags = 0; // Flags from host are stale after processing.
+      output.silenceFlags = silentChannels<Sample>(output, data.numSamples);
+      if (output.silenceFlags != allChannels(output.numChannels)) isOutputSilent = false;
+    }
+
+    if (isInputSilent && isOutputSilent) {
+      silentSamples += uint64(data.numSamples);
+    } else {
+      silentSamples = 0;
+    }
+  }
+};
+
+} // namespace Steinberg::Synth
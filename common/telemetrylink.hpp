@@ -0,0 +1,151 @@
+// SPDX-License-Identifier: GPL-3.0-only
+// Copyright Takamitsu Endo (ryukau@gmail.com)
+
+#pragma once
+
+#include "pluginterfaces/vst/ivstmessage.h"
+#include "public.sdk/source/vst/vstcomponentbase.h"
+
+#include "dsp/telemetry.hpp"
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <utility>
+#include <vector>
+
+namespace Steinberg::Synth {
+
+/**
+Hands `SomeDSP::TelemetryQueue` from processor to controller.
+
+No address goes through `IMessage`. Processor registers its queue to a process-local
+registry under a random 64-bit id, and only the id is sent. Controller resolves the id in
+its own process. An unknown id, including ids from other processes and ids of withdrawn
+queues, resolves to `nullptr`. The queue is owned by `std::shared_ptr`, so a resolved
+queue stays valid after the processor is gone.
+
+Processor calls `open` on `setActive(true)`, and `close` on `setActive(false)`. The
+destructor also withdraws the queue, so a message delivered late never resolves to a
+queue of destroyed processor. All of them are called on main thread, and audio thread is
+never involved.
+*/
+class TelemetryLink {
+public:
+  static constexpr const char *messageId = "TelemetryQueue";
+  static constexpr const char *idKey = "Id";
+
+private:
+  class Registry {
+  private:
+    std::mutex mutex;
+    std::mt19937_64 rng{std::random_device{}()};
+    std::vector<std::pair<uint64_t, std::shared_ptr<SomeDSP::TelemetryQueue>>> entries;
+
+  public:
+    uint64_t add(std::shared_ptr<SomeDSP::TelemetryQueue> queue)
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      uint64_t id = 0;
+      while (id == 0 || findIndex(id) < entries.size()) id = rng();
+      entries.emplace_back(id, std::move(queue));
+      return id;
+    }
+
+    void remove(uint64_t id)
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      const auto idx = findIndex(id);
+      if (idx < entries.size()) entries.erase(entries.begin() + idx);
+    }
+
+    std::shared_ptr<SomeDSP::TelemetryQueue> find(uint64_t id)
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      const auto idx = findIndex(id);
+      return idx < entries.size() ? entries[idx].second : nullptr;
+    }
+
+  private:
+    size_t findIndex(uint64_t id) const
+    {
+      size_t idx = 0;
+      while (idx < entries.size() && entries[idx].first != id) ++idx;
+      return idx;
+    }
+  };
+
+  static Registry &registry()
+  {
+    static Registry instance;
+    return instance;
+  }
+
+  uint64_t id = 0; // 0 when nothing is registered.
+
+  static void send(Vst::ComponentBase *component, uint64_t queueId)
+  {
+    auto message = component->allocateMessage();
+    if (message == nullptr) return;
+    message->setMessageID(messageId);
+    auto attributes = message->getAttributes();
+    if (attributes != nullptr) {
+      attributes->setInt(idKey, int64(queueId));
+      component->sendMessage(message);
+    }
+    message->release();
+  }
+
+  void withdraw()
+  {
+    if (id == 0) return;
+    registry().remove(id);
+    id = 0;
+  }
+
+public:
+  TelemetryLink() = default;
+  TelemetryLink(const TelemetryLink &) = delete;
+  TelemetryLink &operator=(const TelemetryLink &) = delete;
+
+  ~TelemetryLink() { withdraw(); }
+
+  // Registers `queue` under a new id, and sends the id.
+  void open(Vst::ComponentBase *component, std::shared_ptr<SomeDSP::TelemetryQueue> queue)
+  {
+    withdraw();
+    id = registry().add(std::move(queue));
+    send(component, id);
+  }
+
+  // Withdraws the queue, and sends id 0.
+  void close(Vst::ComponentBase *component)
+  {
+    withdraw();
+    send(component, 0);
+  }
+
+  /**
+  Returns true if `message` is a telemetry message. `queue` is set to the registered
+  queue, or `nullptr` when the id is unknown in this process.
+  */
+  static bool
+  receive(Vst::IMessage *message, std::shared_ptr<SomeDSP::TelemetryQueue> &queue)
+  {
+    if (message == nullptr || strcmp(message->getMessageID(), messageId) != 0)
+      return false;
+
+    queue = nullptr;
+    auto attributes = message->getAttributes();
+    if (attributes == nullptr) return true;
+
+    int64 queueId = 0;
+    if (attributes->getInt(idKey, queueId) != kResultOk || queueId == 0) return true;
+    queue = registry().find(uint64_t(queueId));
+    return true;
+  }
+};
+
+} // namespace Steinberg::Synth
@@ -11,6 +11,7 @@
 #include "public.sdk/source/vst/vstparameters.h"
 
 #include "dsp/scale.hpp"
+#include "parameterstore.hpp"
 
 #include <string>
 
@@ -85,6 +86,16 @@ struct ValueInterface {
   virtual tresult addParameter(Vst::ParameterContainer &parameters) = 0;
   virtual Vst::ParamID getId() = 0;
   virtual void setId(Vst::ParamID id) = 0;
+
+  ParameterStore *store = nullptr;
+  size_t storeIndex = 0;
+
+  void attach(ParameterStore &store, size_t index)
+  {
+    this->store = &store;
+    storeIndex = index;
+    store.set(index, getDouble(), getNormalized());
+  }
 };
 
 struct UIntValue : public ValueInterface {
@@ -116,19 +127,27 @@ struct UIntValue : public ValueInterface {
   double getNormalized() override { return scale.invmap(raw); }
   inline double getDefaultNormalized() override { return defaultNormalized; }
 
+  inline void sync()
+  {
+    if (store != nullptr) store->set(storeIndex, double(raw), scale.invmap(raw));
+  }
+
   void setFromInt(uint32_t value) override
   {
     raw = std::clamp<uint32_t>(value, scale.getMin(), scale.getMax());
+    sync();
   }
 
   void setFromFloat(double valueFloat) override
   {
     raw = std::clamp<uint32_t>(uint32_t(valueFloat), scale.getMin(), scale.getMax());
+    sync();
   }
 
   void setFromNormalized(double value) override
   {
     raw = scale.map(std::clamp<double>(value, 0.0, 1.0));
+    sync();
   }
 
   tresult setState(IBStreamer &streamer) override
@@ -183,19 +202,27 @@ template<typename Scale> struct DoubleValue : public ValueInterface {
   double getNormalized() override { return scale.invmap(raw); }
   inline double getDefaultNormalized() override { return defaultNormalized; }
 
+  inline void sync()
+  {
+    if (store != nullptr) store->set(storeIndex, double(raw), scale.invmap(raw));
+  }
+
   void setFromInt(uint32_t value) override
   {
     raw = std::clamp<double>(value, scale.getMin(), scale.getMax());
+    sync();
   }
 
   void setFromFloat(double value) override
   {
     raw = std::clamp<double>(value, scale.getMin(), scale.getMax());
+    sync();
   }
 
   void setFromNormalized(double value) override
   {
     raw = scale.map(std::clamp<double>(value, 0.0, 1.0));
+    sync();
   }
 
   tresult setState(IBStreamer &streamer) override
@@ -26,3 +26,17 @@
 #endif
 
 #include "vcl/vectorclass.h"
+
+// `VCL_NAMESPACE` is defined when `dspcore.cpp` is compiled for several instruction sets
+// in one binary. See `common/cmake/simd_x86_64_and_aarch64.cmake`.
+#ifdef VCL_NAMESPACE
+using namespace VCL_NAMESPACE;
+#endif
+
+// Variants are compiled with `-fvisibility=hidden`, and only their factories are left
+// visible to the rest of the plugin.
+#if defined(__GNUC__)
+  #define UHHYOU_DSPCORE_EXPORT __attribute__((visibility("default")))
+#else
+  #define UHHYOU_DSPCORE_EXPORT
+#endif
@@ -0,0 +1,156 @@
+// SPDX-License-Identifier: GPL-3.0-only
+// Copyright Takamitsu Endo (ryukau@gmail.com)
+
+#pragma once
+
+#include "testutil.hpp"
+
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+
+// Rendering length of each measurement in seconds.
+#ifndef BENCH_DURATION_SECONDS
+  #define BENCH_DURATION_SECONDS 2.0
+#endif
+
+struct BenchStatistics {
+  double nsPerSample = 0;
+  double realTimeFactor = 0;
+  double meanBlockNs = 0;
+  double p99BlockNs = 0;
+  double maxBlockNs = 0;
+};
+
+/**
+Common part of `benchdsp_*` targets. `test/testdsp.cpp` of each plugin is reused, and its
+`Tester` alias selects `FxBench` or `SynthBench` when `BENCH_DSP` is defined.
+
+Output is written to `bench/<PluginName>.json`. Each entry has following fields:
+
+- `nsPerSample`: Processing time per frame in nanoseconds.
+- `realTimeFactor`: Rendered audio duration divided by processing time. 1 means that
+  rendering takes exactly as long as playback, and larger is faster.
+- `p99BlockNs`: 99th percentile of processing time per host block in nanoseconds.
+*/
+class BenchCommon {
+protected:
+  using json = nlohmann::json;
+  using Clock = std::chrono::steady_clock;
+
+  std::shared_ptr<PresetQueue> queue;
+  std::string plugin_name;
+  json results = json::array();
+
+  std::vector<double> blockNs;
+
+public:
+  static constexpr std::array<size_t, 5> blockSizes{32, 64, 128, 512, 2048};
+  static constexpr std::array<double, 4> sampleRates{44100, 48000, 96000, 192000};
+
+  bool isFinished = false;
+
+  /**
+  `reset()` brings DSP to the state right after loading a preset. `process(frame, length)`
+  processes a host block. `length` is always less than or equal to one of `blockSizes`.
+
+  A warm-up pass over all frames runs before the timed pass, and its timing is discarded.
+  This keeps first touch costs like page faults and cold caches out of the result.
+  */
+  template<typename ResetFunc, typename ProcessFunc>
+  BenchStatistics measure(
+    double sampleRate,
+    size_t nFrame,
+    size_t blockSize,
+    ResetFunc reset,
+    ProcessFunc process)
+  {
+    blockNs.clear();
+    blockNs.reserve(nFrame / blockSize + 1);
+
+    reset();
+    for (size_t frame = 0; frame < nFrame; frame += blockSize) {
+      process(frame, std::min(blockSize, nFrame - frame));
+    }
+
+    reset();
+    for (size_t frame = 0; frame < nFrame; frame += blockSize) {
+      const size_t length = std::min(blockSize, nFrame - frame);
+      const auto start = Clock::now();
+      process(frame, length);
+      const auto end = Clock::now();
+      blockNs.push_back(
+        double(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count()));
+    }
+
+    BenchStatistics stat;
+    if (blockNs.empty()) return stat;
+
+    double sumNs = 0;
+    for (const auto &ns : blockNs) sumNs += ns;
+
+    std::sort(blockNs.begin(), blockNs.end());
+    const size_t p99Index = std::min(
+      blockNs.size() - 1, size_t(std::ceil(0.99 * double(blockNs.size()))) - 1);
+
+    stat.nsPerSample = sumNs / double(nFrame);
+    stat.realTimeFactor = sumNs > 0 ? 1e9 * double(nFrame) / sampleRate / sumNs : 0;
+    stat.meanBlockNs = sumNs / double(blockNs.size());
+    stat.p99BlockNs = blockNs[p99Index];
+    stat.maxBlockNs = blockNs.back();
+    return stat;
+  }
+
+  void pushResult(
+    const std::string &presetName,
+    double sampleRate,
+    size_t blockSize,
+    const BenchStatistics &stat)
+  {
+    json entry;
+    entry["preset"] = presetName;
+    entry["sampleRate"] = sampleRate;
+    entry["blockSize"] = blockSize;
+    entry["nsPerSample"] = stat.nsPerSample;
+    entry["realTimeFactor"] = stat.realTimeFactor;
+    entry["meanBlockNs"] = stat.meanBlockNs;
+    entry["p99BlockNs"] = stat.p99BlockNs;
+    entry["maxBlockNs"] = stat.maxBlockNs;
+    results.push_back(entry);
+  }
+
+  bool writeResult()
+  {
+    const auto dir = fs::path("bench");
+    fs::create_directories(dir);
+    const auto path = dir / fs::path(plugin_name + ".json");
+
+    std::ofstream ofs(path);
+    if (!ofs.is_open()) {
+      std::cerr << "Error: Failed to open " << path << "\n";
+      return false;
+    }
+
+    json data;
+    data["plugin"] = plugin_name;
+    data["durationSeconds"] = BENCH_DURATION_SECONDS;
+    data["result"] = results;
+    ofs << data.dump(2) << "\n";
+
+    std::cout << "Benchmark result is written to " << path << "\n";
+    return true;
+  }
+
+  template<typename DSP> void loadPreset(const json &preset, std::unique_ptr<DSP> &dsp)
+  {
+    size_t index = 0;
+    for (const auto &parameter : preset["parameter"]) {
+      if (parameter["type"] == "I")
+        dsp->param.value[index]->setFromInt(parameter["value"]);
+      else if (parameter["type"] == "d")
+        dsp->param.value[index]->setFromNormalized(parameter["value"]);
+      ++index;
+    }
+  }
+};
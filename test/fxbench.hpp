@@ -0,0 +1,81 @@
+// SPDX-License-Identifier: GPL-3.0-only
+// Copyright Takamitsu Endo (ryukau@gmail.com)
+
+#pragma once
+
+#include "benchutil.hpp"
+#include "fxtester.hpp"
+
+template<typename DSP_CLASS> class FxBench : public BenchCommon {
+public:
+  // `n_thread` is ignored. Measurement runs on a single thread to get stable timing.
+  FxBench(std::string plugin_name, std::string out_dir, int n_thread = 1)
+  {
+    this->plugin_name = plugin_name;
+    queue = std::make_shared<PresetQueue>(plugin_name);
+    benchSequence();
+    isFinished = writeResult();
+  }
+
+  std::unique_ptr<DSP_CLASS> setupDSP() { return std::make_unique<DSP_CLASS>(); }
+
+  void render(
+    size_t frame,
+    size_t length,
+    const std::vector<std::vector<float>> &in,
+    std::vector<std::vector<float>> &wav,
+    std::unique_ptr<DSP_CLASS> &dsp)
+  {
+    if constexpr (hasSidechain) {
+      dsp->process(
+        length, in[0].data() + frame, in[1].data() + frame, in[0].data() + frame,
+        in[1].data() + frame, wav[0].data() + frame, wav[1].data() + frame);
+    } else {
+      dsp->process(
+        length, in[0].data() + frame, in[1].data() + frame, wav[0].data() + frame,
+        wav[1].data() + frame);
+    }
+  }
+
+  void benchSequence()
+  {
+    constexpr float tempo = 120.0f;
+
+    auto iter = queue->next();
+    while (iter != queue->end()) {
+      const auto &preset = iter.value();
+      const auto presetName = preset["name"].get<std::string>();
+
+      for (const auto &sampleRate : sampleRates) {
+        const size_t nFrame = size_t(BENCH_DURATION_SECONDS * sampleRate);
+        const auto input = generateTestNoise<float>(nFrame);
+
+        std::vector<std::vector<float>> wav(2);
+        for (auto &channel : wav) channel.resize(nFrame);
+
+        for (const auto &blockSize : blockSizes) {
+          auto dsp = setupDSP();
+          if (!dsp) {
+            std::cerr << "Error: setupDSP failed.\n";
+            return;
+          }
+          dsp->setup(sampleRate);
+          loadPreset(preset, dsp);
+
+          auto reset = [&]() {
+            SET_PARAMETERS;
+            dsp->reset();
+          };
+          auto process = [&](size_t frame, size_t length) {
+            SET_PARAMETERS;
+            render(frame, length, input, wav, dsp);
+          };
+          auto stat = measure(sampleRate, nFrame, blockSize, reset, process);
+          pushResult(presetName, sampleRate, blockSize, stat);
+        }
+      }
+
+      iter = queue->next();
+    }
+  }
+};
@@ -0,0 +1,116 @@
+// SPDX-License-Identifier: GPL-3.0-only
+// Copyright Takamitsu Endo (ryukau@gmail.com)
+
+#pragma once
+
+#include "benchutil.hpp"
+#include "synthtester.hpp"
+
+template<typename DSP_CLASS> class SynthBench : public BenchCommon {
+public:
+  // `n_thread` is ignored. Measurement runs on a single thread to get stable timing.
+  SynthBench(std::string plugin_name, std::string out_dir, int n_thread = 1)
+  {
+    this->plugin_name = plugin_name;
+    queue = std::make_shared<PresetQueue>(plugin_name);
+    benchSequence();
+    isFinished = writeResult();
+  }
+
+  std::unique_ptr<DSP_CLASS> setupDSP() { return std::make_unique<DSP_CLASS>(); }
+
+  void processDsp(
+    size_t length,
+    size_t currentFrame,
+    std::vector<std::vector<float>> &wav,
+    std::unique_ptr<DSP_CLASS> &dsp)
+  {
+#ifdef HAS_INPUT
+    dsp->process(
+      length, wav[0].data() + currentFrame, wav[1].data() + currentFrame,
+      wav[0].data() + currentFrame, wav[1].data() + currentFrame);
+#else
+    dsp->process(length, wav[0].data() + currentFrame, wav[1].data() + currentFrame);
+#endif
+  }
+
+  // Notes are passed through `pushMidiNote` in the same way as `PlugProcessor`, so the
+  // cost of `processMidiNote` is also measured.
+  void render(
+    size_t frame,
+    size_t length,
+    Sequencer &sequencer,
+    std::vector<std::vector<float>> &wav,
+    std::unique_ptr<DSP_CLASS> &dsp)
+  {
+    const size_t blockEnd = frame + length;
+    NoteEvent note;
+    while (sequencer.nextFrame() < blockEnd) {
+      size_t eventFrame = sequencer.nextFrame();
+      if (!sequencer.process(eventFrame, note)) break;
+
+      const bool isNoteOn = note.type == NoteEventType::noteOn;
+      const auto offset = uint32_t(eventFrame - frame);
+      if constexpr (requires {
+                      dsp->pushMidiNote(
+                        true, offset, note.id, note.pitch, note.pitch, note.tuning,
+                        note.velocity);
+                    })
+      {
+        // GlitchSprinkler takes MIDI channel.
+        dsp->pushMidiNote(
+          isNoteOn, offset, note.id, int16_t(0), note.pitch, note.tuning, note.velocity);
+      } else {
+        dsp->pushMidiNote(
+          isNoteOn, offset, note.id, note.pitch, note.tuning, note.velocity);
+      }
+    }
+    processDsp(length, frame, wav, dsp);
+  }
+
+  void benchSequence()
+  {
+    constexpr float tempo = 120.0f;
+
+    auto iter = queue->next();
+    while (iter != queue->end()) {
+      const auto &preset = iter.value();
+      const auto presetName = preset["name"].get<std::string>();
+
+      for (const auto &sampleRate : sampleRates) {
+        const size_t nFrame = size_t(BENCH_DURATION_SECONDS * sampleRate);
+
+        std::vector<std::vector<float>> wav(2);
+        for (auto &channel : wav) channel.resize(nFrame);
+
+        Sequencer sequencer;
+        sequencer.setupSequence(float(sampleRate), tempo);
+
+        for (const auto &blockSize : blockSizes) {
+          auto dsp = setupDSP();
+          if (!dsp) {
+            std::cerr << "Error: setupDSP failed.\n";
+            return;
+          }
+          dsp->setup(sampleRate);
+          loadPreset(preset, dsp);
+
+          auto reset = [&]() {
+            SET_PARAMETERS;
+            dsp->reset();
+            for (auto &channel : wav) std::fill(channel.begin(), channel.end(), 0.0f);
+            sequencer.rewind();
+          };
+          auto process = [&](size_t frame, size_t length) {
+            SET_PARAMETERS;
+            render(frame, length, sequencer, wav, dsp);
+          };
+          auto stat = measure(sampleRate, nFrame, blockSize, reset, process);
+          pushResult(presetName, sampleRate, blockSize, stat);
+        }
+      }
+
+      iter = queue->next();
+    }
+  }
+};
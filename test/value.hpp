@@ -4,6 +4,7 @@
 #pragma once
 
 #include "../common/dsp/scale.hpp"
+#include "../common/parameterstore.hpp"
 
 #include <string>
 
@@ -41,6 +42,16 @@ struct ValueInterface {
   virtual void setFromFloat(double value) = 0;
   virtual void setFromNormalized(double value) = 0;
   void setId(Vst::ParamID) {}
+
+  ParameterStore *store = nullptr;
+  size_t storeIndex = 0;
+
+  void attach(ParameterStore &store, size_t index)
+  {
+    this->store = &store;
+    storeIndex = index;
+    store.set(index, getDouble(), getNormalized());
+  }
 };
 
 struct UIntValue : public ValueInterface {
@@ -72,19 +83,27 @@ struct UIntValue : public ValueInterface {
   double getNormalized() override { return scale.invmap(raw); }
   inline double getDefaultNormalized() override { return defaultNormalized; }
 
+  inline void sync()
+  {
+    if (store != nullptr) store->set(storeIndex, double(raw), scale.invmap(raw));
+  }
+
   void setFromInt(uint32_t value) override
   {
     raw = std::clamp<uint32_t>(value, scale.getMin(), scale.getMax());
+    sync();
   }
 
   void setFromFloat(double valueFloat) override
   {
     raw = std::clamp<uint32_t>(uint32_t(valueFloat), scale.getMin(), scale.getMax());
+    sync();
   }
 
   void setFromNormalized(double value) override
   {
     raw = scale.map(std::clamp<double>(value, 0.0, 1.0));
+    sync();
   }
 };
 
@@ -114,19 +133,27 @@ template<typename Scale> struct DoubleValue : public ValueInterface {
   double getNormalized() override { return scale.invmap(raw); }
   inline double getDefaultNormalized() override { return defaultNormalized; }
 
+  inline void sync()
+  {
+    if (store != nullptr) store->set(storeIndex, double(raw), scale.invmap(raw));
+  }
+
   void setFromInt(uint32_t value) override
   {
     raw = std::clamp<double>(value, scale.getMin(), scale.getMax());
+    sync();
   }
 
   void setFromFloat(double value) override
   {
     raw = std::clamp<double>(value, scale.getMin(), scale.getMax());
+    sync();
   }
 
   void setFromNormalized(double value) override
   {
     raw = scale.map(std::clamp<double>(value, 0.0, 1.0));
+    sync();
   }
 };
 